@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "app_state_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static int64_t monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/*
+ * A slot written for longer than this was left half-written, e.g. by a
+ * server killed in the middle of an update. Readers spin a little before
+ * yielding the CPU to a preempted writer.
+ */
+#define READ_SPINS (1000)
+#define READ_TIMEOUT_NS (10 * 1000000)
+
+/**
+ * Copy a slot, retrying while it is written.
+ *
+ * @param name receives the application name.
+ * @return 1 if the slot is in use, 0 if it is free, -1 if it stays written
+ *         for longer than READ_TIMEOUT_NS.
+ */
+static int read_slot(const AppStateSlot *slot, char *name, AppState *state) {
+    uint32_t seq;
+    int64_t deadline = 0;
+    do {
+        for (int spins = 0; (seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE)) & 1; spins++) {
+            if (spins < READ_SPINS) {
+                continue;
+            }
+            if (deadline == 0) {
+                deadline = monotonic_ns() + READ_TIMEOUT_NS;
+            } else if (monotonic_ns() >= deadline) {
+                return -1;
+            }
+            sched_yield();
+        }
+        memcpy(name, slot->name, APP_STATE_SHM_NAME_SIZE);
+        state->state = __atomic_load_n(&slot->state, __ATOMIC_RELAXED);
+        state->run_id = __atomic_load_n(&slot->run_id, __ATOMIC_RELAXED);
+        state->version = __atomic_load_n(&slot->version, __ATOMIC_RELAXED);
+        state->payload_len = __atomic_load_n(&slot->payload_len, __ATOMIC_RELAXED);
+        state->changed_ns = __atomic_load_n(&slot->changed_ns, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq);
+    name[APP_STATE_SHM_NAME_SIZE - 1] = '\0';
+    return name[0] != '\0';
+}
+
+static void begin_write(AppStateSlot *slot) {
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void end_write(AppStateShm *shm, AppStateSlot *slot) {
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&shm->changes, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &shm->changes, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+const AppStateShm *app_state_shm_open(const char *name) {
+    struct stat st;
+    void *shm = MAP_FAILED;
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(AppStateShm)) {
+        shm = mmap(NULL, sizeof(AppStateShm), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (shm == MAP_FAILED) {
+        return NULL;
+    }
+    if (((const AppStateShm *) shm)->magic != APP_STATE_SHM_MAGIC) {
+        munmap(shm, sizeof(AppStateShm));
+        return NULL;
+    }
+    return (const AppStateShm *) shm;
+}
+
+void app_state_shm_close(const AppStateShm *shm) {
+    if (shm != NULL) {
+        munmap((void *) shm, sizeof(AppStateShm));
+    }
+}
+
+int app_state_shm_read(const AppStateShm *shm, const char *app_name, AppState *state) {
+    char name[APP_STATE_SHM_NAME_SIZE];
+    uint32_t count = shm->slot_count;
+    int stuck = 0;
+    for (uint32_t i = 0; i < count && i < APP_STATE_SHM_MAX_APPS; i++) {
+        int used = read_slot(&shm->slots[i], name, state);
+        if (used < 0) {
+            stuck = 1;
+        } else if (used && strcmp(name, app_name) == 0) {
+            return 1;
+        }
+    }
+    return stuck ? -1 : 0;
+}
+
+uint32_t app_state_shm_changes(const AppStateShm *shm) {
+    return __atomic_load_n(&shm->changes, __ATOMIC_ACQUIRE);
+}
+
+int app_state_shm_wait(const AppStateShm *shm, uint32_t changes, int timeout_ms) {
+    struct timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+    int64_t deadline = monotonic_ns() + (int64_t) timeout_ms * 1000000;
+    while (app_state_shm_changes(shm) == changes) {
+        if (timeout_ms >= 0) {
+            int64_t left = deadline - monotonic_ns();
+            if (left <= 0) {
+                return 0;
+            }
+            timeout.tv_sec = left / 1000000000;
+            timeout.tv_nsec = left % 1000000000;
+        }
+        if (syscall(SYS_futex, &shm->changes, FUTEX_WAIT, changes,
+                    timeout_ms >= 0 ? &timeout : NULL, NULL, 0) != 0
+                && errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+AppStateShm *app_state_shm_create(const char *name) {
+    void *shm = MAP_FAILED;
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(AppStateShm)) == 0) {
+        shm = mmap(NULL, sizeof(AppStateShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (shm == MAP_FAILED) {
+        shm_unlink(name);
+        return NULL;
+    }
+    ((AppStateShm *) shm)->magic = APP_STATE_SHM_MAGIC;
+    return (AppStateShm *) shm;
+}
+
+void app_state_shm_destroy(AppStateShm *shm, const char *name) {
+    // Wake the readers, which find every application gone.
+    __atomic_store_n(&shm->slot_count, 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&shm->changes, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &shm->changes, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    munmap(shm, sizeof(AppStateShm));
+    shm_unlink(name);
+}
+
+int app_state_shm_claim(AppStateShm *shm, const char *app_name) {
+    size_t len = strlen(app_name);
+    if (len == 0 || len >= APP_STATE_SHM_NAME_SIZE) {
+        return -1;
+    }
+    for (int i = 0; i < APP_STATE_SHM_MAX_APPS; i++) {
+        AppStateSlot *slot = &shm->slots[i];
+        if (slot->name[0] == '\0') {
+            begin_write(slot);
+            memcpy(slot->name, app_name, len + 1);
+            slot->state = slot->run_id = slot->version = slot->payload_len = 0;
+            slot->changed_ns = monotonic_ns();
+            if ((uint32_t) i >= shm->slot_count) {
+                __atomic_store_n(&shm->slot_count, i + 1, __ATOMIC_RELEASE);
+            }
+            end_write(shm, slot);
+            return i;
+        }
+    }
+    return -1;
+}
+
+void app_state_shm_update(AppStateShm *shm, int slot_index, uint32_t state, uint64_t run_id,
+                          uint64_t version, uint64_t payload_len) {
+    AppStateSlot *slot = &shm->slots[slot_index];
+    begin_write(slot);
+    __atomic_store_n(&slot->state, state, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->run_id, run_id, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->version, version, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->payload_len, payload_len, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->changed_ns, monotonic_ns(), __ATOMIC_RELAXED);
+    end_write(shm, slot);
+}
+
+void app_state_shm_release(AppStateShm *shm, int slot_index) {
+    AppStateSlot *slot = &shm->slots[slot_index];
+    begin_write(slot);
+    memset(slot->name, 0, sizeof(slot->name));
+    end_write(shm, slot);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Publication of the DIAL application states in shared memory.
+ *
+ * The server writes the state of every registered application into a POSIX
+ * shared memory segment, which local components map read-only to learn which
+ * application runs without polling the HTTP server. Each application slot is
+ * guarded by a sequence lock, so a reader takes a consistent copy without any
+ * system call, and the change counter is a futex word readers can block on
+ * until the next update.
+ *
+ * Readers only need the reader functions and app_state_shm.o.
+ */
+
+#ifndef SRC_SERVER_APP_STATE_SHM_H_
+#define SRC_SERVER_APP_STATE_SHM_H_
+
+#include <stdint.h>
+
+/*
+ * Maximum number of applications published, and maximum length of their
+ * names, including the trailing NULL.
+ */
+#define APP_STATE_SHM_MAX_APPS (64)
+#define APP_STATE_SHM_NAME_SIZE (64)
+
+#define APP_STATE_SHM_MAGIC (0x44534831)  // 'DSH1'
+
+/*
+ * A consistent copy of the state of an application.
+ */
+typedef struct {
+    uint32_t state;             // a DIALStatus
+    uint64_t run_id;
+    uint64_t version;           // state snapshot version, see dial_server.c
+    uint64_t payload_len;       // length of the last launch payload
+    int64_t changed_ns;         // CLOCK_MONOTONIC time of the last change
+} AppState;
+
+/*
+ * An application slot, free if its name is empty. The sequence number is odd
+ * while the slot is written.
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t state;
+    uint64_t run_id;
+    uint64_t version;
+    uint64_t payload_len;
+    int64_t changed_ns;
+    char name[APP_STATE_SHM_NAME_SIZE];
+} __attribute__((aligned(64))) AppStateSlot;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t slot_count;
+    uint32_t changes;           // futex word, incremented after every update
+    AppStateSlot slots[APP_STATE_SHM_MAX_APPS];
+} AppStateShm;
+
+/**
+ * Map a published segment read-only.
+ *
+ * @param name shared memory object name, e.g. "/dial_app_state".
+ * @return the segment or NULL if it does not exist or is not valid.
+ */
+const AppStateShm *app_state_shm_open(const char *name);
+
+/**
+ * Unmap a segment mapped by app_state_shm_open().
+ */
+void app_state_shm_close(const AppStateShm *shm);
+
+/**
+ * Read the state of an application, without any system call unless a slot is
+ * being written.
+ *
+ * @param shm the segment.
+ * @param app_name application name.
+ * @param state receives the state of the application.
+ * @return 1 if the application is published, 0 otherwise, -1 if it was not
+ *         found and a slot was left half-written, e.g. by a server that died.
+ */
+int app_state_shm_read(const AppStateShm *shm, const char *app_name, AppState *state);
+
+/**
+ * Return the change counter, to be passed to app_state_shm_wait() after
+ * reading the states.
+ */
+uint32_t app_state_shm_changes(const AppStateShm *shm);
+
+/**
+ * Wait for an update.
+ *
+ * @param shm the segment.
+ * @param changes the change counter returned by app_state_shm_changes().
+ * @param timeout_ms maximum time to wait, or -1 to wait forever.
+ * @return 1 if a state was updated since the change counter was read, 0 on
+ *         timeout.
+ */
+int app_state_shm_wait(const AppStateShm *shm, uint32_t changes, int timeout_ms);
+
+/**
+ * Create and map a segment for writing, replacing any previous one.
+ *
+ * @param name shared memory object name.
+ * @return the segment or NULL on error.
+ */
+AppStateShm *app_state_shm_create(const char *name);
+
+/**
+ * Unmap and remove a segment created by app_state_shm_create().
+ */
+void app_state_shm_destroy(AppStateShm *shm, const char *name);
+
+/**
+ * Publish an application in a free slot, stopped.
+ *
+ * @return the slot number or -1 if the name is too long or there is no free
+ *         slot.
+ */
+int app_state_shm_claim(AppStateShm *shm, const char *app_name);
+
+/**
+ * Update the state of a published application and wake the waiting readers.
+ * The updates of a slot must be serialized.
+ */
+void app_state_shm_update(AppStateShm *shm, int slot, uint32_t state, uint64_t run_id,
+                          uint64_t version, uint64_t payload_len);
+
+/**
+ * Stop publishing an application and free its slot.
+ */
+void app_state_shm_release(AppStateShm *shm, int slot);
+
+#endif /* SRC_SERVER_APP_STATE_SHM_H_ */
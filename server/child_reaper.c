@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "child_reaper.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct {
+    pid_t pid;              // 0 for a slot never used
+    int exited;
+    int status;
+    struct timespec exit_time;
+    DIALServer *ds;
+    char *app_name;
+    DIAL_run_t run_id;
+    int stopping;
+    struct timespec kill_time;  // when a stopping child is killed
+} ChildRecord;
+
+/*
+ * Open addressing by PID. Slots are never emptied, only reused for another
+ * child once theirs exited, so probe sequences stay intact.
+ */
+static struct {
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    int running;
+    int signal_fd;
+    int stop_fd;            // eventfd
+    int timer_fd;           // armed for the earliest kill_time
+    ChildRecord children[CHILD_REAPER_MAX_CHILDREN];
+} gReaper = { PTHREAD_MUTEX_INITIALIZER, 0, 0, -1, -1, -1 };
+
+static int time_before(const struct timespec *a, const struct timespec *b) {
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static size_t home_slot(pid_t pid) {
+    return ((uint32_t) pid * 2654435761u) % CHILD_REAPER_MAX_CHILDREN;
+}
+
+static ChildRecord *find_child(pid_t pid) {
+    size_t i = home_slot(pid);
+    for (size_t n = 0; n < CHILD_REAPER_MAX_CHILDREN; n++) {
+        ChildRecord *child = &gReaper.children[i];
+        if (child->pid == pid) {
+            return child;
+        }
+        if (child->pid == 0) {
+            break;
+        }
+        i = (i + 1) % CHILD_REAPER_MAX_CHILDREN;
+    }
+    return NULL;
+}
+
+/**
+ * Find the record of a child, or a record to reuse for it.
+ */
+static ChildRecord *add_child(pid_t pid) {
+    ChildRecord *child = find_child(pid);
+    if (child != NULL) {
+        return child;
+    }
+    // Reuse the record of the child that exited first.
+    ChildRecord *oldest = NULL;
+    size_t i = home_slot(pid);
+    for (size_t n = 0; n < CHILD_REAPER_MAX_CHILDREN; n++) {
+        child = &gReaper.children[i];
+        if (child->pid == 0) {
+            return oldest ? oldest : child;
+        }
+        if (child->exited && (oldest == NULL ||
+                time_before(&child->exit_time, &oldest->exit_time))) {
+            oldest = child;
+        }
+        i = (i + 1) % CHILD_REAPER_MAX_CHILDREN;
+    }
+    return oldest;
+}
+
+static void reset_child(ChildRecord *child, pid_t pid) {
+    free(child->app_name);
+    memset(child, 0, sizeof(*child));
+    child->pid = pid;
+}
+
+/**
+ * Collect the status of every child that exited, and report the exit of the
+ * application runs.
+ */
+static void reap_children() {
+    for (;;) {
+        DIALServer *ds = NULL;
+        char *app_name = NULL;
+        DIAL_run_t run_id = NULL;
+        int status;
+
+        pthread_mutex_lock(&gReaper.mutex);
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid <= 0) {
+            pthread_mutex_unlock(&gReaper.mutex);
+            break;
+        }
+        ChildRecord *child = find_child(pid);
+        if (child == NULL && (child = add_child(pid)) != NULL) {
+            // Not launched through the reaper.
+            reset_child(child, pid);
+        }
+        if (child != NULL) {
+            child->exited = 1;
+            child->status = status;
+            clock_gettime(CLOCK_MONOTONIC, &child->exit_time);
+            if (child->ds != NULL && child->app_name != NULL) {
+                ds = child->ds;
+                app_name = strdup(child->app_name);
+                run_id = child->run_id;
+            }
+        }
+        pthread_mutex_unlock(&gReaper.mutex);
+
+        if (app_name != NULL) {
+            DIAL_app_exited(ds, app_name, run_id);
+            free(app_name);
+        }
+    }
+}
+
+/**
+ * Kill the stopping children whose grace period is over, and arm the timer
+ * for the next one.
+ *
+ * Must be called with the mutex held.
+ */
+static void kill_stopping_children() {
+    struct itimerspec next;
+    struct timespec now;
+    memset(&next, 0, sizeof(next));
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (size_t i = 0; i < CHILD_REAPER_MAX_CHILDREN; i++) {
+        ChildRecord *child = &gReaper.children[i];
+        if (!child->stopping || child->exited) {
+            continue;
+        }
+        if (!time_before(&now, &child->kill_time)) {
+            printf("Killing pid %d, still running after SIGTERM\n", (int) child->pid);
+            kill(child->pid, SIGKILL);
+            child->stopping = 0;
+        } else if ((next.it_value.tv_sec == 0 && next.it_value.tv_nsec == 0) ||
+                   time_before(&child->kill_time, &next.it_value)) {
+            next.it_value = child->kill_time;
+        }
+    }
+    timerfd_settime(gReaper.timer_fd, TFD_TIMER_ABSTIME, &next, NULL);
+}
+
+static void *reaper_thread(void *arg) {
+    struct pollfd fds[3] = {
+        { gReaper.signal_fd, POLLIN, 0 },
+        { gReaper.stop_fd, POLLIN, 0 },
+        { gReaper.timer_fd, POLLIN, 0 }
+    };
+    // Children that exited before the thread started.
+    reap_children();
+    while (!fds[1].revents) {
+        if (poll(fds, 3, -1) < 0) {
+            continue;
+        }
+        if (fds[0].revents) {
+            struct signalfd_siginfo info;
+            while (read(gReaper.signal_fd, &info, sizeof(info)) == sizeof(info)) {
+                // SIGCHLD coalesces, the children are reaped until none is left.
+            }
+            reap_children();
+        }
+        if (fds[2].revents) {
+            uint64_t expirations;
+            if (read(gReaper.timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                pthread_mutex_lock(&gReaper.mutex);
+                kill_stopping_children();
+                pthread_mutex_unlock(&gReaper.mutex);
+            }
+        }
+    }
+    return NULL;
+}
+
+void child_reaper_block_signal() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+}
+
+int start_child_reaper() {
+    if (gReaper.running) {
+        return 1;
+    }
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    gReaper.signal_fd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+    gReaper.stop_fd = eventfd(0, EFD_CLOEXEC);
+    gReaper.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (gReaper.signal_fd != -1 && gReaper.stop_fd != -1 && gReaper.timer_fd != -1) {
+        sigset_t all, previous;
+        sigfillset(&all);
+        pthread_sigmask(SIG_SETMASK, &all, &previous);
+        gReaper.running = pthread_create(&gReaper.thread, NULL, reaper_thread, NULL) == 0;
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    }
+    if (!gReaper.running) {
+        if (gReaper.signal_fd != -1) {
+            close(gReaper.signal_fd);
+        }
+        if (gReaper.stop_fd != -1) {
+            close(gReaper.stop_fd);
+        }
+        if (gReaper.timer_fd != -1) {
+            close(gReaper.timer_fd);
+        }
+        gReaper.signal_fd = gReaper.stop_fd = gReaper.timer_fd = -1;
+    }
+    return gReaper.running;
+}
+
+void stop_child_reaper() {
+    if (!gReaper.running) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(gReaper.stop_fd, &one, sizeof(one)) != sizeof(one)) {
+        printf("Unable to stop the child reaper: %s\n", strerror(errno));
+        return;
+    }
+    pthread_join(gReaper.thread, NULL);
+    close(gReaper.signal_fd);
+    close(gReaper.stop_fd);
+    close(gReaper.timer_fd);
+    gReaper.signal_fd = gReaper.stop_fd = gReaper.timer_fd = -1;
+    gReaper.running = 0;
+
+    pthread_mutex_lock(&gReaper.mutex);
+    for (size_t i = 0; i < CHILD_REAPER_MAX_CHILDREN; i++) {
+        free(gReaper.children[i].app_name);
+    }
+    memset(gReaper.children, 0, sizeof(gReaper.children));
+    pthread_mutex_unlock(&gReaper.mutex);
+}
+
+pid_t child_reaper_spawn(DIALServer *ds, const char *app_name,
+                         pid_t (*spawn)(void *spawn_data), void *spawn_data) {
+    char *name = strdup(app_name);
+    if (name == NULL) {
+        return -1;
+    }
+    // The child cannot be reaped before it is recorded.
+    pthread_mutex_lock(&gReaper.mutex);
+    ChildRecord *child = NULL;
+    pid_t pid = spawn(spawn_data);
+    if (pid > 0 && (child = add_child(pid)) != NULL) {
+        reset_child(child, pid);
+        child->ds = ds;
+        child->app_name = name;
+        child->run_id = (DIAL_run_t) (long) pid;
+    }
+    pthread_mutex_unlock(&gReaper.mutex);
+    if (child == NULL) {
+        free(name);
+    }
+    return pid;
+}
+
+static pid_t fork_child(void *spawn_data) {
+    return fork();
+}
+
+pid_t child_reaper_fork(DIALServer *ds, const char *app_name) {
+    return child_reaper_spawn(ds, app_name, fork_child, NULL);
+}
+
+int child_reaper_exited(pid_t pid, int *status, struct timespec *exit_time) {
+    int exited = -1;
+    pthread_mutex_lock(&gReaper.mutex);
+    const ChildRecord *child = find_child(pid);
+    if (child != NULL) {
+        exited = child->exited;
+        if (exited && status != NULL) {
+            *status = child->status;
+        }
+        if (exited && exit_time != NULL) {
+            *exit_time = child->exit_time;
+        }
+    }
+    pthread_mutex_unlock(&gReaper.mutex);
+    return exited;
+}
+
+int child_reaper_stop(pid_t pid, unsigned int grace_ms) {
+    int stopped = -1;
+    pthread_mutex_lock(&gReaper.mutex);
+    ChildRecord *child = gReaper.running ? find_child(pid) : NULL;
+    if (child != NULL) {
+        stopped = 0;
+        if (!child->exited && !child->stopping && kill(pid, SIGTERM) == 0) {
+            stopped = 1;
+            child->stopping = 1;
+            clock_gettime(CLOCK_MONOTONIC, &child->kill_time);
+            child->kill_time.tv_sec += grace_ms / 1000;
+            child->kill_time.tv_nsec += (long) (grace_ms % 1000) * 1000000;
+            if (child->kill_time.tv_nsec >= 1000000000) {
+                child->kill_time.tv_sec++;
+                child->kill_time.tv_nsec -= 1000000000;
+            }
+            kill_stopping_children();
+        }
+    }
+    pthread_mutex_unlock(&gReaper.mutex);
+    return stopped;
+}
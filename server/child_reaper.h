@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Reaps the processes launched by the server as soon as they exit.
+ *
+ * SIGCHLD is blocked in every thread and received by a background thread
+ * through a signalfd, which collects the exit status of every child. The exit
+ * of a launched application is reported to the DIAL server right away, and
+ * callbacks can look up whether their run exited without waiting for it.
+ * Children are also stopped from that thread, which kills the ones that do
+ * not exit in time after SIGTERM.
+ */
+
+#ifndef SRC_SERVER_CHILD_REAPER_H_
+#define SRC_SERVER_CHILD_REAPER_H_
+
+#include <sys/types.h>
+#include <time.h>
+
+#include "dial_server.h"
+
+/*
+ * Maximum number of children whose exit is recorded. The records of the
+ * children that exited first are reused once it is reached.
+ */
+#define CHILD_REAPER_MAX_CHILDREN (256)
+
+/*
+ * Default time a stopped child has to exit before it is killed.
+ */
+#define CHILD_REAPER_STOP_GRACE_MS (3000)
+
+/**
+ * Block SIGCHLD in the calling thread. Must be called by the main thread
+ * before any other thread is created, so they all inherit it; launched
+ * processes must unblock it.
+ */
+void child_reaper_block_signal();
+
+/**
+ * Start the reaper thread.
+ *
+ * @return 1 if the reaper is running, 0 on error.
+ */
+int start_child_reaper();
+
+/**
+ * Stop the reaper thread. Children that exit afterwards are not reaped.
+ */
+void stop_child_reaper();
+
+/**
+ * Create a child that runs an application, whose exit is reported with
+ * DIAL_app_exited() and the PID as run id.
+ *
+ * @param ds DIAL server handle, or NULL to only record the exit.
+ * @param app_name name of the application.
+ * @param spawn creates the child, e.g. with launch_process(), and returns its
+ *        PID or -1. It must not use the reaper.
+ * @param spawn_data passed to spawn.
+ * @return the result of spawn. The exit is not recorded if
+ *         CHILD_REAPER_MAX_CHILDREN children are running or on out-of-memory.
+ */
+pid_t child_reaper_spawn(DIALServer *ds, const char *app_name,
+                         pid_t (*spawn)(void *spawn_data), void *spawn_data);
+
+/**
+ * Fork a child that runs an application, like child_reaper_spawn().
+ *
+ * @return like fork().
+ */
+pid_t child_reaper_fork(DIALServer *ds, const char *app_name);
+
+/**
+ * Look up whether a child exited.
+ *
+ * @param pid PID of the child.
+ * @param status if not NULL and the child exited, set to its status as
+ *        returned by waitpid().
+ * @param exit_time if not NULL and the child exited, set to when it was
+ *        reaped, on CLOCK_MONOTONIC.
+ * @return 1 if the child exited, 0 if it is running, -1 if it is not known.
+ */
+int child_reaper_exited(pid_t pid, int *status, struct timespec *exit_time);
+
+/**
+ * Stop a child without waiting for it to exit: send it SIGTERM, and SIGKILL
+ * if it is still running after the grace period. Stopping a child that is
+ * already stopping does nothing.
+ *
+ * @param pid PID of the child.
+ * @param grace_ms time the child has to exit after SIGTERM.
+ * @return 1 if SIGTERM was sent, 0 if the child is already stopping or
+ *         exited, -1 if it is not known or the reaper is not running.
+ */
+int child_reaper_stop(pid_t pid, unsigned int grace_ms);
+
+#endif /* SRC_SERVER_CHILD_REAPER_H_ */
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#define _GNU_SOURCE
+#include "dial_control.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "dial_data.h"
+#include "url_lib.h"
+
+// Result bytes of the records of a message.
+#define RESULT_APPLIED (1)
+#define RESULT_REJECTED (0)
+#define RESULT_ERROR (-1)
+
+#define MAX_APP_NAME (255)
+
+static struct {
+    int running;
+    pthread_t thread;
+    DIALServer *ds;
+    int listen_fd;
+    int stop_fd;            // eventfd
+    char path[sizeof(((struct sockaddr_un *) 0)->sun_path)];
+    int clients[DIAL_CONTROL_MAX_CLIENTS];
+    size_t client_count;
+} gControl = { .listen_fd = -1, .stop_fd = -1 };
+
+/**
+ * Checks that a data record body only holds printable characters.
+ */
+static int is_printable(const char *body, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = body[i];
+        if (c <= 0x1F || c >= 0x7F) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int8_t apply_data(const char *app_name, const char *body, size_t len) {
+    if (len > DIAL_DATA_MAX_PAYLOAD || !is_printable(body, len)) {
+        return RESULT_REJECTED;
+    }
+    char query[DIAL_DATA_MAX_PAYLOAD + 1];
+    memcpy(query, body, len);
+    query[len] = '\0';
+    DIALData *data = parse_params(query);
+    int result = DIAL_replace_app_data(gControl.ds, app_name, data);
+    free_dial_data(&data);
+    return result;
+}
+
+static int8_t apply_state(const char *app_name, const char *body, size_t len) {
+    DIALControlState state;
+    if (len != sizeof(state)) {
+        return RESULT_ERROR;
+    }
+    memcpy(&state, body, sizeof(state));
+    if (state.state != kDIALStatusStopped && state.state != kDIALStatusHide
+            && state.state != kDIALStatusRunning) {
+        return RESULT_REJECTED;
+    }
+    return DIAL_report_state(gControl.ds, app_name, (DIALStatus) state.state,
+                             (DIAL_run_t) (uintptr_t) state.run_id, state.can_stop != 0);
+}
+
+/**
+ * Apply the records of a message.
+ *
+ * @return the number of results written, one per record. A malformed record
+ *         ends the message with a RESULT_ERROR.
+ */
+static size_t apply_message(const char *message, size_t size, int8_t *results) {
+    size_t count = 0;
+    size_t offset = 0;
+    while (offset < size) {
+        DIALControlRecord record;
+        char app_name[MAX_APP_NAME + 1];
+        if (size - offset < sizeof(record)) {
+            results[count++] = RESULT_ERROR;
+            break;
+        }
+        memcpy(&record, message + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.name_len == 0 || record.name_len > MAX_APP_NAME
+                || size - offset < record.name_len
+                || size - offset - record.name_len < record.body_len) {
+            results[count++] = RESULT_ERROR;
+            break;
+        }
+        memcpy(app_name, message + offset, record.name_len);
+        app_name[record.name_len] = '\0';
+        offset += record.name_len;
+        const char *body = message + offset;
+        offset += record.body_len;
+        switch (record.type) {
+        case kDIALControlData:
+            results[count++] = apply_data(app_name, body, record.body_len);
+            break;
+        case kDIALControlState:
+            results[count++] = apply_state(app_name, body, record.body_len);
+            break;
+        default:
+            results[count++] = RESULT_ERROR;
+            break;
+        }
+    }
+    return count;
+}
+
+static int is_authorized(int fd) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+        return 0;
+    }
+    return cred.uid == 0 || cred.uid == geteuid();
+}
+
+static void accept_clients() {
+    int fd;
+    while ((fd = accept4(gControl.listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+        if (gControl.client_count == DIAL_CONTROL_MAX_CLIENTS) {
+            printf("Control socket: too many clients\n");
+            close(fd);
+        } else if (!is_authorized(fd)) {
+            printf("Control socket: peer is not authorized\n");
+            close(fd);
+        } else {
+            gControl.clients[gControl.client_count++] = fd;
+        }
+    }
+}
+
+/**
+ * Serve a message of a client.
+ *
+ * @return 0 if the client disconnected, 1 otherwise.
+ */
+static int serve_client(int fd, char *message) {
+    // Every record takes at least a header, so results cannot outnumber them.
+    int8_t results[DIAL_CONTROL_MAX_MESSAGE / sizeof(DIALControlRecord)];
+    struct iovec iov = { message, DIAL_CONTROL_MAX_MESSAGE };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+    ssize_t size = recvmsg(fd, &msg, 0);
+    if (size < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (size == 0) {
+        return 0;
+    }
+    size_t count;
+    if (msg.msg_flags & MSG_TRUNC) {
+        results[0] = RESULT_ERROR;
+        count = 1;
+    } else {
+        count = apply_message(message, size, results);
+    }
+    if (count > 0 && send(fd, results, count, MSG_NOSIGNAL | MSG_DONTWAIT) < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return 1;
+}
+
+static void *control_thread(void *arg) {
+    char *message = malloc(DIAL_CONTROL_MAX_MESSAGE);
+    if (message == NULL) {
+        return NULL;
+    }
+    struct pollfd fds[2 + DIAL_CONTROL_MAX_CLIENTS];
+    for (;;) {
+        fds[0] = (struct pollfd) { gControl.listen_fd, POLLIN, 0 };
+        fds[1] = (struct pollfd) { gControl.stop_fd, POLLIN, 0 };
+        for (size_t i = 0; i < gControl.client_count; i++) {
+            fds[2 + i] = (struct pollfd) { gControl.clients[i], POLLIN, 0 };
+        }
+        size_t nfds = 2 + gControl.client_count;
+        if (poll(fds, nfds, -1) < 0) {
+            continue;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+        // Serve the clients before accepting new ones, which moves them.
+        size_t kept = 0;
+        for (size_t i = 0; i < nfds - 2; i++) {
+            int fd = gControl.clients[i];
+            if (fds[2 + i].revents && !serve_client(fd, message)) {
+                close(fd);
+            } else {
+                gControl.clients[kept++] = fd;
+            }
+        }
+        gControl.client_count = kept;
+        if (fds[0].revents) {
+            accept_clients();
+        }
+    }
+    free(message);
+    return NULL;
+}
+
+int start_dial_control(DIALServer *ds, const char *path) {
+    if (gControl.running) {
+        return 1;
+    }
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("Control socket path too long: %s\n", path);
+        return 0;
+    }
+    strcpy(addr.sun_path, path);
+    gControl.ds = ds;
+    gControl.client_count = 0;
+    gControl.listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    gControl.stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (gControl.listen_fd != -1 && gControl.stop_fd != -1) {
+        unlink(path);
+        if (bind(gControl.listen_fd, (struct sockaddr *) &addr, sizeof(addr)) != 0
+                || listen(gControl.listen_fd, DIAL_CONTROL_MAX_CLIENTS) != 0) {
+            printf("Unable to listen on %s: %s\n", path, strerror(errno));
+        } else {
+            sigset_t all, previous;
+            sigfillset(&all);
+            pthread_sigmask(SIG_SETMASK, &all, &previous);
+            gControl.running = pthread_create(&gControl.thread, NULL, control_thread, NULL) == 0;
+            pthread_sigmask(SIG_SETMASK, &previous, NULL);
+            if (gControl.running) {
+                strcpy(gControl.path, path);
+            } else {
+                unlink(path);
+            }
+        }
+    }
+    if (!gControl.running) {
+        if (gControl.listen_fd != -1) {
+            close(gControl.listen_fd);
+        }
+        if (gControl.stop_fd != -1) {
+            close(gControl.stop_fd);
+        }
+        gControl.listen_fd = gControl.stop_fd = -1;
+    }
+    return gControl.running;
+}
+
+void stop_dial_control() {
+    if (!gControl.running) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(gControl.stop_fd, &one, sizeof(one)) != sizeof(one)) {
+        printf("Unable to stop the control socket: %s\n", strerror(errno));
+        return;
+    }
+    pthread_join(gControl.thread, NULL);
+    for (size_t i = 0; i < gControl.client_count; i++) {
+        close(gControl.clients[i]);
+    }
+    gControl.client_count = 0;
+    close(gControl.listen_fd);
+    close(gControl.stop_fd);
+    gControl.listen_fd = gControl.stop_fd = -1;
+    unlink(gControl.path);
+    gControl.running = 0;
+}
+
+size_t dial_control_add_record(void *message, size_t size, size_t used,
+                               DIALControlType type, const char *app_name,
+                               const void *body, size_t body_len) {
+    size_t name_len = strlen(app_name);
+    if (name_len == 0 || name_len > MAX_APP_NAME || body_len > UINT32_MAX
+            || used > size || size - used < sizeof(DIALControlRecord) + name_len + body_len) {
+        return 0;
+    }
+    DIALControlRecord record = { type, 0, name_len, body_len };
+    char *out = (char *) message + used;
+    memcpy(out, &record, sizeof(record));
+    memcpy(out + sizeof(record), app_name, name_len);
+    if (body_len > 0) {
+        memcpy(out + sizeof(record) + name_len, body, body_len);
+    }
+    return used + sizeof(record) + name_len + body_len;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Local control socket of the DIAL server.
+ *
+ * Applications running on the device post their DIAL data and report their
+ * state over a SOCK_SEQPACKET Unix domain socket instead of HTTP. Every
+ * message carries one or more records, each made of a DIALControlRecord
+ * header followed by the application name and the record body, and is
+ * answered by a message holding one signed result byte per record. Only
+ * processes running as root or as the server user may connect.
+ */
+
+#ifndef SRC_SERVER_DIAL_CONTROL_H_
+#define SRC_SERVER_DIAL_CONTROL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dial_server.h"
+
+/*
+ * Maximum size of a message, and maximum number of connected clients.
+ */
+#define DIAL_CONTROL_MAX_MESSAGE (16 * 1024)
+#define DIAL_CONTROL_MAX_CLIENTS (16)
+
+typedef enum {
+    kDIALControlData = 1,   // body is the URL-escaped query string of the data
+    kDIALControlState = 2,  // body is a DIALControlState
+} DIALControlType;
+
+/*
+ * Record header, in host byte order. The application name, which is not NULL
+ * terminated, and the body follow it without padding.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t name_len;
+    uint32_t body_len;
+} DIALControlRecord;
+
+/*
+ * Body of a kDIALControlState record, see DIAL_report_state().
+ */
+typedef struct {
+    uint8_t state;          // kDIALStatusStopped, kDIALStatusHide or kDIALStatusRunning
+    uint8_t can_stop;
+    uint8_t reserved[6];
+    uint64_t run_id;
+} DIALControlState;
+
+/**
+ * Create the control socket and start the thread serving it.
+ *
+ * @param ds DIAL server handle whose applications are updated.
+ * @param path path of the socket. A file left at that path is replaced.
+ * @return 1 if the control socket is served, 0 on error.
+ */
+int start_dial_control(DIALServer *ds, const char *path);
+
+/**
+ * Stop serving the control socket, disconnect the clients and remove the
+ * socket file.
+ */
+void stop_dial_control();
+
+/**
+ * Append a record to a message.
+ *
+ * @param message message buffer.
+ * @param size size of the message buffer.
+ * @param used number of bytes of the message already used.
+ * @param type record type.
+ * @param app_name application name.
+ * @param body record body.
+ * @param body_len size of the record body.
+ * @return the number of bytes of the message used with the record appended, or
+ *         0 if it does not fit.
+ */
+size_t dial_control_add_record(void *message, size_t size, size_t used,
+                               DIALControlType type, const char *app_name,
+                               const void *body, size_t body_len);
+
+#endif /* SRC_SERVER_DIAL_CONTROL_H_ */
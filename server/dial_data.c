@@ -26,10 +26,16 @@
  * Functions related to storing/retrieving and manipulating DIAL data.
  */
 #include "dial_data.h"
+#include "dial_data_db.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 
 char dial_data_dir[256] = DIAL_DATA_DIR;
@@ -44,98 +50,419 @@ void set_dial_data_dir(const char *data_dir) {
  * The DIAL data directory must have been already set.
  *
  * @param app_name application name.
+ * @param suffix appended to the path, e.g. for a temporary file.
  * @return the location of the application path within the DIAL data
  *         directory or NULL if memory could not be allocated.
  * @see set_dial_data_dir(const char*)
  */
-static char* getAppPath(char *app_name) {
-    size_t name_size = strlen(app_name) + sizeof(dial_data_dir) + 1;
+static char* getAppPath(const char *app_name, const char *suffix) {
+    size_t name_size = strlen(app_name) + strlen(suffix) + sizeof(dial_data_dir) + 1;
     char* filename = (char*) malloc(name_size);
     if (filename == NULL) {
         return NULL;
     }
-    filename[0] = 0;
-    strncat(filename, dial_data_dir, name_size);
-    strncat(filename, app_name, name_size - sizeof(dial_data_dir));
+    snprintf(filename, name_size, "%s%s%s", dial_data_dir, app_name, suffix);
     return filename;
 }
 
-void store_dial_data(char *app_name, DIALData *data) {
-    char* filename = getAppPath(app_name);
-    if (filename == NULL) {
-        printf("Cannot open DIAL data output file, out-of-memory.");
-        exit(1);
+/**
+ * fsync() the DIAL data directory so a rename() within it is durable.
+ */
+static void sync_dial_data_dir() {
+    int fd = open(dial_data_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd != -1) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+int store_dial_data(char *app_name, DIALData *data) {
+    if (is_dial_data_db_open()) {
+        return dial_data_db_store(app_name, data);
+    }
+
+    char* filename = getAppPath(app_name, "");
+    char* tmp_filename = getAppPath(app_name, ".tmp");
+    int success = 0;
+    if (filename == NULL || tmp_filename == NULL) {
+        printf("Cannot open DIAL data output file, out-of-memory.\n");
+        free(filename);
+        free(tmp_filename);
+        return 0;
     }
-    FILE *f = fopen(filename, "w");
-    free(filename); filename = NULL;
+
+    // Write a temporary file and rename it over the previous data so a crash
+    // never leaves a partially written file behind.
+    FILE *f = fopen(tmp_filename, "we");
     if (f == NULL) {
-        printf("Cannot open DIAL data output file: %s\n", filename);
-        exit(1);
+        printf("Cannot open DIAL data output file: %s: %s\n", tmp_filename, strerror(errno));
+    } else {
+        int err = 0;
+        for (DIALData *first = data; first != NULL && !err; first = first->next) {
+            // truncate because we have limits on length when retrieving.
+            err = fprintf(f, "%.*s %.*s\n", DIAL_KEY_OR_VALUE_MAX_LEN, first->key, DIAL_KEY_OR_VALUE_MAX_LEN, first->value) < 0;
+        }
+        err = err || fflush(f) != 0 || fsync(fileno(f)) != 0;
+        err = (fclose(f) != 0) || err;
+        if (err || rename(tmp_filename, filename) != 0) {
+            printf("Cannot write DIAL data output file: %s: %s\n", filename, strerror(errno));
+            unlink(tmp_filename);
+        } else {
+            sync_dial_data_dir();
+            success = 1;
+        }
+    }
+    free(filename);
+    free(tmp_filename);
+    return success;
+}
+
+/*
+ * Background writer state. Pending writes are kept per application so that
+ * updates arriving within the write window are coalesced into one write.
+ */
+struct PendingWrite_ {
+    struct PendingWrite_ *next;
+    char *app_name;
+    DIALData *data;
+    struct timespec due;
+};
+
+typedef struct PendingWrite_ PendingWrite;
+
+/*
+ * A store in progress, from the writer thread or a synchronous caller. All
+ * stores of an application share one temporary file, so they are done one at
+ * a time and in the order their data was taken.
+ */
+struct StoreTicket_ {
+    struct StoreTicket_ *next;
+    const char *app_name;
+};
+
+typedef struct StoreTicket_ StoreTicket;
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_cond_t stored;
+    pthread_t thread;
+    int running;
+    int stopping;
+    unsigned int window_ms;
+    size_t max_pending;
+    size_t num_pending;
+    PendingWrite *pending;      // oldest first, so also ordered by due time
+    StoreTicket *stores;        // oldest first
+} gWriter = { .mutex = PTHREAD_MUTEX_INITIALIZER, .stored = PTHREAD_COND_INITIALIZER };
+
+static void free_pending_write(PendingWrite *write) {
+    free_dial_data(&write->data);
+    free(write->app_name);
+    free(write);
+}
+
+/**
+ * Remove and return the pending write of an application.
+ *
+ * Must be called with the writer mutex held.
+ */
+static PendingWrite *take_pending_write(const char *app_name) {
+    for (PendingWrite **ptr = &gWriter.pending; *ptr != NULL; ptr = &(*ptr)->next) {
+        if (!strcmp((*ptr)->app_name, app_name)) {
+            PendingWrite *write = *ptr;
+            *ptr = write->next;
+            gWriter.num_pending--;
+            return write;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Wait until every earlier store of the same application is done.
+ *
+ * Must be called with the writer mutex held, and in the same critical section
+ * that took the data to store so that stores keep the order of updates.
+ */
+static void begin_store(StoreTicket *ticket, const char *app_name) {
+    StoreTicket **ptr = &gWriter.stores;
+    while (*ptr != NULL) {
+        ptr = &(*ptr)->next;
     }
-    for (DIALData *first = data; first != NULL; first = first->next) {
-        // truncate because we have limits on length when retrieving.
-        fprintf(f, "%.*s %.*s\n", DIAL_KEY_OR_VALUE_MAX_LEN, first->key, DIAL_KEY_OR_VALUE_MAX_LEN, first->value);
+    ticket->next = NULL;
+    ticket->app_name = app_name;
+    *ptr = ticket;
+
+    for (StoreTicket *t = gWriter.stores; t != ticket; ) {
+        if (!strcmp(t->app_name, app_name)) {
+            pthread_cond_wait(&gWriter.stored, &gWriter.mutex);
+            t = gWriter.stores;  // the list may have changed, rescan
+        } else {
+            t = t->next;
+        }
     }
-    fclose(f);
 }
 
-DIALData *retrieve_dial_data(char *app_name) {
-    char* filename = getAppPath(app_name);
-    if (filename == NULL) {
-        return NULL; // no dial data found, that's fine
+/**
+ * Must be called with the writer mutex held.
+ */
+static void end_store(StoreTicket *ticket) {
+    StoreTicket **ptr = &gWriter.stores;
+    while (*ptr != ticket) {
+        ptr = &(*ptr)->next;
+    }
+    *ptr = ticket->next;
+    pthread_cond_broadcast(&gWriter.stored);
+}
+
+/**
+ * Store the data of an application in order with its other stores.
+ *
+ * Must be called with the writer mutex held, which is released while writing.
+ */
+static void store_in_order(const char *app_name, DIALData *data) {
+    StoreTicket ticket;
+
+    begin_store(&ticket, app_name);
+    pthread_mutex_unlock(&gWriter.mutex);
+    store_dial_data((char *) app_name, data);
+    pthread_mutex_lock(&gWriter.mutex);
+    end_store(&ticket);
+}
+
+static void *dial_data_writer(void *arg) {
+    pthread_mutex_lock(&gWriter.mutex);
+    while (!gWriter.stopping || gWriter.pending != NULL) {
+        PendingWrite *write = gWriter.pending;
+        if (write == NULL) {
+            // Nothing to do, sleep until an update is queued.
+            pthread_cond_wait(&gWriter.cond, &gWriter.mutex);
+            continue;
+        }
+        if (!gWriter.stopping &&
+            pthread_cond_timedwait(&gWriter.cond, &gWriter.mutex, &write->due) != ETIMEDOUT) {
+            continue;  // woken up early, re-evaluate
+        }
+        gWriter.pending = write->next;
+        gWriter.num_pending--;
+        store_in_order(write->app_name, write->data);
+        free_pending_write(write);
     }
-    FILE *f = fopen(filename, "r");
-    free(filename); filename = NULL;
+    pthread_mutex_unlock(&gWriter.mutex);
+    return NULL;
+}
+
+int start_dial_data_writer(unsigned int window_ms, size_t max_pending) {
+    pthread_condattr_t attr;
+    int started = 0;
+
+    pthread_mutex_lock(&gWriter.mutex);
+    if (gWriter.running) {
+        pthread_mutex_unlock(&gWriter.mutex);
+        return 1;
+    }
+    if (pthread_condattr_init(&attr) == 0) {
+        if (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 &&
+            pthread_cond_init(&gWriter.cond, &attr) == 0) {
+            gWriter.window_ms = window_ms;
+            gWriter.max_pending = max_pending;
+            gWriter.stopping = 0;
+            if (pthread_create(&gWriter.thread, NULL, dial_data_writer, NULL) == 0) {
+                gWriter.running = started = 1;
+            } else {
+                pthread_cond_destroy(&gWriter.cond);
+            }
+        }
+        pthread_condattr_destroy(&attr);
+    }
+    pthread_mutex_unlock(&gWriter.mutex);
+    return started;
+}
+
+void stop_dial_data_writer() {
+    pthread_mutex_lock(&gWriter.mutex);
+    if (!gWriter.running) {
+        pthread_mutex_unlock(&gWriter.mutex);
+        return;
+    }
+    gWriter.stopping = 1;
+    pthread_cond_signal(&gWriter.cond);
+    pthread_mutex_unlock(&gWriter.mutex);
+
+    // The writer flushes every pending write before exiting.
+    pthread_join(gWriter.thread, NULL);
+    pthread_mutex_lock(&gWriter.mutex);
+    gWriter.running = 0;
+    pthread_cond_destroy(&gWriter.cond);
+    pthread_mutex_unlock(&gWriter.mutex);
+}
+
+void queue_dial_data(const char *app_name, DIALData *data) {
+    PendingWrite *write = NULL;
+
+    pthread_mutex_lock(&gWriter.mutex);
+    if (gWriter.running && !gWriter.stopping) {
+        // Coalesce with an update that has not been written yet.
+        for (write = gWriter.pending; write != NULL; write = write->next) {
+            if (!strcmp(write->app_name, app_name)) {
+                free_dial_data(&write->data);
+                write->data = data;
+                pthread_mutex_unlock(&gWriter.mutex);
+                return;
+            }
+        }
+        if (gWriter.num_pending < gWriter.max_pending &&
+            (write = (PendingWrite *) calloc(1, sizeof(PendingWrite))) != NULL &&
+            (write->app_name = strdup(app_name)) != NULL) {
+            write->data = data;
+            clock_gettime(CLOCK_MONOTONIC, &write->due);
+            write->due.tv_sec += gWriter.window_ms / 1000;
+            write->due.tv_nsec += (gWriter.window_ms % 1000) * 1000000L;
+            if (write->due.tv_nsec >= 1000000000L) {
+                write->due.tv_sec++;
+                write->due.tv_nsec -= 1000000000L;
+            }
+            PendingWrite **ptr = &gWriter.pending;
+            while (*ptr != NULL) {
+                ptr = &(*ptr)->next;
+            }
+            *ptr = write;
+            gWriter.num_pending++;
+            pthread_cond_signal(&gWriter.cond);
+            pthread_mutex_unlock(&gWriter.mutex);
+            return;
+        }
+        free(write);
+    }
+
+    // No writer running or its queue is full: write synchronously, but after
+    // an older update the writer may still be storing.
+    store_in_order(app_name, data);
+    pthread_mutex_unlock(&gWriter.mutex);
+    free_dial_data(&data);
+}
+
+DIALData *alloc_dial_data(size_t count, size_t string_size, char **strings) {
+    DIALData *result = (DIALData *) calloc(1, count * sizeof(DIALData) + string_size);
+    if (result == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i + 1 < count; i++) {
+        result[i].next = &result[i + 1];
+    }
+    *strings = (char *) (result + count);
+    return result;
+}
+
+static const char * const whitespace = " \t\r\n";
+
+/**
+ * Read the DIAL data file of an application.
+ *
+ * @param filename the application data file.
+ * @param found set to 1 if the file exists.
+ * @return the DIAL data or NULL if there is none or out-of-memory.
+ */
+static DIALData *read_dial_data_file(const char *filename, int *found) {
+    FILE *f = fopen(filename, "re");
+    *found = f != NULL;
     if (f == NULL) {
         return NULL; // no dial data found, that's fine
     }
+
+    // Read the whole file so the list can be sized and built in one block.
+    long file_size;
+    char *contents = NULL;
+    if (fseek(f, 0, SEEK_END) == 0 && (file_size = ftell(f)) > 0 &&
+        fseek(f, 0, SEEK_SET) == 0 &&
+        (contents = (char *) malloc(file_size + 1)) != NULL) {
+        contents[fread(contents, 1, file_size, f)] = '\0';
+    }
+    fclose(f);
+    if (contents == NULL) {
+        return NULL;
+    }
+
+    // Keys and values are whitespace-separated tokens, truncated to
+    // DIAL_KEY_OR_VALUE_MAX_LEN like the previous fscanf()-based reader did.
+    size_t tokens = 0, string_size = 0;
+    for (char *p = contents + strspn(contents, whitespace); *p;
+         p += strspn(p, whitespace)) {
+        size_t len = strcspn(p, whitespace);
+        string_size += (len > DIAL_KEY_OR_VALUE_MAX_LEN ? DIAL_KEY_OR_VALUE_MAX_LEN : len) + 1;
+        tokens++;
+        p += len;
+    }
+
     DIALData *result = NULL;
-    char key[DIAL_KEY_OR_VALUE_MAX_LEN + 1] = {0,};
-    char value[DIAL_KEY_OR_VALUE_MAX_LEN + 1] = {0,};
-    int err = 0;
-    while (fscanf(f, "%" DIAL_KEY_OR_VALUE_MAX_LEN_STR "s %" DIAL_KEY_OR_VALUE_MAX_LEN_STR "s\n", key, value) != EOF) {
-        DIALData *newNode = (DIALData *) malloc(sizeof(DIALData));
-        if (newNode == NULL) {
-            err = 1;
-            break;
+    char *strings;
+    if (tokens >= 2 &&
+        (result = alloc_dial_data(tokens / 2, string_size, &strings)) != NULL) {
+        DIALData *node = result;
+        char *p = contents + strspn(contents, whitespace);
+        for (size_t i = 0; i < (tokens / 2) * 2; i++) {
+            size_t len = strcspn(p, whitespace);
+            size_t copied = len > DIAL_KEY_OR_VALUE_MAX_LEN ? DIAL_KEY_OR_VALUE_MAX_LEN : len;
+            memcpy(strings, p, copied);
+            strings[copied] = '\0';
+            if (i % 2 == 0) {
+                node->key = strings;
+            } else {
+                node->value = strings;
+                node = node->next;
+            }
+            strings += copied + 1;
+            p += len;
+            p += strspn(p, whitespace);
         }
+    }
+    free(contents);
+    return result;
+}
 
-        newNode->key = (char *) calloc(strlen(key) + 1, sizeof(char));
-        if (newNode->key == NULL) {
-            err = 1;
-            free(newNode); newNode = NULL;
-            break;
-        }
-        strncpy(newNode->key, key, strlen(key));
-
-        newNode->value = (char *) calloc(strlen(value) + 1, sizeof(char));
-        if (newNode->value == NULL) {
-            err = 1;
-            free(newNode->key); newNode->key = NULL;
-            free(newNode); newNode = NULL;
-            break;
+DIALData *retrieve_dial_data(char *app_name) {
+    // Make sure a pending write is not lost or read back stale, and that a
+    // store already in progress is done before reading.
+    StoreTicket ticket;
+    pthread_mutex_lock(&gWriter.mutex);
+    PendingWrite *write = take_pending_write(app_name);
+    if (write != NULL) {
+        store_in_order(write->app_name, write->data);
+    } else {
+        begin_store(&ticket, app_name);
+        end_store(&ticket);
+    }
+    pthread_mutex_unlock(&gWriter.mutex);
+    if (write != NULL) {
+        free_pending_write(write);
+    }
+
+    int found;
+    DIALData *result;
+    if (is_dial_data_db_open()) {
+        result = dial_data_db_retrieve(app_name, &found);
+        if (found) {
+            return result;
         }
-        strncpy(newNode->value, value, strlen(value));
-        newNode->next = result;
-        result = newNode;
     }
-    fclose(f);
-    if (err) {
-        free_dial_data(&result);
-        result = NULL;
+
+    char* filename = getAppPath(app_name, "");
+    if (filename == NULL) {
+        return NULL; // no dial data found, that's fine
+    }
+    result = read_dial_data_file(filename, &found);
+
+    // Migrate the per application file into the store file, once.
+    if (found && is_dial_data_db_open() && dial_data_db_store(app_name, result)) {
+        unlink(filename);
     }
+    free(filename);
     return result;
 }
 
 void free_dial_data(DIALData **dialData)
 {
-    DIALData *curNode=NULL;
-    while (*dialData != NULL) {
-        curNode = *dialData;
-        *dialData = curNode->next;
-
-        free(curNode->key); curNode->key = NULL;
-        free(curNode->value); curNode->value = NULL;
-        free(curNode); curNode = NULL;
-    }
+    free(*dialData);
+    *dialData = NULL;
 }
@@ -29,6 +29,8 @@
 #ifndef SRC_SERVER_DIAL_DATA_H_
 #define SRC_SERVER_DIAL_DATA_H_
 
+#include <stddef.h>
+
 /*
  * Slash-terminated directory of where to persist the DIAL data.
  */
@@ -51,7 +53,8 @@
  * expected to be URL-escaped strings, so any spaces would be represented as
  * the '+' character. They have a max length of 255 characters.
  *
- * THE STRINGS key AND value POINT TO MUST BE DYNAMICALLY ALLOCATED
+ * A DIAL data list, including the strings key and value point to, is a single
+ * block allocated by alloc_dial_data() and released by free_dial_data().
  */
 struct DIALData_ {
     struct DIALData_ *next;
@@ -64,22 +67,65 @@ typedef struct DIALData_ DIALData;
 #define DIAL_KEY_OR_VALUE_MAX_LEN (255)
 #define DIAL_KEY_OR_VALUE_MAX_LEN_STR "255"
 
+/*
+ * Default time window over which the background writer coalesces updates to
+ * the same application, and default number of applications it can have
+ * pending writes for.
+ */
+#define DIAL_DATA_WRITE_WINDOW_MS (500)
+#define DIAL_DATA_WRITE_MAX_PENDING (64)
+
 /**
  * Store the DIAL data key/value pairs in the application data store.
  *
- * Will exit immediately if the data output file cannot be accessed due to
- * out-of-memory or I/O errors.
+ * The data is written to a temporary file which is synced and then renamed
+ * over the previous data, so the stored data is never partially written.
  *
  * Keys and values are truncated to DIAL_KEY_OR_VALUE_MAX_LEN.
  *
+ * While a store file is open (see open_dial_data_db()) the data is appended
+ * to it instead.
+ *
  * @param app_name application name.
  * @param data pointer to head of DIAL data linked list.
+ * @return 1 if successful, 0 if the data output file cannot be written due to
+ *         out-of-memory or I/O errors.
+ */
+int store_dial_data(char *app_name, DIALData *data);
+
+/**
+ * Start the background DIAL data writer thread.
+ *
+ * @param window_ms time window over which updates to the same application are
+ *        coalesced before being written.
+ * @param max_pending maximum number of applications with a pending write;
+ *        beyond that queue_dial_data() writes synchronously.
+ * @return 1 if the writer is running, 0 on error.
+ */
+int start_dial_data_writer(unsigned int window_ms, size_t max_pending);
+
+/**
+ * Write all pending DIAL data and stop the background writer thread.
+ */
+void stop_dial_data_writer();
+
+/**
+ * Store the DIAL data key/value pairs in the application data store from the
+ * background writer thread, or synchronously if the writer is not running or
+ * its queue is full.
+ *
+ * @param app_name application name.
+ * @param data pointer to head of DIAL data linked list, which is freed once
+ *        written.
  */
-void store_dial_data(char *app_name, DIALData *data);
+void queue_dial_data(const char *app_name, DIALData *data);
 
 /**
  * Retrieve the DIAL data key/value pairs from the application data store.
  *
+ * While a store file is open, an application that has no data in it yet has
+ * its data file moved into it.
+ *
  * @param app_name application name.
  * @return data pointer to head of DIAL data linked list or NULL if
  *         there is no valid data or if the data output file cannot be accessed
@@ -95,6 +141,18 @@ DIALData *retrieve_dial_data(char *app_name);
  */
 void set_dial_data_dir(const char *data_dir);
 
+/**
+ * Allocate a DIAL data list of count nodes, linked in array order, followed by
+ * string_size bytes of storage for the keys and values, in a single block.
+ *
+ * @param count number of nodes, must be greater than 0.
+ * @param string_size number of bytes of string storage.
+ * @param strings receives the start of the string storage.
+ * @return the head of the list or NULL if out-of-memory. The node keys and
+ *         values are NULL.
+ */
+DIALData *alloc_dial_data(size_t count, size_t string_size, char **strings);
+
 /**
  * Frees the DIAL data linked list memory.
  *
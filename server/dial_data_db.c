@@ -0,0 +1,553 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Single-file, memory-mapped DIAL data store.
+ *
+ * File layout, in host byte order:
+ *
+ *   header    magic, version, directory offset and count, offset of the
+ *             first record appended after the directory
+ *   records   one per update: total length, checksum, application name
+ *             length, number of pairs, application name, then for each pair
+ *             key length, value length, key and value; padded to 8 bytes
+ *   directory offsets of the live records, written by compaction
+ *
+ * Opening the store maps the file, indexes the records in the directory and
+ * then the ones appended after it; a later record for an application
+ * supersedes the earlier ones. A record that is truncated or fails its
+ * checksum ends the file and is cut off.
+ */
+#include "dial_data_db.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DB_MAGIC "DIALDATA"
+#define DB_VERSION (1)
+
+/*
+ * Compact once the file is larger than this and more than half of it is
+ * superseded records.
+ */
+#define DB_COMPACT_MIN_SIZE (64 * 1024)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dir_count;
+    uint64_t dir_offset;
+    uint64_t tail_offset;
+} DbHeader;
+
+typedef struct {
+    uint32_t length;
+    uint32_t checksum;      // of the record after this field
+    uint32_t app_len;
+    uint32_t count;
+} DbRecord;
+
+typedef struct {
+    uint64_t offset;        // 0 for an empty slot
+    uint32_t hash;
+    uint32_t length;
+} DbIndexEntry;
+
+static struct {
+    pthread_mutex_t mutex;
+    int fd;
+    char *path;
+    unsigned char *map;
+    size_t map_size;
+    size_t file_size;
+    size_t live_bytes;
+    DbIndexEntry *index;    // open addressing, power-of-two capacity
+    size_t index_capacity;
+    size_t index_count;
+} gDb = { PTHREAD_MUTEX_INITIALIZER, -1 };
+
+static uint32_t fnv1a(const void *data, size_t len, uint32_t hash) {
+    const unsigned char *p = (const unsigned char *) data;
+    while (len--) {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+#define FNV_OFFSET (2166136261u)
+
+static uint32_t read_u32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static size_t pad8(size_t size) {
+    return (size + 7) & ~(size_t) 7;
+}
+
+/**
+ * Check the record at offset and return its length, or 0 if it is truncated,
+ * corrupted or not a record.
+ */
+static size_t check_record(size_t offset) {
+    DbRecord rec;
+    if (offset < sizeof(DbHeader) || offset % 8 != 0 ||
+        offset + sizeof(rec) > gDb.file_size) {
+        return 0;
+    }
+    memcpy(&rec, gDb.map + offset, sizeof(rec));
+    if (rec.length < sizeof(rec) || rec.length % 8 != 0 ||
+        rec.length > gDb.file_size - offset || rec.app_len == 0 ||
+        rec.app_len > rec.length - sizeof(rec) ||
+        fnv1a(gDb.map + offset + 8, rec.length - 8, FNV_OFFSET) != rec.checksum) {
+        return 0;
+    }
+
+    // The pairs must fit within the record.
+    const unsigned char *p = gDb.map + offset + sizeof(rec) + rec.app_len;
+    const unsigned char *end = gDb.map + offset + rec.length;
+    for (uint32_t i = 0; i < rec.count; i++) {
+        if (end - p < 8) {
+            return 0;
+        }
+        size_t pair_len = (size_t) read_u32(p) + read_u32(p + 4);
+        p += 8;
+        if ((size_t) (end - p) < pair_len) {
+            return 0;
+        }
+        p += pair_len;
+    }
+    return rec.length;
+}
+
+static const char *record_app(uint64_t offset, uint32_t *app_len) {
+    *app_len = read_u32(gDb.map + offset + offsetof(DbRecord, app_len));
+    return (const char *) gDb.map + offset + sizeof(DbRecord);
+}
+
+/**
+ * Return the index slot of an application, which is empty if the application
+ * has no record.
+ */
+static DbIndexEntry *find_slot(const char *app_name, size_t app_len, uint32_t hash) {
+    size_t mask = gDb.index_capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        DbIndexEntry *slot = &gDb.index[i];
+        if (slot->offset == 0) {
+            return slot;
+        }
+        uint32_t len;
+        const char *name;
+        if (slot->hash == hash && (name = record_app(slot->offset, &len)) &&
+            len == app_len && !memcmp(name, app_name, app_len)) {
+            return slot;
+        }
+    }
+}
+
+static int grow_index() {
+    size_t capacity = gDb.index_capacity ? gDb.index_capacity * 2 : 64;
+    DbIndexEntry *old = gDb.index;
+    size_t old_capacity = gDb.index_capacity;
+    DbIndexEntry *index = (DbIndexEntry *) calloc(capacity, sizeof(DbIndexEntry));
+    if (index == NULL) {
+        return 0;
+    }
+    gDb.index = index;
+    gDb.index_capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].offset != 0) {
+            size_t mask = capacity - 1, j = old[i].hash & mask;
+            while (index[j].offset != 0) {
+                j = (j + 1) & mask;
+            }
+            index[j] = old[i];
+        }
+    }
+    free(old);
+    return 1;
+}
+
+/**
+ * Make the record at offset, which has been checked, the current one for its
+ * application.
+ */
+static int index_record(uint64_t offset, uint32_t length) {
+    if ((gDb.index_count + 1) * 2 > gDb.index_capacity && !grow_index()) {
+        return 0;
+    }
+    uint32_t app_len;
+    const char *app_name = record_app(offset, &app_len);
+    uint32_t hash = fnv1a(app_name, app_len, FNV_OFFSET);
+    DbIndexEntry *slot = find_slot(app_name, app_len, hash);
+    if (slot->offset != 0) {
+        gDb.live_bytes -= slot->length;
+    } else {
+        gDb.index_count++;
+    }
+    slot->offset = offset;
+    slot->hash = hash;
+    slot->length = length;
+    gDb.live_bytes += length;
+    return 1;
+}
+
+/**
+ * Map the whole file, replacing the previous mapping.
+ */
+static int map_file() {
+    if (gDb.map != NULL && gDb.map_size == gDb.file_size) {
+        return 1;
+    }
+    if (gDb.map != NULL) {
+        munmap(gDb.map, gDb.map_size);
+        gDb.map = NULL;
+    }
+    void *map = mmap(NULL, gDb.file_size, PROT_READ, MAP_SHARED, gDb.fd, 0);
+    if (map == MAP_FAILED) {
+        printf("Cannot map DIAL data store: %s: %s\n", gDb.path, strerror(errno));
+        return 0;
+    }
+    gDb.map = (unsigned char *) map;
+    gDb.map_size = gDb.file_size;
+    return 1;
+}
+
+static int write_all(int fd, const void *buf, size_t len, off_t offset) {
+    const char *p = (const char *) buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return 1;
+}
+
+static void close_locked() {
+    if (gDb.map != NULL) {
+        munmap(gDb.map, gDb.map_size);
+    }
+    if (gDb.fd != -1) {
+        close(gDb.fd);
+    }
+    free(gDb.index);
+    free(gDb.path);
+    gDb.fd = -1;
+    gDb.path = NULL;
+    gDb.map = NULL;
+    gDb.map_size = gDb.file_size = gDb.live_bytes = 0;
+    gDb.index = NULL;
+    gDb.index_capacity = gDb.index_count = 0;
+}
+
+/**
+ * Open the file at gDb.path, write a header if it is empty, map it and index
+ * its records.
+ */
+static int open_locked() {
+    struct stat st;
+    DbHeader header;
+
+    gDb.fd = open(gDb.path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (gDb.fd == -1 || fstat(gDb.fd, &st) != 0) {
+        printf("Cannot open DIAL data store: %s: %s\n", gDb.path, strerror(errno));
+        return 0;
+    }
+    if (st.st_size == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, DB_MAGIC, sizeof(header.magic));
+        header.version = DB_VERSION;
+        header.tail_offset = sizeof(header);
+        if (!write_all(gDb.fd, &header, sizeof(header), 0) || fsync(gDb.fd) != 0) {
+            printf("Cannot write DIAL data store: %s: %s\n", gDb.path, strerror(errno));
+            return 0;
+        }
+        st.st_size = sizeof(header);
+    }
+    gDb.file_size = st.st_size;
+    if (gDb.file_size < sizeof(header) || !map_file()) {
+        return 0;
+    }
+    memcpy(&header, gDb.map, sizeof(header));
+    if (memcmp(header.magic, DB_MAGIC, sizeof(header.magic)) ||
+        header.version != DB_VERSION ||
+        header.tail_offset < sizeof(header) || header.tail_offset > gDb.file_size ||
+        header.dir_offset > header.tail_offset ||
+        header.dir_count > (header.tail_offset - header.dir_offset) / sizeof(uint64_t)) {
+        printf("Not a supported DIAL data store: %s\n", gDb.path);
+        return 0;
+    }
+    if (!grow_index()) {
+        return 0;
+    }
+
+    // Records listed in the directory, then the ones appended since.
+    for (uint32_t i = 0; i < header.dir_count; i++) {
+        uint64_t offset;
+        memcpy(&offset, gDb.map + header.dir_offset + i * sizeof(offset), sizeof(offset));
+        size_t length = check_record(offset);
+        if (length == 0 || offset + length > header.dir_offset) {
+            printf("Corrupted DIAL data store directory: %s\n", gDb.path);
+            return 0;
+        }
+        if (!index_record(offset, length)) {
+            return 0;
+        }
+    }
+    size_t offset = header.tail_offset, length;
+    while (offset < gDb.file_size) {
+        if ((length = check_record(offset)) == 0) {
+            // Cut off a partially written record so appends start clean.
+            printf("Discarding %zu bytes at the end of DIAL data store: %s\n",
+                   gDb.file_size - offset, gDb.path);
+            if (ftruncate(gDb.fd, offset) != 0) {
+                return 0;
+            }
+            gDb.file_size = offset;
+            return map_file();
+        }
+        if (!index_record(offset, length)) {
+            return 0;
+        }
+        offset += length;
+    }
+    return 1;
+}
+
+int open_dial_data_db(const char *path) {
+    pthread_mutex_lock(&gDb.mutex);
+    close_locked();
+    int success = (gDb.path = strdup(path)) != NULL && open_locked();
+    if (!success) {
+        close_locked();
+    }
+    pthread_mutex_unlock(&gDb.mutex);
+    return success;
+}
+
+void close_dial_data_db() {
+    pthread_mutex_lock(&gDb.mutex);
+    close_locked();
+    pthread_mutex_unlock(&gDb.mutex);
+}
+
+int is_dial_data_db_open() {
+    pthread_mutex_lock(&gDb.mutex);
+    int open = gDb.fd != -1;
+    pthread_mutex_unlock(&gDb.mutex);
+    return open;
+}
+
+static int compact_locked() {
+    size_t tmp_size = strlen(gDb.path) + sizeof(".tmp");
+    char *tmp_path = (char *) malloc(tmp_size);
+    uint64_t *dir = (uint64_t *) malloc(gDb.index_count * sizeof(uint64_t) + 1);
+    int fd = -1, success = 0;
+    DbHeader header;
+
+    if (tmp_path == NULL || dir == NULL) {
+        goto done;
+    }
+    snprintf(tmp_path, tmp_size, "%s.tmp", gDb.path);
+    fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        printf("Cannot open DIAL data store: %s: %s\n", tmp_path, strerror(errno));
+        goto done;
+    }
+
+    // Copy the live records, then write the directory and the header.
+    uint64_t offset = sizeof(header);
+    uint32_t count = 0;
+    for (size_t i = 0; i < gDb.index_capacity; i++) {
+        DbIndexEntry *slot = &gDb.index[i];
+        if (slot->offset == 0) {
+            continue;
+        }
+        if (!write_all(fd, gDb.map + slot->offset, slot->length, offset)) {
+            goto write_error;
+        }
+        dir[count++] = offset;
+        offset += slot->length;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DB_MAGIC, sizeof(header.magic));
+    header.version = DB_VERSION;
+    header.dir_offset = offset;
+    header.dir_count = count;
+    header.tail_offset = pad8(offset + count * sizeof(uint64_t));
+    if (!write_all(fd, dir, count * sizeof(uint64_t), offset) ||
+        ftruncate(fd, header.tail_offset) != 0 ||
+        !write_all(fd, &header, sizeof(header), 0) || fsync(fd) != 0 ||
+        rename(tmp_path, gDb.path) != 0) {
+        goto write_error;
+    }
+    close(fd);
+    fd = -1;
+
+    // Reopen the compacted file; should that fail the store is closed and
+    // the per application files are used again.
+    char *path = gDb.path;
+    gDb.path = NULL;
+    close_locked();
+    gDb.path = path;
+    success = open_locked();
+    if (!success) {
+        close_locked();
+    }
+    goto done;
+
+write_error:
+    printf("Cannot write DIAL data store: %s: %s\n", tmp_path, strerror(errno));
+    unlink(tmp_path);
+done:
+    if (fd != -1) {
+        close(fd);
+    }
+    free(dir);
+    free(tmp_path);
+    return success;
+}
+
+int compact_dial_data_db() {
+    pthread_mutex_lock(&gDb.mutex);
+    int success = gDb.fd != -1 && compact_locked();
+    pthread_mutex_unlock(&gDb.mutex);
+    return success;
+}
+
+int dial_data_db_store(const char *app_name, const DIALData *data) {
+    size_t app_len = strlen(app_name);
+    size_t length = sizeof(DbRecord) + app_len;
+    uint32_t count = 0;
+    for (const DIALData *node = data; node != NULL; node = node->next) {
+        length += 8 + strlen(node->key) + strlen(node->value);
+        count++;
+    }
+    length = pad8(length);
+    if (app_len == 0 || length > UINT32_MAX) {
+        return 0;
+    }
+
+    unsigned char *record = (unsigned char *) calloc(1, length);
+    if (record == NULL) {
+        printf("Cannot write DIAL data store, out-of-memory.\n");
+        return 0;
+    }
+    DbRecord rec = { length, 0, app_len, count };
+    unsigned char *p = record + sizeof(rec);
+    memcpy(p, app_name, app_len);
+    p += app_len;
+    for (const DIALData *node = data; node != NULL; node = node->next) {
+        uint32_t lens[2] = { strlen(node->key), strlen(node->value) };
+        memcpy(p, lens, sizeof(lens));
+        p += sizeof(lens);
+        memcpy(p, node->key, lens[0]);
+        p += lens[0];
+        memcpy(p, node->value, lens[1]);
+        p += lens[1];
+    }
+    memcpy(record, &rec, sizeof(rec));
+    rec.checksum = fnv1a(record + 8, length - 8, FNV_OFFSET);
+    memcpy(record, &rec, sizeof(rec));
+
+    int success = 0;
+    pthread_mutex_lock(&gDb.mutex);
+    if (gDb.fd != -1) {
+        size_t offset = gDb.file_size;
+        if (!write_all(gDb.fd, record, length, offset) || fdatasync(gDb.fd) != 0) {
+            printf("Cannot write DIAL data store: %s: %s\n", gDb.path, strerror(errno));
+            if (ftruncate(gDb.fd, offset) != 0) {
+                printf("Cannot truncate DIAL data store: %s\n", gDb.path);
+            }
+        } else {
+            gDb.file_size += length;
+            success = map_file() && index_record(offset, length);
+            if (success && gDb.file_size > DB_COMPACT_MIN_SIZE &&
+                gDb.live_bytes < gDb.file_size / 2) {
+                compact_locked();
+            }
+        }
+    }
+    pthread_mutex_unlock(&gDb.mutex);
+    free(record);
+    return success;
+}
+
+DIALData *dial_data_db_retrieve(const char *app_name, int *found) {
+    DIALData *result = NULL;
+    size_t app_len = strlen(app_name);
+
+    *found = 0;
+    pthread_mutex_lock(&gDb.mutex);
+    if (gDb.fd == -1) {
+        pthread_mutex_unlock(&gDb.mutex);
+        return NULL;
+    }
+    DbIndexEntry *slot = find_slot(app_name, app_len, fnv1a(app_name, app_len, FNV_OFFSET));
+    if (slot->offset != 0) {
+        DbRecord rec;
+        memcpy(&rec, gDb.map + slot->offset, sizeof(rec));
+        *found = 1;
+
+        // The pairs need a NULL terminator per string instead of the two
+        // lengths, so the record size bounds the string storage.
+        char *strings;
+        const unsigned char *p = gDb.map + slot->offset + sizeof(rec) + rec.app_len;
+        if (rec.count > 0 &&
+            (result = alloc_dial_data(rec.count, rec.length, &strings)) != NULL) {
+            for (DIALData *node = result; node != NULL; node = node->next) {
+                uint32_t key_len = read_u32(p), value_len = read_u32(p + 4);
+                p += 8;
+                node->key = strings;
+                memcpy(strings, p, key_len);
+                strings[key_len] = '\0';
+                strings += key_len + 1;
+                p += key_len;
+                node->value = strings;
+                memcpy(strings, p, value_len);
+                strings[value_len] = '\0';
+                strings += value_len + 1;
+                p += value_len;
+            }
+        }
+    }
+    pthread_mutex_unlock(&gDb.mutex);
+    return result;
+}
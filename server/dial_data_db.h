@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Optional single-file, memory-mapped DIAL data store.
+ *
+ * Instead of one text file per application, the DIAL data of every
+ * application is kept in one versioned binary file of length-prefixed
+ * records. Updates are appended and the file is compacted once it holds
+ * mostly superseded records. Compaction also writes a directory of the live
+ * records, so opening the store only maps the file, reads the directory and
+ * scans the records appended since.
+ */
+
+#ifndef SRC_SERVER_DIAL_DATA_DB_H_
+#define SRC_SERVER_DIAL_DATA_DB_H_
+
+#include "dial_data.h"
+
+/**
+ * Open, or create, the DIAL data store file. While it is open
+ * store_dial_data() and retrieve_dial_data() use it instead of the per
+ * application text files, which are migrated into it the first time an
+ * application's data is retrieved.
+ *
+ * A partially appended record, e.g. after a crash, is discarded.
+ *
+ * @param path the store file path.
+ * @return 1 if successful, 0 if the file cannot be opened or is not a DIAL
+ *         data store of a supported version.
+ */
+int open_dial_data_db(const char *path);
+
+/**
+ * Close the DIAL data store file.
+ */
+void close_dial_data_db();
+
+/**
+ * @return 1 if the DIAL data store file is open.
+ */
+int is_dial_data_db_open();
+
+/**
+ * Store the DIAL data of an application in the store file. Keys and values
+ * are kept as is, without truncation.
+ *
+ * @param app_name application name.
+ * @param data pointer to head of DIAL data linked list, may be NULL.
+ * @return 1 if successful, 0 on I/O error or out-of-memory.
+ */
+int dial_data_db_store(const char *app_name, const DIALData *data);
+
+/**
+ * Retrieve the DIAL data of an application from the store file.
+ *
+ * @param app_name application name.
+ * @param found set to 1 if the store file has data for the application, even
+ *        if empty, 0 otherwise.
+ * @return pointer to head of DIAL data linked list or NULL if there is no
+ *         data or out-of-memory. The caller must free the returned memory.
+ */
+DIALData *dial_data_db_retrieve(const char *app_name, int *found);
+
+/**
+ * Rewrite the store file with only the latest record of each application
+ * and a directory of them. Done automatically once superseded records take up
+ * most of the file.
+ *
+ * @return 1 if successful, 0 on I/O error or out-of-memory.
+ */
+int compact_dial_data_db();
+
+#endif /* SRC_SERVER_DIAL_DATA_DB_H_ */
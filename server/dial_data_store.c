@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Hash-indexed DIAL data store. Entries live in a chained hash table for
+ * lookup and in a doubly linked list for insertion-ordered iteration and
+ * eviction. Each entry is a single allocation holding its key and value.
+ */
+#include "dial_data_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_BUCKETS (16)
+
+struct DIALDataStore_ {
+    DIALDataEntry **buckets;
+    size_t bucket_count;        // always a power of two
+    DIALDataEntry *head;        // oldest entry
+    DIALDataEntry *tail;        // newest entry
+    size_t count;
+    size_t bytes;
+    size_t max_entries;
+    size_t max_bytes;
+    DIALDataQuotaPolicy policy;
+};
+
+/**
+ * FNV-1a hash of the key.
+ */
+static unsigned int hash_key(const char *key, size_t len) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char) key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Returns the bucket chain link that points to the entry with the given key,
+ * or to the NULL end of the chain if the key is not stored.
+ */
+static DIALDataEntry **find_link(const DIALDataStore *store, const char *key,
+                                 size_t key_len, unsigned int hash) {
+    DIALDataEntry **link = &store->buckets[hash & (store->bucket_count - 1)];
+    for (; *link != NULL; link = &(*link)->hash_next) {
+        if ((*link)->hash == hash && (*link)->key_len == key_len &&
+            !memcmp((*link)->key, key, key_len)) {
+            break;
+        }
+    }
+    return link;
+}
+
+static int exceeds_quota(const DIALDataStore *store, size_t count, size_t bytes) {
+    return (store->max_entries && count > store->max_entries) ||
+           (store->max_bytes && bytes > store->max_bytes);
+}
+
+/**
+ * Remove the entry from the store and free it.
+ */
+static void remove_entry(DIALDataStore *store, DIALDataEntry *entry) {
+    DIALDataEntry **link = find_link(store, entry->key, entry->key_len, entry->hash);
+    *link = entry->hash_next;
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        store->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        store->tail = entry->prev;
+    }
+    store->count--;
+    store->bytes -= entry->key_len + entry->value_len;
+    free(entry);
+}
+
+/**
+ * Evict the oldest entries, other than keep, until count and bytes fit the
+ * quotas once the removed sizes are subtracted.
+ */
+static void evict_oldest(DIALDataStore *store, const DIALDataEntry *keep,
+                         size_t count, size_t bytes) {
+    DIALDataEntry *entry = store->head;
+    while (entry != NULL && exceeds_quota(store, count, bytes)) {
+        DIALDataEntry *next = entry->next;
+        if (entry != keep) {
+            count--;
+            bytes -= entry->key_len + entry->value_len;
+            remove_entry(store, entry);
+        }
+        entry = next;
+    }
+}
+
+/**
+ * Double the number of buckets. Failure to grow is not an error, lookups just
+ * get slower.
+ */
+static void grow(DIALDataStore *store) {
+    size_t bucket_count = store->bucket_count * 2;
+    DIALDataEntry **buckets = (DIALDataEntry **) calloc(bucket_count, sizeof(DIALDataEntry *));
+    if (buckets == NULL) {
+        return;
+    }
+    for (DIALDataEntry *entry = store->head; entry != NULL; entry = entry->next) {
+        DIALDataEntry **bucket = &buckets[entry->hash & (bucket_count - 1)];
+        entry->hash_next = *bucket;
+        *bucket = entry;
+    }
+    free(store->buckets);
+    store->buckets = buckets;
+    store->bucket_count = bucket_count;
+}
+
+DIALDataStore *dial_data_store_create(size_t max_entries, size_t max_bytes,
+                                      DIALDataQuotaPolicy policy) {
+    DIALDataStore *store = (DIALDataStore *) calloc(1, sizeof(DIALDataStore));
+    if (store == NULL) {
+        return NULL;
+    }
+    store->buckets = (DIALDataEntry **) calloc(INITIAL_BUCKETS, sizeof(DIALDataEntry *));
+    if (store->buckets == NULL) {
+        free(store);
+        return NULL;
+    }
+    store->bucket_count = INITIAL_BUCKETS;
+    store->max_entries = max_entries;
+    store->max_bytes = max_bytes;
+    store->policy = policy;
+    return store;
+}
+
+void dial_data_store_free(DIALDataStore **store) {
+    if (*store == NULL) {
+        return;
+    }
+    DIALDataEntry *entry = (*store)->head;
+    while (entry != NULL) {
+        DIALDataEntry *next = entry->next;
+        free(entry);
+        entry = next;
+    }
+    free((*store)->buckets);
+    free(*store);
+    *store = NULL;
+}
+
+int dial_data_store_set_quota(DIALDataStore *store, size_t max_entries,
+                              size_t max_bytes, DIALDataQuotaPolicy policy) {
+    size_t old_max_entries = store->max_entries, old_max_bytes = store->max_bytes;
+    store->max_entries = max_entries;
+    store->max_bytes = max_bytes;
+    if (exceeds_quota(store, store->count, store->bytes)) {
+        if (policy == kDIALDataQuotaReject) {
+            store->max_entries = old_max_entries;
+            store->max_bytes = old_max_bytes;
+            return 0;
+        }
+        evict_oldest(store, NULL, store->count, store->bytes);
+    }
+    store->policy = policy;
+    return 1;
+}
+
+const char *dial_data_store_get(const DIALDataStore *store, const char *key) {
+    size_t key_len = strlen(key);
+    DIALDataEntry *entry = *find_link(store, key, key_len, hash_key(key, key_len));
+    return entry ? entry->value : NULL;
+}
+
+int dial_data_store_set(DIALDataStore *store, const char *key,
+                        const char *value) {
+    size_t key_len = strlen(key), value_len = strlen(value);
+    unsigned int hash = hash_key(key, key_len);
+    DIALDataEntry **link = find_link(store, key, key_len, hash);
+    DIALDataEntry *old = *link;
+
+    // An entry that can never fit is always rejected.
+    if (store->max_bytes && key_len + value_len > store->max_bytes) {
+        return 0;
+    }
+    size_t count = store->count + (old ? 0 : 1);
+    size_t bytes = store->bytes + key_len + value_len -
+            (old ? old->key_len + old->value_len : 0);
+    if (exceeds_quota(store, count, bytes) && store->policy == kDIALDataQuotaReject) {
+        return 0;
+    }
+
+    DIALDataEntry *entry = (DIALDataEntry *) malloc(sizeof(DIALDataEntry) + key_len + value_len + 2);
+    if (entry == NULL) {
+        return -1;
+    }
+    char *strings = (char *) (entry + 1);
+    memcpy(strings, key, key_len + 1);
+    memcpy(strings + key_len + 1, value, value_len + 1);
+    entry->key = strings;
+    entry->value = strings + key_len + 1;
+    entry->key_len = key_len;
+    entry->value_len = value_len;
+    entry->hash = hash;
+
+    if (exceeds_quota(store, count, bytes)) {
+        evict_oldest(store, old, count, bytes);
+        // Eviction may have changed the bucket chain.
+        link = find_link(store, key, key_len, hash);
+    }
+
+    if (old != NULL) {
+        // Take the place of the old entry, in the bucket and in the order.
+        entry->hash_next = old->hash_next;
+        entry->prev = old->prev;
+        entry->next = old->next;
+        *link = entry;
+        if (entry->prev) {
+            entry->prev->next = entry;
+        } else {
+            store->head = entry;
+        }
+        if (entry->next) {
+            entry->next->prev = entry;
+        } else {
+            store->tail = entry;
+        }
+        store->bytes -= old->key_len + old->value_len;
+        free(old);
+    } else {
+        entry->hash_next = NULL;
+        *link = entry;
+        entry->prev = store->tail;
+        entry->next = NULL;
+        if (store->tail) {
+            store->tail->next = entry;
+        } else {
+            store->head = entry;
+        }
+        store->tail = entry;
+        store->count++;
+        if (store->count > store->bucket_count) {
+            grow(store);
+        }
+    }
+    store->bytes += key_len + value_len;
+    return 1;
+}
+
+int dial_data_store_delete(DIALDataStore *store, const char *key) {
+    size_t key_len = strlen(key);
+    DIALDataEntry *entry = *find_link(store, key, key_len, hash_key(key, key_len));
+    if (entry == NULL) {
+        return 0;
+    }
+    remove_entry(store, entry);
+    return 1;
+}
+
+int dial_data_store_replace(DIALDataStore *store, const DIALData *data) {
+    // Build the new contents aside so the store is untouched on failure.
+    DIALDataStore *replacement = dial_data_store_create(store->max_entries,
+                                                        store->max_bytes,
+                                                        store->policy);
+    if (replacement == NULL) {
+        return -1;
+    }
+    for (; data != NULL; data = data->next) {
+        int result = dial_data_store_set(replacement, data->key, data->value);
+        if (result != 1) {
+            dial_data_store_free(&replacement);
+            return result;
+        }
+    }
+
+    DIALDataStore old = *store;
+    *store = *replacement;
+    *replacement = old;
+    dial_data_store_free(&replacement);
+    return 1;
+}
+
+const DIALDataEntry *dial_data_store_first(const DIALDataStore *store) {
+    return store->head;
+}
+
+size_t dial_data_store_count(const DIALDataStore *store) {
+    return store->count;
+}
+
+size_t dial_data_store_bytes(const DIALDataStore *store) {
+    return store->bytes;
+}
+
+DIALData *dial_data_store_to_list(const DIALDataStore *store) {
+    if (store->count == 0) {
+        return NULL;
+    }
+    char *strings;
+    DIALData *result = alloc_dial_data(store->count, store->bytes + 2 * store->count, &strings);
+    if (result == NULL) {
+        return NULL;
+    }
+    DIALData *node = result;
+    for (DIALDataEntry *entry = store->head; entry != NULL; entry = entry->next, node = node->next) {
+        node->key = memcpy(strings, entry->key, entry->key_len + 1);
+        strings += entry->key_len + 1;
+        node->value = memcpy(strings, entry->value, entry->value_len + 1);
+        strings += entry->value_len + 1;
+    }
+    return result;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Per-application DIAL data store with keyed lookup and size quotas.
+ */
+
+#ifndef SRC_SERVER_DIAL_DATA_STORE_H_
+#define SRC_SERVER_DIAL_DATA_STORE_H_
+
+#include "dial_data.h"
+
+#include <stddef.h>
+
+/*
+ * Default per-application quotas. A quota of 0 means unlimited.
+ */
+#define DIAL_DATA_STORE_DEFAULT_MAX_ENTRIES (1024)
+#define DIAL_DATA_STORE_DEFAULT_MAX_BYTES (64 * 1024)
+
+/*
+ * What to do when an update would exceed a store quota.
+ */
+typedef enum {
+    kDIALDataQuotaReject,       // refuse the update, leaving the store as is
+    kDIALDataQuotaEvictOldest,  // evict the least recently inserted entries
+} DIALDataQuotaPolicy;
+
+/**
+ * A key/value entry. The strings are owned by the store and remain valid
+ * until the entry is updated, deleted or evicted.
+ */
+struct DIALDataEntry_ {
+    const char *key;
+    const char *value;
+    size_t key_len;
+    size_t value_len;
+    struct DIALDataEntry_ *prev;        // insertion order
+    struct DIALDataEntry_ *next;
+    struct DIALDataEntry_ *hash_next;   // hash bucket chain
+    unsigned int hash;
+};
+
+typedef struct DIALDataEntry_ DIALDataEntry;
+
+struct DIALDataStore_;
+typedef struct DIALDataStore_ DIALDataStore;
+
+/**
+ * Create an empty store.
+ *
+ * @param max_entries maximum number of entries, or 0 for no limit.
+ * @param max_bytes maximum total size of the keys and values, or 0 for no
+ *        limit.
+ * @param policy what to do when an update would exceed a quota.
+ * @return the store or NULL if out-of-memory.
+ */
+DIALDataStore *dial_data_store_create(size_t max_entries, size_t max_bytes,
+                                      DIALDataQuotaPolicy policy);
+
+/**
+ * Frees the store and all of its entries.
+ *
+ * @param store pointer to the store, set to NULL.
+ */
+void dial_data_store_free(DIALDataStore **store);
+
+/**
+ * Change the store quotas. Entries already stored are evicted or kept
+ * according to the new policy.
+ *
+ * @return 1 if the current contents fit the new quotas, 0 if they do not and
+ *         the policy is kDIALDataQuotaReject (the quotas are then unchanged).
+ */
+int dial_data_store_set_quota(DIALDataStore *store, size_t max_entries,
+                              size_t max_bytes, DIALDataQuotaPolicy policy);
+
+/**
+ * Look up the value of a key.
+ *
+ * @return the value or NULL if the key is not stored.
+ */
+const char *dial_data_store_get(const DIALDataStore *store, const char *key);
+
+/**
+ * Add or update a key. An updated key keeps its insertion position.
+ *
+ * @return 1 if stored, 0 if rejected by the quotas, -1 if out-of-memory.
+ */
+int dial_data_store_set(DIALDataStore *store, const char *key,
+                        const char *value);
+
+/**
+ * Delete a key.
+ *
+ * @return 1 if the key was deleted, 0 if it was not stored.
+ */
+int dial_data_store_delete(DIALDataStore *store, const char *key);
+
+/**
+ * Replace the whole contents of the store with the provided list. On
+ * rejection or error the store is left unchanged.
+ *
+ * @param data the new contents, may be NULL to clear the store.
+ * @return 1 if replaced, 0 if rejected by the quotas, -1 if out-of-memory.
+ */
+int dial_data_store_replace(DIALDataStore *store, const DIALData *data);
+
+/**
+ * Iterate over the entries in insertion order:
+ *
+ *     for (e = dial_data_store_first(store); e; e = e->next) ...
+ *
+ * @return the oldest entry or NULL if the store is empty.
+ */
+const DIALDataEntry *dial_data_store_first(const DIALDataStore *store);
+
+/**
+ * @return the number of entries in the store.
+ */
+size_t dial_data_store_count(const DIALDataStore *store);
+
+/**
+ * @return the total size of the keys and values in the store.
+ */
+size_t dial_data_store_bytes(const DIALDataStore *store);
+
+/**
+ * Copy the store contents into a DIAL data list, e.g. for persistence.
+ *
+ * @return the list, or NULL if the store is empty or out-of-memory. The
+ *         caller must free the list with free_dial_data().
+ */
+DIALData *dial_data_store_to_list(const DIALDataStore *store);
+
+#endif /* SRC_SERVER_DIAL_DATA_STORE_H_ */
@@ -54,6 +54,38 @@
 #define SLEEP_PASSWORD_LONG "--sleep-password"
 #define SLEEP_PASSWORD_DESCRIPTION "Password required to put the device to deep sleep"
 
+#define DIAL_DATA_STORE_OPTION "-B"
+#define DIAL_DATA_STORE_OPTION_LONG "--dial-data-store"
+#define DIAL_DATA_STORE_DESCRIPTION "Keep DIAL data in a single store file instead of one file per application"
+
+#define PROC_REFRESH_OPTION "-P"
+#define PROC_REFRESH_OPTION_LONG "--proc-refresh-ms"
+#define PROC_REFRESH_DESCRIPTION "Minimum time between two walks of /proc to find running applications, in milliseconds.  Default (250)"
+
+#define ZYGOTE_OPTION "-Z"
+#define ZYGOTE_OPTION_LONG "--zygote"
+#define ZYGOTE_DESCRIPTION "Launch applications from a helper process forked at startup.  Value: on/off.  Default (off)"
+
+#define WARM_APPS_OPTION "-H"
+#define WARM_APPS_OPTION_LONG "--warm-apps"
+#define WARM_APPS_DESCRIPTION "Keep hidden applications resident, suspended, and resume them on launch.  Value: on/off/prelaunch.  Default (off)"
+
+#define RESUME_SIGNAL_OPTION "-R"
+#define RESUME_SIGNAL_OPTION_LONG "--resume-signal"
+#define RESUME_SIGNAL_DESCRIPTION "Signal number telling a resumed application to read its new launch arguments from the <app>.launch file of the DIAL data directory.  Default (0, none)"
+
+#define STOP_GRACE_OPTION "-G"
+#define STOP_GRACE_OPTION_LONG "--stop-grace-ms"
+#define STOP_GRACE_DESCRIPTION "Time a stopped application has to exit before it is killed, in milliseconds.  Default (3000)"
+
+#define CONTROL_SOCKET_OPTION "-C"
+#define CONTROL_SOCKET_OPTION_LONG "--control-socket"
+#define CONTROL_SOCKET_DESCRIPTION "Path of a local socket on which applications post their DIAL data and report their state.  Default (none)"
+
+#define APP_STATE_SHM_OPTION "-S"
+#define APP_STATE_SHM_OPTION_LONG "--app-state-shm"
+#define APP_STATE_SHM_DESCRIPTION "Name of a shared memory object, e.g. /dial_app_state, in which the application states are published.  Default (none)"
+
 struct dial_options
 {
     const char * pOption;
@@ -97,6 +129,46 @@ struct dial_options gDialOptions[] =
         SLEEP_PASSWORD,
         SLEEP_PASSWORD_LONG,
         SLEEP_PASSWORD_DESCRIPTION
+    },
+    {
+        DIAL_DATA_STORE_OPTION,
+        DIAL_DATA_STORE_OPTION_LONG,
+        DIAL_DATA_STORE_DESCRIPTION
+    },
+    {
+        PROC_REFRESH_OPTION,
+        PROC_REFRESH_OPTION_LONG,
+        PROC_REFRESH_DESCRIPTION
+    },
+    {
+        ZYGOTE_OPTION,
+        ZYGOTE_OPTION_LONG,
+        ZYGOTE_DESCRIPTION
+    },
+    {
+        WARM_APPS_OPTION,
+        WARM_APPS_OPTION_LONG,
+        WARM_APPS_DESCRIPTION
+    },
+    {
+        RESUME_SIGNAL_OPTION,
+        RESUME_SIGNAL_OPTION_LONG,
+        RESUME_SIGNAL_DESCRIPTION
+    },
+    {
+        STOP_GRACE_OPTION,
+        STOP_GRACE_OPTION_LONG,
+        STOP_GRACE_DESCRIPTION
+    },
+    {
+        CONTROL_SOCKET_OPTION,
+        CONTROL_SOCKET_OPTION_LONG,
+        CONTROL_SOCKET_DESCRIPTION
+    },
+    {
+        APP_STATE_SHM_OPTION,
+        APP_STATE_SHM_OPTION_LONG,
+        APP_STATE_SHM_DESCRIPTION
     }
 };
 
@@ -23,48 +23,158 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#define _GNU_SOURCE
+#include "app_state_shm.h"
 #include "dial_data.h"
+#include "dial_data_store.h"
 #include "dial_server.h"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <pthread.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
 
+#include "http_watch.h"
 #include "mongoose.h"
+#include "rate_limit.h"
+#include "rcu.h"
 #include "url_lib.h"
 
 // TODO: Partners should define this port
 #define DIAL_PORT (56789)
 #define DIAL_DATA_SIZE (8*1024)
+// Longest time a status request waits for a state change
+#define DIAL_WATCH_TIMEOUT_MS (30000)
 
 static const char * const gLocalhost = "127.0.0.1";
 static const char * const gHttpsProto = "https://";
 
-struct DIALApp_ {
-    struct DIALApp_ *next;
+static const char gEmptyPayload[] = "";
+
+/*
+ * Reference-counted string shared by application state snapshots, such as
+ * the launch payload which callbacks may hold on to.
+ */
+typedef struct {
+    int refcount;
+    size_t len;
+    char data[];
+} DIALBlob;
+
+/*
+ * Mutable application state. A published snapshot is never modified; updates
+ * publish a new one, so a reader gets a consistent view with a single load.
+ */
+typedef struct {
+    RcuHead rcu;
+    DIALStatus state;
+    DIAL_run_t run_id;
+    DIALBlob *payload;          // NULL if empty
+    DIALBlob *additional_data;  // rendered additionalData elements, or NULL
+    int can_stop;               // as last reported, if the state is pushed
+    unsigned long version;
+} DIALAppSnapshot;
+
+/*
+ * Registration data, immutable once the application is published. The name
+ * and the CORS list are stored in the same allocation, right-sized.
+ */
+typedef struct {
     struct DIALAppCallbacks callbacks;
-    struct DIALData_ *dial_data;
     void *callback_data;
-    DIAL_run_t run_id;
-    DIALStatus state;
-    char *name;
-    char payload[DIAL_MAX_PAYLOAD];
+    DIALDataStore *dial_data;   // contents guarded by the application lock
+    char **cors_origins;        // NULL-terminated, NULL if any origin is allowed
     int useAdditionalData;
-    char corsAllowedOrigin[256];
+    int statePushed;            // state reported by DIAL_report_state() only
+    int provided;               // registered on demand by the app provider
+    char name[];
+} DIALAppInfo;
+
+/*
+ * Launch responses of an application, built once for the address and port
+ * the server is reached on so a launch only splices in the origin.
+ */
+typedef struct {
+    struct in_addr local_addr;
+    in_port_t port;
+    char additional_data_param[DIAL_MAX_ADDITIONALURL];
+    uint64_t last_launch_hash;  // payload and query string of the last launch
+    uint64_t last_launch_ms;    // when it started, 0 if none
+    DIALStatus last_state;      // and its result
+    DIAL_run_t last_run_id;
+    size_t created_len;
+    char created[];             // 201 Created head, up to the origin
+} DIALLaunchResponses;
 
+/*
+ * The part of an application every request touches, kept within two cache
+ * lines.
+ */
+struct DIALApp_ {
+    DIALAppSnapshot *snapshot;  // published, see rcu.h
+    const DIALAppInfo *info;
+    pthread_mutex_t lock;       // serializes the callbacks and updates
+    unsigned long last_used;    // use_clock at the last use, if provided
+    RcuHead rcu;
+    AppStateShm *state_shm;     // where the state is published, guarded by the lock
+    int state_slot;
+    DIALLaunchResponses *launch_responses;  // guarded by the lock, or NULL
+    int unregistered;           // removed from the table, set under the lock
 };
 
 typedef struct DIALApp_ DIALApp;
 
+/*
+ * Registered applications, with their name hashes so a lookup only
+ * compares the names of likely matches. A table is never modified once
+ * published; registration publishes a new one.
+ */
+typedef struct {
+    uint32_t name_hash;
+    DIALApp *app;
+} DIALAppEntry;
+
+typedef struct {
+    RcuHead rcu;
+    size_t count;
+    DIALAppEntry entries[];
+} DIALAppTable;
+
+/*
+ * An application name the app provider did not know.
+ */
+typedef struct {
+    uint32_t name_hash;
+    time_t expires;
+    char *name;
+} DIALProviderMiss;
+
 struct DIALServer_ {
     struct mg_context *ctx;
-    struct DIALApp_ *apps;
-    pthread_mutex_t mux;
+    DIALAppTable *apps;         // published, see rcu.h
+    pthread_mutex_t mux;        // serializes registration and the provider
+    unsigned int data_write_window_ms;
+    in_port_t port;
+    in_port_t listen_port;      // the port listened on once started, or 0
+
+    DIAL_app_provider_cb provider;
+    void *provider_data;
+    size_t max_provided_apps;
+    unsigned long use_clock;    // orders the uses of provided applications
+    pthread_mutex_t miss_mux;   // guards the misses
+    DIALProviderMiss misses[DIAL_PROVIDER_MISS_CACHE_SIZE];
+    AppStateShm *state_shm;     // see DIAL_publish_app_states()
+    char *state_shm_name;
+    RateLimit rate_limits[kDIALRateNumClasses];
+    RateLimiter *rate_limiter;  // NULL if not started
+    unsigned int launch_debounce_ms;
 };
 
 /**
@@ -96,46 +206,255 @@ static int ds_unlock(DIALServer *ds) {
 }
 
 /**
- * Finds an application in the DIAL server application linked list.
+ * FNV-1a hash of an application name.
+ */
+static uint32_t hash_app_name(const char *app_name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *) app_name; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Finds an application in the published application table.
+ *
+ * Must be called from a read-side critical section, or with the DIAL server
+ * mutex held; the application remains valid until either ends.
  *
  * @param ds the DIAL server.
  * @param app_name application name.
- * @return a pointer to the DIAL application; the pointer value may be NULL if
- *         the application was not found.
+ * @return the DIAL application or NULL if the application was not found.
  */
-static DIALApp **find_app(DIALServer *ds, const char *app_name) {
-    DIALApp *app;
-    DIALApp **ret = &ds->apps;
-
-    for (app = ds->apps; app != NULL; ret = &app->next, app = app->next) {
-        if (!strcmp(app_name, app->name)) {
-            break;
+static DIALApp *find_app(DIALServer *ds, const char *app_name) {
+    DIALAppTable *table = rcu_dereference(ds->apps);
+    uint32_t name_hash = hash_app_name(app_name);
+    for (size_t i = 0; table != NULL && i < table->count; i++) {
+        if (table->entries[i].name_hash == name_hash &&
+            !strcmp(app_name, table->entries[i].app->info->name)) {
+            return table->entries[i].app;
         }
     }
-    return ret;
+    return NULL;
+}
+
+static DIALApp *lookup_app(DIALServer *ds, const char *app_name);
+
+static DIALBlob *blob_create(const char *data, size_t len) {
+    DIALBlob *blob = (DIALBlob *) malloc(sizeof(DIALBlob) + len + 1);
+    if (blob != NULL) {
+        blob->refcount = 1;
+        blob->len = len;
+        memcpy(blob->data, data, len);
+        blob->data[len] = '\0';
+    }
+    return blob;
+}
+
+static DIALBlob *blob_retain(DIALBlob *blob) {
+    if (blob != NULL) {
+        __atomic_add_fetch(&blob->refcount, 1, __ATOMIC_RELAXED);
+    }
+    return blob;
+}
+
+static void blob_release(DIALBlob *blob) {
+    if (blob != NULL && __atomic_sub_fetch(&blob->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(blob);
+    }
+}
+
+static void free_snapshot(RcuHead *head) {
+    DIALAppSnapshot *snapshot = (DIALAppSnapshot *) head;
+    blob_release(snapshot->payload);
+    blob_release(snapshot->additional_data);
+    free(snapshot);
+}
+
+/**
+ * Copy the current state snapshot of an application, to be updated and
+ * published with publish_snapshot().
+ *
+ * Must be called with the application lock held.
+ *
+ * @return the copy or NULL if out-of-memory.
+ */
+static DIALAppSnapshot *copy_snapshot(DIALApp *app) {
+    DIALAppSnapshot *copy = (DIALAppSnapshot *) malloc(sizeof(DIALAppSnapshot));
+    if (copy != NULL) {
+        *copy = *app->snapshot;
+        blob_retain(copy->payload);
+        blob_retain(copy->additional_data);
+    }
+    return copy;
+}
+
+/**
+ * Write the current state of an application in the shared memory segment,
+ * if it is published there.
+ *
+ * Must be called with the application lock held, or before the application
+ * is published.
+ */
+static void write_shared_state(DIALApp *app) {
+    const DIALAppSnapshot *snapshot = app->snapshot;
+    if (app->state_shm != NULL) {
+        app_state_shm_update(app->state_shm, app->state_slot, snapshot->state,
+                             (uint64_t) (uintptr_t) snapshot->run_id, snapshot->version,
+                             snapshot->payload != NULL ? snapshot->payload->len : 0);
+    }
+}
+
+/**
+ * Publish a new state snapshot of an application and retire the previous
+ * one.
+ *
+ * Must be called with the application lock held.
+ */
+static void publish_snapshot(DIALApp *app, DIALAppSnapshot *snapshot) {
+    DIALAppSnapshot *old = app->snapshot;
+    snapshot->version = old->version + 1;
+    rcu_assign_pointer(app->snapshot, snapshot);
+    rcu_retire(&old->rcu, free_snapshot);
+    write_shared_state(app);
+    http_watch_notify();
+}
+
+/**
+ * Publish the state of an application in the shared memory segment of the
+ * server, if any.
+ *
+ * Must be called with the DIAL server mutex held, and the application lock
+ * if the application is published.
+ */
+static void share_app_state(DIALServer *ds, DIALApp *app) {
+    if (ds->state_shm == NULL || app->state_shm != NULL) {
+        return;
+    }
+    app->state_slot = app_state_shm_claim(ds->state_shm, app->info->name);
+    if (app->state_slot == -1) {
+        printf("Unable to publish the %s state in shared memory.\n", app->info->name);
+        return;
+    }
+    app->state_shm = ds->state_shm;
+    write_shared_state(app);
 }
 
 /**
- * URL-unescape the string, then XML-escape it.
+ * Stop publishing the state of an application in shared memory.
  *
- * @param dst the destination XML-escaped string. Must be large enough for
- *        the resulting string (technically as much as 6x the raw string
- *        length based on the implementation in url_lib.c).
- * @param src the URL-escaped string.
- * @param src_size size of the URL-escaped string, including trailing NULL.
- * @return true if successful, false if out-of-memory.
+ * Must be called with the application lock held, or before the application
+ * is published.
  */
-static int url_decode_xml_encode(char *dst, char *src, size_t src_size) {
-    char *url_decoded_key = (char *) malloc(src_size + 1);
-    if (url_decoded_key == NULL) {
+static void unshare_app_state(DIALApp *app) {
+    if (app->state_shm != NULL) {
+        app_state_shm_release(app->state_shm, app->state_slot);
+        app->state_shm = NULL;
+    }
+}
+
+/**
+ * Publish a new application state, unless it is unchanged.
+ *
+ * Must be called with the application lock held.
+ */
+static void set_app_state(DIALApp *app, DIALStatus state, DIAL_run_t run_id) {
+    if (app->snapshot->state == state && app->snapshot->run_id == run_id) {
+        return;
+    }
+    DIALAppSnapshot *snapshot = copy_snapshot(app);
+    if (snapshot == NULL) {
+        printf("Unable to update the %s state, out-of-memory.\n", app->info->name);
+        return;
+    }
+    snapshot->state = state;
+    snapshot->run_id = run_id;
+    publish_snapshot(app, snapshot);
+}
+
+/**
+ * Render the additionalData elements of the status response.
+ *
+ * @param dial_data the application DIAL data.
+ * @param rendered set to the rendered elements, or NULL if there are none.
+ * @return 1 if successful, 0 if out-of-memory.
+ */
+static int render_additional_data(DIALDataStore *dial_data, DIALBlob **rendered) {
+    // Measure the rendered elements first so they can be written in one pass.
+    size_t len = 0;
+    const DIALDataEntry *first;
+    for (first = dial_data_store_first(dial_data); first != NULL; first = first->next) {
+        size_t key_len = url_decode_xml_encode_len(first->key);
+        len += sizeof("    <") - 1 + key_len + sizeof(">") - 1
+                + url_decode_xml_encode_len(first->value)
+                + sizeof("</") - 1 + key_len + sizeof(">") - 1;
+    }
+    *rendered = NULL;
+    if (len == 0) {
+        return 1;
+    }
+    DIALBlob *blob = (DIALBlob *) malloc(sizeof(DIALBlob) + len + 1);
+    if (blob == NULL) {
         return 0;
     }
-    urldecode(url_decoded_key, src, src_size);
-    xmlencode(dst, url_decoded_key, 2 * src_size);
-    free(url_decoded_key);
+    blob->refcount = 1;
+    blob->len = len;
+    char *p = blob->data;
+    for (first = dial_data_store_first(dial_data); first != NULL; first = first->next) {
+        char *key;
+        p = smartstrncpy(p, "    <", sizeof("    <") - 1);
+        key = p;
+        p = url_decode_xml_encode(p, first->key);
+        size_t key_len = p - key;
+        *p++ = '>';
+        p = url_decode_xml_encode(p, first->value);
+        p = smartstrncpy(p, "</", sizeof("</") - 1);
+        memcpy(p, key, key_len);
+        p += key_len;
+        *p++ = '>';
+    }
+    *p = '\0';
+    *rendered = blob;
     return 1;
 }
 
+/**
+ * Publish the application's updated DIAL data and queue it to be written to
+ * the data store on disk by the background writer.
+ *
+ * Must be called with the application lock held.
+ *
+ * @param app the DIAL application.
+ */
+static void persist_dial_data(DIALApp *app) {
+    DIALAppSnapshot *snapshot = copy_snapshot(app);
+    if (snapshot == NULL) {
+        printf("Unable to update the %s DIAL data, out-of-memory.\n", app->info->name);
+    } else {
+        blob_release(snapshot->additional_data);
+        if (!render_additional_data(app->info->dial_data, &snapshot->additional_data)) {
+            printf("Unable to render the %s DIAL data, out-of-memory.\n", app->info->name);
+        }
+        publish_snapshot(app, snapshot);
+    }
+    queue_dial_data(app->info->name, dial_data_store_to_list(app->info->dial_data));
+}
+
+/**
+ * Replace the DIAL data of an application and persist it.
+ *
+ * Must be called with the application lock held.
+ *
+ * @return 1 if replaced, 0 if rejected by the quotas, -1 if out-of-memory.
+ */
+static int replace_app_data(DIALApp *app, const DIALData *data) {
+    int result = dial_data_store_replace(app->info->dial_data, data);
+    if (result == 1) {
+        persist_dial_data(app);
+    }
+    return result;
+}
+
 /**
  * Checks if a payload string contains invalid characters.
  *
@@ -158,74 +477,549 @@ static int isBadPayload(const char* pPayload, int numBytes) {
     return 0;
 }
 
+static const char gOkHead[] = "HTTP/1.1 200 OK\r\n";
+static const char gOkTextHead[] = "HTTP/1.1 200 OK\r\n"
+                                  "Content-Type: text/plain\r\n";
+
+#define PREFLIGHT_HEAD(methods) "HTTP/1.1 204 No Content\r\n" \
+                                "Access-Control-Allow-Methods: " methods "\r\n" \
+                                "Access-Control-Max-Age: 86400\r\n" \
+                                "Content-Length: 0\r\n"
+
+static const char gPreflightRun[] = PREFLIGHT_HEAD("DELETE, OPTIONS");
+static const char gPreflightApp[] = PREFLIGHT_HEAD("GET, POST, OPTIONS");
+static const char gPreflightPost[] = PREFLIGHT_HEAD("POST, OPTIONS");
+static const char gPreflightApps[] = PREFLIGHT_HEAD("GET, OPTIONS");
+
+/*
+ * Complete error responses, built once.
+ */
+typedef struct {
+    int status;
+    const char *reason;
+    char *response;
+    int len;
+} DIALErrorResponse;
+
+static DIALErrorResponse gErrorResponses[] = {
+    { 400, "Bad Request", NULL, 0 },
+    { 401, "Unauthorized", NULL, 0 },
+    { 403, "Forbidden", NULL, 0 },
+    { 404, "Not Found", NULL, 0 },
+    { 413, "Request Entity Too Large", NULL, 0 },
+    { 429, "Too Many Requests", NULL, 0 },
+    { 500, "Internal Server Error", NULL, 0 },
+    { 501, "Not Implemented", NULL, 0 },
+    { 503, "Service Unavailable", NULL, 0 },
+};
+
+static pthread_once_t gErrorResponsesOnce = PTHREAD_ONCE_INIT;
+
+static void build_error_responses() {
+    for (size_t i = 0; i < sizeof(gErrorResponses) / sizeof(gErrorResponses[0]); i++) {
+        DIALErrorResponse *error = &gErrorResponses[i];
+        char body[64];
+        int body_len = snprintf(body, sizeof(body), "Error %d: %s\n",
+                                error->status, error->reason);
+        error->len = asprintf(&error->response,
+                              "HTTP/1.1 %d %s\r\n"
+                              "Content-Type: text/plain\r\n"
+                              "Content-Length: %d\r\n"
+                              "Connection: close\r\n"
+                              "\r\n"
+                              "%s",
+                              error->status, error->reason, body_len, body);
+        if (error->len < 0) {
+            error->response = NULL;
+        }
+    }
+}
+
+/**
+ * Send a prebuilt error response with an extra header after the status line.
+ *
+ * @param status one of the HTTP statuses of gErrorResponses.
+ * @param header the header line, terminated with CRLF, or NULL for none.
+ */
+static void send_error_with_header(struct mg_connection *conn, int status,
+                                   const char *header) {
+    for (size_t i = 0; i < sizeof(gErrorResponses) / sizeof(gErrorResponses[0]); i++) {
+        const DIALErrorResponse *error = &gErrorResponses[i];
+        if (error->status != status) {
+            continue;
+        }
+        if (error->response == NULL) {
+            mg_printf(conn, "HTTP/1.1 %d %s\r\n%s\r\n", status, error->reason,
+                      header != NULL ? header : "");
+        } else if (header == NULL) {
+            mg_write(conn, error->response, error->len);
+        } else {
+            size_t line_len = strstr(error->response, "\r\n") + 2 - error->response;
+            struct iovec iov[3] = {
+                { error->response, line_len },
+                { (void *) header, strlen(header) },
+                { error->response + line_len, error->len - line_len },
+            };
+            mg_writev(conn, iov, 3);
+        }
+        return;
+    }
+}
+
+/**
+ * Send a prebuilt error response.
+ *
+ * @param status one of the HTTP statuses of gErrorResponses.
+ */
+static void send_error(struct mg_connection *conn, int status) {
+    send_error_with_header(conn, status, NULL);
+}
+
+/**
+ * Send a response head with the Access-Control-Allow-Origin header of the
+ * request origin, in a single write.
+ *
+ * @param head status line and headers, each terminated with CRLF.
+ * @param origin_header the request origin, or NULL to omit the header.
+ */
+static void send_response(struct mg_connection *conn, const char *head, size_t head_len,
+                          const char *origin_header) {
+    static const char allow_origin[] = "Access-Control-Allow-Origin: ";
+    struct iovec iov[4] = {{ (void *) head, head_len }};
+    int iovcnt = 1;
+    if (origin_header != NULL) {
+        iov[iovcnt++] = (struct iovec) { (void *) allow_origin, sizeof(allow_origin) - 1 };
+        iov[iovcnt++] = (struct iovec) { (void *) origin_header, strlen(origin_header) };
+        iov[iovcnt++] = (struct iovec) { "\r\n\r\n", 4 };
+    } else {
+        iov[iovcnt++] = (struct iovec) { "\r\n", 2 };
+    }
+    mg_writev(conn, iov, iovcnt);
+}
+
+/*
+ * Format and arguments of an Access-Control-Allow-Origin header line for
+ * responses that are formatted rather than sent with send_response(). The
+ * line is left out when there is no request origin.
+ */
+#define ALLOW_ORIGIN_FMT "%s%s%s"
+#define ALLOW_ORIGIN_ARGS(origin) \
+    (origin) != NULL ? "Access-Control-Allow-Origin: " : "", \
+    (origin) != NULL ? (origin) : "", \
+    (origin) != NULL ? "\r\n" : ""
+
+/**
+ * Return the launch responses of an application for the address and port
+ * the request came in on, building them if needed.
+ *
+ * Must be called with the application lock held.
+ *
+ * @return the launch responses or NULL if out-of-memory.
+ */
+static DIALLaunchResponses *get_launch_responses(DIALServer *ds, DIALApp *app,
+                                                       const struct sockaddr_in *local_addr) {
+    DIALLaunchResponses *launch = app->launch_responses;
+    in_port_t dial_port = DIAL_get_port(ds);
+    if (launch != NULL && launch->port == dial_port
+            && launch->local_addr.s_addr == local_addr->sin_addr.s_addr) {
+        return launch;
+    }
+
+    char laddr[INET6_ADDRSTRLEN];
+    inet_ntop(local_addr->sin_family, &local_addr->sin_addr, laddr, sizeof(laddr));
+    static const char created_format[] = "HTTP/1.1 201 Created\r\n"
+                                         "Content-Type: text/plain\r\n"
+                                         "Location: http://%s:%d/apps/%s/run\r\n";
+    int created_len = snprintf(NULL, 0, created_format, laddr, dial_port, app->info->name);
+    launch = malloc(sizeof(DIALLaunchResponses) + created_len + 1);
+    if (launch == NULL) {
+        return NULL;
+    }
+    launch->local_addr = local_addr->sin_addr;
+    launch->port = dial_port;
+    launch->last_launch_ms = 0;
+    if (app->launch_responses != NULL) {
+        launch->last_launch_hash = app->launch_responses->last_launch_hash;
+        launch->last_launch_ms = app->launch_responses->last_launch_ms;
+        launch->last_state = app->launch_responses->last_state;
+        launch->last_run_id = app->launch_responses->last_run_id;
+    }
+    // Construct additionalDataUrl=http://host:port/apps/app_name/dial_data
+    snprintf(launch->additional_data_param, DIAL_MAX_ADDITIONALURL,
+            "additionalDataUrl=http%%3A%%2F%%2Flocalhost%%3A%d%%2Fapps%%2F%s%%2Fdial_data%%3F",
+            dial_port, app->info->name);
+    launch->created_len = created_len;
+    snprintf(launch->created, created_len + 1, created_format, laddr, dial_port, app->info->name);
+    free(app->launch_responses);
+    app->launch_responses = launch;
+    return launch;
+}
+
+static uint64_t monotonic_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * FNV-1a hash of a launch payload and query string.
+ */
+static uint64_t hash_launch(const char *payload, size_t payload_len, const char *query_string) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < payload_len; i++) {
+        hash = (hash ^ (unsigned char) payload[i]) * 1099511628211ull;
+    }
+    // Separate the payload from the query string.
+    hash = (hash ^ 0x100) * 1099511628211ull;
+    for (const char *p = query_string; p != NULL && *p; p++) {
+        hash = (hash ^ (unsigned char) *p) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * Returns true if a launch repeats the last one within the debounce window,
+ * and the application is still in the state that one left it in.
+ *
+ * Must be called with the application lock held.
+ */
+static int is_repeated_launch(const DIALServer *ds, const DIALApp *app,
+                              const DIALLaunchResponses *launch,
+                              uint64_t launch_hash, uint64_t now) {
+    return ds->launch_debounce_ms > 0 && launch->last_launch_ms != 0 &&
+           now - launch->last_launch_ms < ds->launch_debounce_ms &&
+           launch->last_launch_hash == launch_hash &&
+           app->snapshot->state == launch->last_state &&
+           app->snapshot->run_id == launch->last_run_id;
+}
+
+static void send_launch_result(struct mg_connection *conn, const DIALLaunchResponses *launch,
+                               DIALStatus state, const char *origin_header) {
+    if (state == kDIALStatusRunning) {
+        send_response(conn, launch->created, launch->created_len, origin_header);
+    } else if (state == kDIALStatusErrorForbidden) {
+        send_error(conn, 403);
+    } else if (state == kDIALStatusErrorUnauth) {
+        send_error(conn, 401);
+    } else if (state == kDIALStatusErrorNotImplemented) {
+        send_error(conn, 501);
+    } else {
+        send_error(conn, 503);
+    }
+}
+
+/**
+ * Returns true if the request announces a body larger than max_size, so it
+ * can be refused before the body is read (or sent, see mg_read()).
+ */
+static int content_too_large(const struct mg_connection *conn, size_t max_size) {
+    const char *content_length = mg_get_header(conn, "Content-Length");
+    return content_length != NULL && strtoull(content_length, NULL, 10) > max_size;
+}
+
+/**
+ * Lock an application returned by lookup_app(), unless it was unregistered
+ * meanwhile, e.g. evicted to make room for a provided application.
+ *
+ * @return 1 if the application is locked, 0 if it is gone.
+ */
+static int lock_registered_app(DIALApp *app) {
+    pthread_mutex_lock(&app->lock);
+    if (app->unregistered) {
+        pthread_mutex_unlock(&app->lock);
+        return 0;
+    }
+    return 1;
+}
+
 static void handle_app_start(struct mg_connection *conn,
                              const struct mg_request_info *request_info,
                              const char *app_name,
                              const char *origin_header) {
-    char additional_data_param[DIAL_MAX_ADDITIONALURL] = {0, };
-    char body[DIAL_MAX_PAYLOAD + sizeof(additional_data_param) + 2] = {0, };
+    char body[DIAL_MAX_PAYLOAD + DIAL_MAX_ADDITIONALURL + 2] = {0, };
     DIALApp *app;
     DIALServer *ds = request_info->user_data;
+    DIALLaunchResponses *launch;
+    uint64_t launch_hash, now;
     int body_size;
 
-    if (!ds_lock(ds)) {
-        mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
+    rcu_read_lock();
+    app = lookup_app(ds, app_name);
+    if (!app) {
+        send_error(conn, 404);
+        rcu_read_unlock();
         return;
     }
-    app = *find_app(ds, app_name);
-    if (!app) {
-        mg_send_http_error(conn, 404, "Not Found", "Not Found");
+    if (content_too_large(conn, DIAL_MAX_PAYLOAD)) {
+        send_error(conn, 413);
+        rcu_read_unlock();
+        return;
+    }
+    if (!lock_registered_app(app)) {
+        send_error(conn, 404);
+        rcu_read_unlock();
+        return;
+    }
+    body_size = mg_read(conn, body, sizeof(body) - 1);
+    if (body_size > DIAL_MAX_PAYLOAD) {
+        send_error(conn, 413);
+    } else if (isBadPayload(body, body_size)) {
+        send_error(conn, 400);
+    } else if ((launch = get_launch_responses(ds, app, &request_info->local_addr)) == NULL) {
+        send_error(conn, 500);
+    } else if (is_repeated_launch(ds, app, launch,
+                                  launch_hash = hash_launch(body, body_size,
+                                                            request_info->query_string),
+                                  now = monotonic_ms())) {
+        fprintf(stderr, "Repeated launch of %s, answering with the previous result\n", app_name);
+        send_launch_result(conn, launch, launch->last_state, origin_header);
+    } else {
+        fprintf(stderr, "Starting the app with params %s\n", body);
+        DIAL_run_t run_id = app->snapshot->run_id;
+        DIALStatus state = app->info->callbacks.start_cb(ds, app_name, body,
+                                                   request_info->query_string,
+                                                   app->info->useAdditionalData ?
+                                                   launch->additional_data_param : "",
+                                                   &run_id,
+                                                   app->info->callback_data);
+        DIALAppSnapshot *snapshot = copy_snapshot(app);
+        if (snapshot != NULL) {
+            snapshot->state = state;
+            snapshot->run_id = run_id;
+        }
+        send_launch_result(conn, launch, state, origin_header);
+        // keep the payload, callbacks may look it up on later launches
+        if (state == kDIALStatusRunning && snapshot != NULL) {
+            blob_release(snapshot->payload);
+            snapshot->payload = body_size > 0 ? blob_create(body, body_size) : NULL;
+        }
+        launch->last_launch_hash = launch_hash;
+        launch->last_launch_ms = now;
+        launch->last_state = state;
+        launch->last_run_id = run_id;
+        if (snapshot != NULL) {
+            publish_snapshot(app, snapshot);
+        } else {
+            printf("Unable to update the %s state, out-of-memory.\n", app->info->name);
+        }
+    }
+    pthread_mutex_unlock(&app->lock);
+    rcu_read_unlock();
+}
+
+/**
+ * Refresh the state of an application from its status callback.
+ *
+ * Must be called with the application lock held.
+ *
+ * @param canStop set to whether the application can be stopped.
+ * @return the application state.
+ */
+static DIALStatus refresh_app_state(DIALServer *ds, DIALApp *app, int *canStop) {
+    if (app->info->statePushed) {
+        *canStop = app->snapshot->can_stop;
+        return app->snapshot->state;
+    }
+    DIAL_run_t run_id = app->snapshot->run_id;
+    DIALStatus state = app->info->callbacks.status_cb(ds, app->info->name, run_id, canStop,
+                                                app->info->callback_data);
+    set_app_state(app, state, run_id);
+    return state;
+}
+
+/**
+ * Read the current state of an application, from its status callback unless
+ * the state is pushed.
+ *
+ * Must be called from a read-side critical section.
+ *
+ * @return the current state snapshot.
+ */
+static const DIALAppSnapshot *read_app_state(DIALServer *ds, DIALApp *app, int *canStop) {
+    // Only the status callback needs the application lock; the response is
+    // rendered from the published snapshot. A pushed state is served as is.
+    if (!app->info->statePushed && lock_registered_app(app)) {
+        refresh_app_state(ds, app, canStop);
+        pthread_mutex_unlock(&app->lock);
+    }
+    const DIALAppSnapshot *snapshot = rcu_dereference(app->snapshot);
+    if (app->info->statePushed) {
+        *canStop = snapshot->can_stop;
+    }
+    return snapshot;
+}
+
+static const char *app_state_name(DIALStatus state, double clientVersion) {
+    switch (state) {
+    case kDIALStatusHide:
+        // clients older than 2.1 do not know about hidden applications
+        return clientVersion < 2.09 ? "stopped" : "hidden";
+    case kDIALStatusRunning:
+        return "running";
+    default:
+        return "stopped";
+    }
+}
+
+/**
+ * Render the status response of an application. Its ETag is the version of
+ * the state snapshot.
+ *
+ * @param len set to the length of the response.
+ * @return the response, to be freed, or NULL if out-of-memory.
+ */
+static char *render_app_status(const DIALApp *app, const DIALAppSnapshot *snapshot,
+                               int canStop, double clientVersion,
+                               const char *origin_header, size_t *len) {
+    char *response = NULL;
+    FILE *out = open_memstream(&response, len);
+    if (out == NULL) {
+        return NULL;
+    }
+    fprintf(out,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/xml\r\n"
+            ALLOW_ORIGIN_FMT
+            "ETag: \"%lu\"\r\n"
+            "\r\n"
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+            "<service xmlns=\"urn:dial-multiscreen-org:schemas:dial\" dialVer=%s>\r\n"
+            "  <name>%s</name>\r\n"
+            "  <options allowStop=\"%s\"/>\r\n"
+            "  <state>%s</state>\r\n"
+            "%s"
+            "  <additionalData>\n",
+            ALLOW_ORIGIN_ARGS(origin_header),
+            snapshot->version,
+            DIAL_VERSION,
+            app->info->name,
+            canStop ? "true" : "false",
+            app_state_name(snapshot->state, clientVersion),
+            snapshot->state == kDIALStatusStopped ?
+                    "" : "  <link rel=\"run\" href=\"run\"/>\r\n");
+    if (snapshot->additional_data != NULL) {
+        fwrite(snapshot->additional_data->data, 1, snapshot->additional_data->len, out);
+    }
+    fputs("\n  </additionalData>\n"
+          "</service>\r\n", out);
+    if (fclose(out) != 0) {
+        free(response);
+        return NULL;
+    }
+    return response;
+}
+
+/*
+ * A client watching the state of an application, see handle_app_status().
+ * The strings are stored in the same allocation.
+ */
+typedef struct {
+    DIALServer *ds;
+    unsigned long version;      // version of the state the client has
+    double clientVersion;
+    int eventStream;            // text/event-stream rather than long-poll
+    const char *origin_header;
+    char app_name[];
+} DIALAppWatch;
+
+/**
+ * Answer a watching client once the state version differs from the one it
+ * has, or when the watch times out. An event stream gets an event per
+ * version until then.
+ */
+static int send_app_watch(int sock, void *data, int timed_out) {
+    DIALAppWatch *watch = (DIALAppWatch *) data;
+    char *response = NULL;
+    int len = -1;
+    int keep = 0;
+
+    rcu_read_lock();
+    DIALApp *app = find_app(watch->ds, watch->app_name);
+    if (app == NULL) {
+        if (!watch->eventStream) {
+            len = asprintf(&response, "HTTP/1.1 404 Not Found\r\n\r\n");
+        }
+    } else if (rcu_dereference(app->snapshot)->version == watch->version) {
+        if (timed_out && !watch->eventStream) {
+            len = asprintf(&response, "HTTP/1.1 304 Not Modified\r\n"
+                           ALLOW_ORIGIN_FMT
+                           "ETag: \"%lu\"\r\n"
+                           "\r\n",
+                           ALLOW_ORIGIN_ARGS(watch->origin_header), watch->version);
+        }
+        keep = 1;
     } else {
-        body_size = mg_read(conn, body, sizeof(body) - 1);
-        if (body_size > DIAL_MAX_PAYLOAD) {
-            mg_send_http_error(conn, 413, "413 Request Entity Too Large",
-                               "413 Request Entity Too Large");
-        } else if (isBadPayload(body, body_size)) {
-            mg_send_http_error(conn, 400, "400 Bad Request", "400 Bad Request");
+        int canStop = 0;
+        const DIALAppSnapshot *snapshot = read_app_state(watch->ds, app, &canStop);
+        watch->version = snapshot->version;
+        if (watch->eventStream) {
+            len = asprintf(&response, "id: %lu\n"
+                           "event: state\n"
+                           "data: %s\n"
+                           "\n",
+                           snapshot->version,
+                           app_state_name(snapshot->state, watch->clientVersion));
+            keep = 1;
         } else {
-            char laddr[INET6_ADDRSTRLEN];
-            const struct sockaddr_in *addr =
-                    (struct sockaddr_in *) &request_info->local_addr;
-            inet_ntop(addr->sin_family, &addr->sin_addr, laddr, sizeof(laddr));
-            in_port_t dial_port = DIAL_get_port(ds);
+            size_t size;
+            response = render_app_status(app, snapshot, canStop, watch->clientVersion,
+                                         watch->origin_header, &size);
+            len = response != NULL ? (int) size : -1;
+        }
+    }
+    rcu_read_unlock();
+    if (len >= 0) {
+        keep = http_watch_send(sock, response, len) && keep;
+        free(response);
+    }
+    return keep;
+}
 
-            if (app->useAdditionalData) {
-                // Construct additionalDataUrl=http://host:port/apps/app_name/dial_data
-                snprintf(additional_data_param, DIAL_MAX_ADDITIONALURL,
-                        "additionalDataUrl=http%%3A%%2F%%2Flocalhost%%3A%d%%2Fapps%%2F%s%%2Fdial_data%%3F",
-                        dial_port, app_name);
-            }
-            fprintf(stderr, "Starting the app with params %s\n", body);
-            app->state = app->callbacks.start_cb(ds, app_name, body,
-                                                 request_info->query_string,
-                                                 additional_data_param, 
-                                                 &app->run_id,
-                                                 app->callback_data);
-            if (app->state == kDIALStatusRunning) {
-                mg_printf(
-                        conn,
-                        "HTTP/1.1 201 Created\r\n"
-                        "Content-Type: text/plain\r\n"
-                        "Location: http://%s:%d/apps/%s/run\r\n"
-                        "Access-Control-Allow-Origin: %s\r\n"
-                        "\r\n",
-                        laddr, dial_port, app_name, origin_header);
-                // copy the payload into the application struct
-                memset(app->payload, 0, DIAL_MAX_PAYLOAD);
-                memcpy(app->payload, body, body_size);
-            } else if (app->state == kDIALStatusErrorForbidden) {
-                mg_send_http_error(conn, 403, "Forbidden", "Forbidden");
-            } else if (app->state == kDIALStatusErrorUnauth) {
-                mg_send_http_error(conn, 401, "Unauthorized", "Unauthorized");
-            } else if (app->state == kDIALStatusErrorNotImplemented) {
-                mg_send_http_error(conn, 501, "Not Implemented", "Not Implemented");
-            } else {
-                mg_send_http_error(conn, 503, "Service Unavailable",
-                                   "Service Unavailable");
-            }
+/**
+ * Park a status request until the state of the application changes.
+ *
+ * @return 1 if the connection is parked, 0 if it should be answered right
+ *         away.
+ */
+static int watch_app_status(struct mg_connection *conn, DIALServer *ds,
+                            const DIALApp *app, unsigned long version,
+                            double clientVersion, const char *origin_header,
+                            int eventStream) {
+    size_t name_size = strlen(app->info->name) + 1;
+    size_t origin_size = origin_header != NULL ? strlen(origin_header) + 1 : 0;
+    DIALAppWatch *watch = (DIALAppWatch *) malloc(sizeof(DIALAppWatch) + name_size
+                                                  + origin_size);
+    if (watch == NULL) {
+        return 0;
+    }
+    watch->ds = ds;
+    watch->version = version;
+    watch->clientVersion = clientVersion;
+    watch->eventStream = eventStream;
+    memcpy(watch->app_name, app->info->name, name_size);
+    watch->origin_header = origin_header != NULL ?
+            strcpy(watch->app_name + name_size, origin_header) : NULL;
+
+    int sock = mg_detach(conn);
+    if (eventStream) {
+        char headers[512];
+        int len = snprintf(headers, sizeof(headers), "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: text/event-stream\r\n"
+                           "Cache-Control: no-cache\r\n"
+                           ALLOW_ORIGIN_FMT
+                           "\r\n",
+                           ALLOW_ORIGIN_ARGS(origin_header));
+        if (len >= (int) sizeof(headers) || send(sock, headers, len, MSG_NOSIGNAL) != len) {
+            free(watch);
+            close(sock);
+            return 1;
         }
     }
-    ds_unlock(ds);
+    if (!http_watch_add(sock, DIAL_WATCH_TIMEOUT_MS, send_app_watch, watch)) {
+        free(watch);
+        close(sock);
+    }
+    return 1;
 }
 
 static void handle_app_status(struct mg_connection *conn,
@@ -243,111 +1037,43 @@ static void handle_app_status(struct mg_connection *conn,
         clientVersion = atof(clientVersionStr);
         free(clientVersionStr);
     }
-    
-    if (!ds_lock(ds)) {
-        mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
-        return;
-    }
-    app = *find_app(ds, app_name);
+    // ?watch=<ETag> waits for the state to change, a non-standard extension
+    char *watchStr = parse_param(request_info->query_string, "watch");
+    const char *accept = mg_get_header(conn, "Accept");
+    int eventStream = accept != NULL && strstr(accept, "text/event-stream") != NULL;
+
+    rcu_read_lock();
+    app = lookup_app(ds, app_name);
     if (!app) {
-        mg_send_http_error(conn, 404, "Not Found", "Not Found");
-        ds_unlock(ds);
+        send_error(conn, 404);
+        rcu_read_unlock();
+        free(watchStr);
         return;
     }
 
-    char dial_data[DIAL_DATA_SIZE] = {0,};
-    char *end = dial_data + DIAL_DATA_SIZE;
-    char *p = dial_data;
-
-    for (DIALData* first = app->dial_data; first != NULL; first = first->next) {
-        p = smartstrncpy(p, "    <", end - p);
-        size_t key_length = strlen(first->key);
-        char *encoded_key = (char *) malloc(2 * key_length + 1);
-        if (encoded_key == NULL) {
-            mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
-            ds_unlock(ds);
+    const DIALAppSnapshot *snapshot = read_app_state(ds, app, &canStop);
+    if (watchStr != NULL) {
+        // The ETag may be sent quoted.
+        unsigned long version = strtoul(watchStr + strcspn(watchStr, "0123456789"), NULL, 10);
+        free(watchStr);
+        if ((eventStream || version == snapshot->version) &&
+                watch_app_status(conn, ds, app, version, clientVersion, origin_header,
+                                 eventStream)) {
+            rcu_read_unlock();
             return;
         }
-        if (!url_decode_xml_encode(encoded_key, first->key, key_length)) {
-            mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
-            free(encoded_key); encoded_key = NULL;
-            ds_unlock(ds);
-            return;
-        };
-
-        size_t value_length = strlen(first->value);
-        char *encoded_value = (char *) malloc(2 * value_length + 1);
-        if (encoded_value == NULL) {
-            mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
-            free(encoded_key); encoded_key = NULL;
-            ds_unlock(ds);
-            return;
-        }
-        if (!url_decode_xml_encode(encoded_value, first->value, value_length)) {
-            mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
-            free(encoded_value); encoded_value = NULL;
-            free(encoded_key); encoded_key = NULL;
-            ds_unlock(ds);
-            return;
-        }
-
-        p = smartstrncpy(p, encoded_key, end - p);
-        p = smartstrncpy(p, ">", end - p);
-        p = smartstrncpy(p, encoded_value, end - p);
-        p = smartstrncpy(p, "</", end - p);
-        p = smartstrncpy(p, encoded_key, end - p);
-        p = smartstrncpy(p, ">", end - p);
-        free(encoded_key); encoded_key = NULL;
-        free(encoded_value); encoded_value = NULL;
     }
 
-    app->state = app->callbacks.status_cb(ds, app_name, app->run_id, &canStop,
-                                          app->callback_data);
-
-    DIALStatus localState = app->state;
-    
-    // overwrite app->state if cilent version < 2.1    
-    if (clientVersion < 2.09 && localState==kDIALStatusHide){
-        localState=kDIALStatusStopped;
-    }
-    
-    char dial_state_str[20];
-    switch(localState){
-    case kDIALStatusHide:
-        strcpy (dial_state_str, "hidden");
-        break;
-    case kDIALStatusRunning:
-        strcpy (dial_state_str, "running");
-        break;
-    default:
-        strcpy (dial_state_str, "stopped");
+    size_t len;
+    char *response = render_app_status(app, snapshot, canStop, clientVersion,
+                                       origin_header, &len);
+    if (response == NULL) {
+        send_error(conn, 500);
+    } else {
+        mg_write(conn, response, len);
+        free(response);
     }
-    
-    mg_printf(
-            conn,
-            "HTTP/1.1 200 OK\r\n"
-            "Content-Type: text/xml\r\n"
-            "Access-Control-Allow-Origin: %s\r\n"
-            "\r\n"
-            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
-            "<service xmlns=\"urn:dial-multiscreen-org:schemas:dial\" dialVer=%s>\r\n"
-            "  <name>%s</name>\r\n"
-            "  <options allowStop=\"%s\"/>\r\n"
-            "  <state>%s</state>\r\n"
-            "%s"
-            "  <additionalData>\n"
-            "%s"
-            "\n  </additionalData>\n"
-            "</service>\r\n",
-            origin_header,            
-            DIAL_VERSION,
-            app->name,
-            canStop ? "true" : "false",
-            dial_state_str,
-            localState == kDIALStatusStopped ?
-                    "" : "  <link rel=\"run\" href=\"run\"/>\r\n",
-            dial_data);
-    ds_unlock(ds);
+    rcu_read_unlock();
 }
 
 static void handle_app_stop(struct mg_connection *conn,
@@ -358,36 +1084,37 @@ static void handle_app_stop(struct mg_connection *conn,
     DIALServer *ds = request_info->user_data;
     int canStop = 0;
 
-    if (!ds_lock(ds)) {
-        mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
-        return;
-    }
-
     // Special handling for system app
     if (strcmp(app_name, "system") == 0) {
-        mg_send_http_error(conn, 403, "Forbidden", "Forbidden");  // Can't stop system app.
-    } else {
-        app = *find_app(ds, app_name);
+        send_error(conn, 403);  // Can't stop system app.
+        return;
+    }
 
-        // update the application state
-        if (app) {
-            app->state = app->callbacks.status_cb(ds, app_name, app->run_id,
-                                                  &canStop, app->callback_data);
-        }
+    rcu_read_lock();
+    app = lookup_app(ds, app_name);
+    if (!app) {
+        send_error(conn, 404);
+        rcu_read_unlock();
+        return;
+    }
+    if (!lock_registered_app(app)) {
+        send_error(conn, 404);
+        rcu_read_unlock();
+        return;
+    }
 
-        if (!app || app->state == kDIALStatusStopped) {
-            mg_send_http_error(conn, 404, "Not Found", "Not Found");
-        } else {
-            app->callbacks.stop_cb(ds, app_name, app->run_id, app->callback_data);
-            app->state = kDIALStatusStopped;
-            mg_printf(conn, "HTTP/1.1 200 OK\r\n"
-                      "Content-Type: text/plain\r\n"
-                      "Access-Control-Allow-Origin: %s\r\n"
-                      "\r\n",
-                      origin_header);
-        }
+    // update the application state
+    if (refresh_app_state(ds, app, &canStop) == kDIALStatusStopped) {
+        send_error(conn, 404);
+    } else {
+        // The application may take a while to exit, it is only reported
+        // stopped once its status callback says so or its run exited.
+        app->info->callbacks.stop_cb(ds, app_name, app->snapshot->run_id, app->info->callback_data);
+        refresh_app_state(ds, app, &canStop);
+        send_response(conn, gOkTextHead, sizeof(gOkTextHead) - 1, origin_header);
     }
-    ds_unlock(ds);
+    pthread_mutex_unlock(&app->lock);
+    rcu_read_unlock();
 }
 
 static void handle_app_hide(struct mg_connection *conn,
@@ -398,37 +1125,37 @@ static void handle_app_hide(struct mg_connection *conn,
     DIALServer *ds = request_info->user_data;
     int canStop = 0;
 
-    if (!ds_lock(ds)) {
-        mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
+    rcu_read_lock();
+    app = lookup_app(ds, app_name);
+    if (!app) {
+        send_error(conn, 404);
+        rcu_read_unlock();
         return;
     }
-    app = *find_app(ds, app_name);
-  
-    // update the application state
-    if (app) {
-        app->state = app->callbacks.status_cb(ds, app_name, app->run_id,
-                                              &canStop, app->callback_data);
+    if (!lock_registered_app(app)) {
+        send_error(conn, 404);
+        rcu_read_unlock();
+        return;
     }
-    
-    if (!app || (app->state != kDIALStatusRunning && app->state != kDIALStatusHide)) {
-        mg_send_http_error(conn, 404, "Not Found", "Not Found");
+
+    // update the application state
+    DIALStatus state = refresh_app_state(ds, app, &canStop);
+    if (state != kDIALStatusRunning && state != kDIALStatusHide) {
+        send_error(conn, 404);
     } else {
         // not implemented in reference
-        DIALStatus status = app->callbacks.hide_cb(ds, app_name, app->run_id, app->callback_data);
+        DIAL_run_t run_id = app->snapshot->run_id;
+        DIALStatus status = app->info->callbacks.hide_cb(ds, app_name, &run_id, app->info->callback_data);
         if (status != kDIALStatusHide){
             fprintf(stderr, "Hide not implemented for reference.\n");
-            mg_send_http_error(conn, 501, "Not Implemented",
-                               "Not Implemented");
+            send_error(conn, 501);
         } else {
-            app->state = kDIALStatusHide;
-            mg_printf(conn, "HTTP/1.1 200 OK\r\n"
-                      "Content-Type: text/plain\r\n"
-                      "Access-Control-Allow-Origin: %s\r\n"
-                      "\r\n",
-                      origin_header);
+            set_app_state(app, kDIALStatusHide, run_id);
+            send_response(conn, gOkTextHead, sizeof(gOkTextHead) - 1, origin_header);
         }
     }
-    ds_unlock(ds);
+    pthread_mutex_unlock(&app->lock);
+    rcu_read_unlock();
 }
 
 static void handle_dial_data(struct mg_connection *conn,
@@ -441,14 +1168,11 @@ static void handle_dial_data(struct mg_connection *conn,
     DIALApp *app;
     DIALServer *ds = request_info->user_data;
 
-    if (!ds_lock(ds)) {
-        mg_send_http_error(conn, 500, "500 Internal Server Error", "500 Internal Server Error");
-        return;
-    }
-    app = *find_app(ds, app_name);
+    rcu_read_lock();
+    app = lookup_app(ds, app_name);
     if (!app) {
-        mg_send_http_error(conn, 404, "Not Found", "Not Found");
-        ds_unlock(ds);
+        send_error(conn, 404);
+        rcu_read_unlock();
         return;
     }
     int nread;
@@ -456,9 +1180,8 @@ static void handle_dial_data(struct mg_connection *conn,
         if (request_info->query_string) {
             int qs_len = strlen(request_info->query_string);
             if (qs_len > DIAL_DATA_MAX_PAYLOAD) {
-                mg_send_http_error(conn, 413, "413 Request Entity Too Large",
-                                   "413 Request Entity Too Large");
-                ds_unlock(ds);
+                send_error(conn, 413);
+                rcu_read_unlock();
                 return;
             }
             strncpy(body, request_info->query_string, DIAL_DATA_MAX_PAYLOAD);
@@ -466,29 +1189,39 @@ static void handle_dial_data(struct mg_connection *conn,
         } else {
           nread = 0;
         }
+    } else if (content_too_large(conn, DIAL_DATA_MAX_PAYLOAD)) {
+        send_error(conn, 413);
+        rcu_read_unlock();
+        return;
     } else {
         nread = mg_read(conn, body, DIAL_DATA_MAX_PAYLOAD);
     }
     body[nread] = '\0';
 
     if (isBadPayload(body, nread)) {
-        mg_send_http_error(conn, 400, "400 Bad Request", "400 Bad Request");
-        ds_unlock(ds);
+        send_error(conn, 400);
+        rcu_read_unlock();
         return;
     }
 
 
-    free_dial_data(&app->dial_data);
-
-    app->dial_data = parse_params(body);
-    store_dial_data(app->name, app->dial_data);
-
-    mg_printf(conn, "HTTP/1.1 200 OK\r\n"
-              "Access-Control-Allow-Origin: %s\r\n"
-              "\r\n",
-              origin_header);
-
-    ds_unlock(ds);
+    if (!lock_registered_app(app)) {
+        send_error(conn, 404);
+        rcu_read_unlock();
+        return;
+    }
+    DIALData *data = parse_params(body);
+    int result = replace_app_data(app, data);
+    free_dial_data(&data);
+    if (result == 0) {
+        send_error(conn, 413);
+    } else if (result < 0) {
+        send_error(conn, 500);
+    } else {
+        send_response(conn, gOkHead, sizeof(gOkHead) - 1, origin_header);
+    }
+    pthread_mutex_unlock(&app->lock);
+    rcu_read_unlock();
 }
 
 /**
@@ -633,51 +1366,58 @@ static int origin_matches(const char *origin, const char *candidate) {
         strncmp(origin, candidate, origin_len) == 0);
 }
 
-// str contains a white space separated list of strings (only supports SPACE characters for now)
-static int is_uri_in_list(const char *origin, const char *list) {
+/**
+ * Count the origins in a space-separated list of allowed origins.
+ */
+static size_t count_origins(const char *list) {
+    size_t count = 0;
+    for (const char *p = list + strspn(list, " "); *p; p += strspn(p, " ")) {
+        p += strcspn(p, " ");
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Split a space-separated list of allowed origins, once at registration.
+ *
+ * @param list the allowed origins.
+ * @param origins receives the count_origins(list) origins and a terminating
+ *        NULL, followed by strlen(list) + 1 bytes for the strings they point
+ *        to.
+ */
+static void split_origins(const char *list, char **origins) {
+    size_t count = count_origins(list);
+    char *strings = (char *) (origins + count + 1);
+    strcpy(strings, list);
+    for (char *p = strings + strspn(strings, " "); *p; p += strspn(p, " ")) {
+        *origins++ = p;
+        p += strcspn(p, " ");
+        if (*p) {
+            *p++ = '\0';
+        }
+    }
+    *origins = NULL;
+}
+
+static int is_uri_in_list(const char *origin, char * const *list) {
     // Make sure there is something to compare.
     if (!origin || !list)
         return 0;
 
     int isHttps = (strncmp(origin, gHttpsProto, strlen(gHttpsProto)) == 0);
-    
-    const char * scanPointer = list;
-    const char * spacePointer;
-    unsigned int substringSize = 257;
-    char *candidate = (char *)malloc(substringSize);
-    if (!candidate) {
-        return 0;
-    }
-    while ((spacePointer = strchr(scanPointer, ' ')) != NULL) {
-        int copyLength = spacePointer - scanPointer;      
-      
-        // protect against buffer overflow
-        if (copyLength >= substringSize) {
-            substringSize = copyLength + 1;
-            free(candidate);
-            candidate = (char *)malloc(substringSize);
-            if (!candidate) {
-                return 0;
-            }
-        }
 
-        memcpy(candidate, scanPointer, copyLength);
-        candidate[copyLength] = '\0';
-        //printf("found %s \n", candidate);
-        // If the URI begins with https://, perform a host comparison because
-        // any port numbers must be handled specially. Otherwise perform a
-        // regular match.
-        if ((isHttps && host_matches(origin, candidate)) ||
-            (!isHttps && origin_matches(origin, candidate)))
+    // If the URI begins with https://, perform a host comparison because
+    // any port numbers must be handled specially. Otherwise perform a
+    // regular match.
+    for (; *list != NULL; list++) {
+        if ((isHttps && host_matches(origin, *list)) ||
+            (!isHttps && origin_matches(origin, *list)))
         {
-            free(candidate); candidate = NULL;
             return 1;
         }
-        scanPointer = scanPointer + copyLength + 1; // assumption: only 1 character
     }
-    free(candidate); candidate = NULL;
-    return ((isHttps && host_matches(origin, scanPointer)) ||
-            (!isHttps && origin_matches(origin, scanPointer)));
+    return 0;
 }
 
 static int is_allowed_origin(DIALServer* ds, char * origin, const char * app_name) {
@@ -686,43 +1426,171 @@ static int is_allowed_origin(DIALServer* ds, char * origin, const char * app_nam
     if (!origin || strlen(origin)==0) {
         return 1;
     }
-    
-    if (!ds_lock(ds)) {
-        // If we can't check, fail in favor of safety.
-        return 0;
+
+    rcu_read_lock();
+    DIALApp *app = lookup_app(ds, app_name);
+    int result = app != NULL &&
+        (!app->info->cors_origins || is_uri_in_list(origin, app->info->cors_origins));
+    rcu_read_unlock();
+
+    return result;
+}
+
+/**
+ * Render the service element of an application in the status document of
+ * several applications.
+ *
+ * Must be called from a read-side critical section.
+ */
+static void render_service(FILE *out, DIALServer *ds, DIALApp *app, double clientVersion) {
+    int canStop = 0;
+    const DIALAppSnapshot *snapshot = read_app_state(ds, app, &canStop);
+    fprintf(out,
+            "  <service>\r\n"
+            "    <name>%s</name>\r\n"
+            "    <options allowStop=\"%s\"/>\r\n"
+            "    <state>%s</state>\r\n"
+            "    <additionalData>\n",
+            app->info->name,
+            canStop ? "true" : "false",
+            app_state_name(snapshot->state, clientVersion));
+    // The additionalData elements are rendered when the data is updated.
+    if (snapshot->additional_data != NULL) {
+        fwrite(snapshot->additional_data->data, 1, snapshot->additional_data->len, out);
     }
-    DIALApp *app;
-    int result = 0;
-    for (app = ds->apps; app != NULL; app = app->next) {
-        if (!strcmp(app->name, app_name)) {
-            if (!app->corsAllowedOrigin[0] ||
-                is_uri_in_list(origin, app->corsAllowedOrigin)) {
-                result = 1;
-                break;
+    fputs("\n    </additionalData>\n"
+          "  </service>\r\n", out);
+}
+
+/**
+ * Answer GET /apps?names=<name>,<name>... with the status of the named
+ * applications, or of all the registered applications without names, a
+ * non-standard extension. Applications that are not found or do not allow the
+ * origin are left out.
+ */
+static void handle_apps_status(struct mg_connection *conn,
+                               const struct mg_request_info *request_info,
+                               char *origin_header) {
+    DIALServer *ds = request_info->user_data;
+    char *body = NULL;
+    size_t body_len = 0;
+
+    char *clientVersionStr = parse_param(request_info->query_string, "clientDialVer");
+    double clientVersion = 0.0;
+    if (clientVersionStr){
+        clientVersion = atof(clientVersionStr);
+        free(clientVersionStr);
+    }
+    char *names = parse_param(request_info->query_string, "names");
+    FILE *out = open_memstream(&body, &body_len);
+    if (out == NULL) {
+        free(names);
+        send_error(conn, 500);
+        return;
+    }
+    fprintf(out,
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+            "<services xmlns=\"urn:dial-multiscreen-org:schemas:dial\" dialVer=%s>\r\n",
+            DIAL_VERSION);
+
+    rcu_read_lock();
+    if (names != NULL) {
+        char *save = NULL;
+        for (char *name = strtok_r(names, ",", &save); name != NULL;
+                name = strtok_r(NULL, ",", &save)) {
+            char app_name[256];
+            if (urldecode(app_name, name, sizeof(app_name) - 1) == 0) {
+                continue;
+            }
+            DIALApp *app = lookup_app(ds, app_name);
+            if (app != NULL && (origin_header == NULL || app->info->cors_origins == NULL ||
+                                is_uri_in_list(origin_header, app->info->cors_origins))) {
+                render_service(out, ds, app, clientVersion);
+            }
+        }
+    } else {
+        const DIALAppTable *table = rcu_dereference(ds->apps);
+        for (size_t i = 0; table != NULL && i < table->count; i++) {
+            DIALApp *app = table->entries[i].app;
+            if (origin_header == NULL || app->info->cors_origins == NULL ||
+                    is_uri_in_list(origin_header, app->info->cors_origins)) {
+                render_service(out, ds, app, clientVersion);
             }
         }
     }
-    ds_unlock(ds);
+    rcu_read_unlock();
+    free(names);
 
-    return result;
+    fputs("</services>\r\n", out);
+    if (fclose(out) != 0) {
+        free(body);
+        send_error(conn, 500);
+        return;
+    }
+    static const char head[] = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: text/xml\r\n";
+    send_response(conn, head, sizeof(head) - 1, origin_header);
+    mg_write(conn, body, body_len);
+    free(body);
 }
 
 #define APPS_URI "/apps/"
 #define RUN_URI "/run"
 #define HIDE_URI "/hide"
 
-static void *options_response(DIALServer *ds, struct mg_connection *conn, char *origin_header, const char* app_name, const char* methods)
-{    
-    mg_printf(
-              conn,
-              "HTTP/1.1 204 No Content\r\n"
-              "Access-Control-Allow-Methods: %s\r\n"
-              "Access-Control-Max-Age: 86400\r\n"
-              "Access-Control-Allow-Origin: %s\r\n"
-              "Content-Length: 0"
-              "\r\n",
-              methods,
-              origin_header);
+static int is_dial_data_uri(const char *uri) {
+    size_t uri_len = strlen(uri), data_uri_len = strlen(DIAL_DATA_URI);
+    return uri_len >= data_uri_len && !strcmp(uri + uri_len - data_uri_len, DIAL_DATA_URI);
+}
+
+/**
+ * Sort requests into lanes: launch, stop, hide and their preflights ahead of
+ * status polling, and DIAL data reported by the applications last, so
+ * polling phones cannot hold back a launch.
+ */
+static int classify_request(const char *method, const char *uri) {
+    if (strncmp(uri, "/apps", strlen("/apps")) != 0 || is_dial_data_uri(uri)) {
+        return MG_LANE_INTERNAL;
+    }
+    return !strcmp(method, "GET") ? MG_LANE_QUERY : MG_LANE_CONTROL;
+}
+
+/**
+ * Take a token from the client's bucket for the request, or answer it with
+ * 429 Too Many Requests.
+ *
+ * @return 1 if the request may proceed, 0 if it was answered.
+ */
+static int check_rate_limit(DIALServer *ds, struct mg_connection *conn,
+                            const struct mg_request_info *request_info) {
+    const char *method = request_info->request_method, *uri = request_info->uri;
+    unsigned int request_class, retry_after_ms;
+
+    if (ds->rate_limiter == NULL || strncmp(uri, "/apps", strlen("/apps")) != 0) {
+        return 1;
+    } else if (is_dial_data_uri(uri)) {
+        request_class = kDIALRateData;
+    } else if (!strcmp(method, "GET")) {
+        request_class = kDIALRateStatus;
+    } else if (!strcmp(method, "POST") || !strcmp(method, "DELETE")) {
+        request_class = kDIALRateLaunch;
+    } else {
+        return 1;
+    }
+    if (rate_limiter_take(ds->rate_limiter, request_info->remote_addr.sin_addr.s_addr,
+                          request_class, &retry_after_ms)) {
+        return 1;
+    }
+    char retry_after[32];
+    snprintf(retry_after, sizeof(retry_after), "Retry-After: %u\r\n",
+             (retry_after_ms + 999) / 1000);
+    send_error_with_header(conn, 429, retry_after);
+    return 0;
+}
+
+static void *options_response(struct mg_connection *conn, const char *origin_header,
+                              const char *head, size_t head_len) {
+    send_response(conn, head, head_len, origin_header);
     return "done";
 }
 
@@ -743,7 +1611,9 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
         }
     }
     fprintf(stderr, "Origin %s, Host: %s\n", origin_header, host_header);
-    if (event == MG_NEW_REQUEST) {
+    if (event == MG_NEW_REQUEST && !check_rate_limit(ds, conn, request_info)) {
+        return "done";
+    } else if (event == MG_NEW_REQUEST) {
         // URL ends with run
         if (strlen(request_info->uri) > strlen(RUN_URI) + strlen(APPS_URI)
             && !strncmp(request_info->uri + strlen(request_info->uri) - strlen(RUN_URI), RUN_URI, strlen(RUN_URI)))
@@ -758,13 +1628,13 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
 
             // Check authorized origins.
             if (origin_header && !is_allowed_origin(ds, origin_header, app_name)) {
-                mg_send_http_error(conn, 403, "Forbidden", "Forbidden");
+                send_error(conn, 403);
                 return "done";
             }
 
             // Return OPTIONS.
             if (!strcmp(request_info->request_method, "OPTIONS")) {
-                return options_response(ds, conn, origin_header, app_name, "DELETE, OPTIONS");
+                return options_response(conn, origin_header, gPreflightRun, sizeof(gPreflightRun) - 1);
             }
 
             // DELETE non-empty app name
@@ -773,8 +1643,7 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
             {
                 handle_app_stop(conn, request_info, app_name, origin_header);
             } else {
-                mg_send_http_error(conn, 501, "Not Implemented",
-                                   "Not Implemented");
+                send_error(conn, 501);
             }
         }
         // URI starts with "/apps/" and is followed by an app name
@@ -787,13 +1656,13 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
 
             // Check authorized origins.
             if (origin_header && !is_allowed_origin(ds, origin_header, app_name)) {
-                mg_send_http_error(conn, 403, "Forbidden", "Forbidden");
+                send_error(conn, 403);
                 return "done";
             }
 
             // Return OPTIONS.
             if (!strcmp(request_info->request_method, "OPTIONS")) {
-                return options_response(ds, conn, origin_header, app_name, "GET, POST, OPTIONS");
+                return options_response(conn, origin_header, gPreflightApp, sizeof(gPreflightApp) - 1);
             }
 
             // start app
@@ -803,7 +1672,7 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
             } else if (!strcmp(request_info->request_method, "GET")) {
                 handle_app_status(conn, request_info, app_name, origin_header);
             } else {
-                mg_send_http_error(conn, 501, "Not Implemented", "Not Implemented");
+                send_error(conn, 501);
             }
         }
         // URI that ends with HIDE_URI
@@ -820,20 +1689,20 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
 
             // Check authorized origins.
             if (origin_header && !is_allowed_origin(ds, origin_header, app_name)) {
-                mg_send_http_error(conn, 403, "Forbidden", "Forbidden");
+                send_error(conn, 403);
                 return "done";
             }
 
             // Return OPTIONS.
             if (!strcmp(request_info->request_method, "OPTIONS")) {
-                return options_response(ds, conn, origin_header, app_name, "POST, OPTIONS");
+                return options_response(conn, origin_header, gPreflightPost, sizeof(gPreflightPost) - 1);
             }
 
             // hide app
             if (app_name[0] != '\0' && !strcmp(request_info->request_method, "POST")) {
                 handle_app_hide(conn, request_info, app_name, origin_header);
             } else {
-                mg_send_http_error(conn, 501, "Not Implemented", "Not Implemented");
+                send_error(conn, 501);
             }
         }
         // URI is of the form */app_name/dial_data
@@ -845,17 +1714,17 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
             if ( !strncmp(laddr, gLocalhost, strlen(gLocalhost)) ) {
                 char *app_name = parse_app_name(request_info->uri);
                 if (app_name == NULL) {
-                    mg_send_http_error(conn, 500, "Internal Error", "Internal Error");
+                    send_error(conn, 500);
                 } else {
                     // Check authorized origins (still applicable via loopback).
                     if (origin_header && !is_allowed_origin(ds, origin_header, app_name)) {
-                        mg_send_http_error(conn, 403, "Forbidden", "Forbidden");
+                        send_error(conn, 403);
                         return "done";
                     }
 
                     // Return OPTIONS.
                     if (!strcmp(request_info->request_method, "OPTIONS")) {
-                        void *ret = options_response(ds, conn, origin_header, app_name, "POST, OPTIONS");
+                        void *ret = options_response(conn, origin_header, gPreflightPost, sizeof(gPreflightPost) - 1);
                         free(app_name);
                         return ret;
                     }
@@ -869,10 +1738,21 @@ static void *request_handler(enum mg_event event, struct mg_connection *conn,
                 }
             } else {
                 // If the request is not from local host, return an error
-                mg_send_http_error(conn, 403, "Forbidden", "Forbidden");
+                send_error(conn, 403);
+            }
+        }
+        // URI is /apps, the status of several applications
+        else if (!strcmp(request_info->uri, APPS_URI) || !strcmp(request_info->uri, "/apps")) {
+            if (!strcmp(request_info->request_method, "OPTIONS")) {
+                return options_response(conn, origin_header, gPreflightApps, sizeof(gPreflightApps) - 1);
+            }
+            if (!strcmp(request_info->request_method, "GET")) {
+                handle_apps_status(conn, request_info, origin_header);
+            } else {
+                send_error(conn, 501);
             }
         } else {
-            mg_send_http_error(conn, 404, "Not Found", "Not Found");
+            send_error(conn, 404);
         }
         return "done";
     } else if (event == MG_EVENT_LOG) {
@@ -891,20 +1771,126 @@ DIALServer *DIAL_create() {
         free(ds); ds = NULL;
         return NULL;
     }
+    if (pthread_mutex_init(&ds->miss_mux, NULL) != 0) {
+        pthread_mutex_destroy(&ds->mux);
+        free(ds); ds = NULL;
+        return NULL;
+    }
+    ds->data_write_window_ms = DIAL_DATA_WRITE_WINDOW_MS;
+    ds->port = DIAL_PORT;
+    pthread_once(&gErrorResponsesOnce, build_error_responses);
     return ds;
 }
 
+void DIAL_set_port(DIALServer *ds, in_port_t port) {
+    ds->port = port;
+}
+
+int DIAL_set_rate_limit(DIALServer *ds, DIALRateClass request_class,
+                        unsigned int per_second, unsigned int burst) {
+    // A bucket that holds no token would refuse every request.
+    if (request_class >= kDIALRateNumClasses || (per_second > 0 && burst == 0)) {
+        return 0;
+    }
+    ds->rate_limits[request_class] = (RateLimit) { per_second, burst };
+    return 1;
+}
+
+void DIAL_set_launch_debounce(DIALServer *ds, unsigned int window_ms) {
+    ds->launch_debounce_ms = window_ms;
+}
+
+void DIAL_set_data_write_window(DIALServer *ds, unsigned int window_ms) {
+    ds->data_write_window_ms = window_ms;
+}
+
+static void clear_missing_apps(DIALServer *ds);
+
 int DIAL_start(DIALServer *ds) {
-    ds->ctx = mg_start(&request_handler, ds, DIAL_PORT);
+    // Without the writer DIAL data is simply written synchronously.
+    if (!start_dial_data_writer(ds->data_write_window_ms, DIAL_DATA_WRITE_MAX_PENDING)) {
+        printf("Unable to start the DIAL data writer.\n");
+    }
+    // Without the watch thread status requests are answered right away.
+    if (!start_http_watch()) {
+        printf("Unable to start the watch thread.\n");
+    }
+    for (int i = 0; i < kDIALRateNumClasses; i++) {
+        if (ds->rate_limits[i].per_second > 0) {
+            ds->rate_limiter = rate_limiter_create(ds->rate_limits, kDIALRateNumClasses,
+                                                   RATE_LIMIT_DEFAULT_CLIENTS);
+            if (ds->rate_limiter == NULL) {
+                printf("Unable to create the rate limiter, requests are not limited.\n");
+            }
+            break;
+        }
+    }
+    ds->ctx = mg_start(&request_handler, ds, ds->port);
+    if (ds->ctx == NULL) {
+        rate_limiter_free(&ds->rate_limiter);
+        stop_http_watch();
+        stop_dial_data_writer();
+    } else {
+        mg_set_classifier(ds->ctx, classify_request);
+    }
+    ds->listen_port = DIAL_get_port(ds);
     return (ds->ctx != NULL);
 }
 
 void DIAL_stop(DIALServer *ds) {
     mg_stop(ds->ctx);
+    ds->listen_port = 0;
+    rate_limiter_free(&ds->rate_limiter);
+    stop_http_watch();
+    if (ds->state_shm != NULL && ds_lock(ds)) {
+        for (size_t i = 0; ds->apps != NULL && i < ds->apps->count; i++) {
+            DIALApp *app = ds->apps->entries[i].app;
+            pthread_mutex_lock(&app->lock);
+            unshare_app_state(app);
+            pthread_mutex_unlock(&app->lock);
+        }
+        app_state_shm_destroy(ds->state_shm, ds->state_shm_name);
+        ds->state_shm = NULL;
+        free(ds->state_shm_name);
+        ds->state_shm_name = NULL;
+        ds_unlock(ds);
+    }
+    stop_dial_data_writer();
+    clear_missing_apps(ds);
+    rcu_reclaim();
+    pthread_mutex_destroy(&ds->miss_mux);
     pthread_mutex_destroy(&ds->mux);
 }
 
+int DIAL_publish_app_states(DIALServer *ds, const char *shm_name) {
+    if (!ds_lock(ds)) {
+        return 0;
+    }
+    if (ds->state_shm == NULL) {
+        ds->state_shm_name = strdup(shm_name);
+        if (ds->state_shm_name != NULL) {
+            ds->state_shm = app_state_shm_create(shm_name);
+        }
+        if (ds->state_shm == NULL) {
+            free(ds->state_shm_name);
+            ds->state_shm_name = NULL;
+        }
+        for (size_t i = 0; ds->state_shm != NULL && ds->apps != NULL && i < ds->apps->count; i++) {
+            DIALApp *app = ds->apps->entries[i].app;
+            pthread_mutex_lock(&app->lock);
+            share_app_state(ds, app);
+            pthread_mutex_unlock(&app->lock);
+        }
+    }
+    int result = ds->state_shm != NULL;
+    ds_unlock(ds);
+    return result;
+}
+
 in_port_t DIAL_get_port(DIALServer *ds) {
+    if (ds->listen_port != 0) {
+        return ds->listen_port;
+    }
     struct sockaddr sa;
     socklen_t len = sizeof(sa);
     if (!mg_get_listen_addr(ds->ctx, &sa, &len)) {
@@ -913,82 +1899,540 @@ in_port_t DIAL_get_port(DIALServer *ds) {
     return ntohs(((struct sockaddr_in *) &sa)->sin_port);
 }
 
+static void free_table(RcuHead *head) {
+    free(head);
+}
+
+static void free_app(RcuHead *head) {
+    DIALApp *app = (DIALApp *) ((char *) head - offsetof(DIALApp, rcu));
+    if (app->snapshot != NULL) {
+        free_snapshot(&app->snapshot->rcu);
+    }
+    free(app->launch_responses);
+    DIALAppInfo *info = (DIALAppInfo *) app->info;
+    if (info != NULL) {
+        dial_data_store_free(&info->dial_data);
+        free(info);
+    }
+    pthread_mutex_destroy(&app->lock);
+    free(app);
+}
+
+/**
+ * Build the registration data of an application in a single allocation.
+ *
+ * @return the registration data or NULL if out-of-memory.
+ */
+static DIALAppInfo *create_app_info(const char *app_name,
+                                    const struct DIALAppRegistration *registration,
+                                    int provided) {
+    const char *corsAllowedOrigin = registration->corsAllowedOrigin;
+    size_t name_size = strlen(app_name) + 1;
+    size_t size = offsetof(DIALAppInfo, name) + name_size;
+
+    // An empty list allows any origin.
+    size_t origins_offset = 0;
+    if (corsAllowedOrigin != NULL && corsAllowedOrigin[0] != '\0') {
+        origins_offset = (size + sizeof(char *) - 1) & ~(sizeof(char *) - 1);
+        size = origins_offset + (count_origins(corsAllowedOrigin) + 1) * sizeof(char *)
+                + strlen(corsAllowedOrigin) + 1;
+    }
+    DIALAppInfo *info = (DIALAppInfo *) calloc(1, size);
+    if (info == NULL) {
+        return NULL;
+    }
+    info->callbacks = registration->callbacks;
+    info->callback_data = registration->callback_data;
+    info->useAdditionalData = registration->useAdditionalData;
+    info->statePushed = registration->statePushed;
+    info->provided = provided;
+    memcpy(info->name, app_name, name_size);
+    if (origins_offset != 0) {
+        info->cors_origins = (char **) ((char *) info + origins_offset);
+        split_origins(corsAllowedOrigin, info->cors_origins);
+    }
+    info->dial_data = dial_data_store_create(DIAL_DATA_STORE_DEFAULT_MAX_ENTRIES,
+                                             DIAL_DATA_STORE_DEFAULT_MAX_BYTES,
+                                             kDIALDataQuotaReject);
+    if (info->dial_data == NULL) {
+        free(info);
+        return NULL;
+    }
+    return info;
+}
+
+/**
+ * Build a registered application, loading its stored DIAL data.
+ *
+ * @return the application or NULL if out-of-memory.
+ */
+static DIALApp *create_app(const char *app_name,
+                           const struct DIALAppRegistration *registration,
+                           int provided) {
+    DIALApp *app = (DIALApp *) calloc(1, sizeof(DIALApp));
+    if (app == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&app->lock, NULL) != 0) {
+        free(app);
+        return NULL;
+    }
+    app->info = create_app_info(app_name, registration, provided);
+    app->snapshot = (DIALAppSnapshot *) calloc(1, sizeof(DIALAppSnapshot));
+    if (app->info == NULL || app->snapshot == NULL) {
+        free_app(&app->rcu);
+        return NULL;
+    }
+    app->snapshot->state = kDIALStatusStopped;
+    app->state_slot = -1;
+
+    // Previously stored data that no longer fits the quota is dropped.
+    DIALData *stored_data = retrieve_dial_data((char *) app->info->name);
+    dial_data_store_replace(app->info->dial_data, stored_data);
+    free_dial_data(&stored_data);
+    if (!render_additional_data(app->info->dial_data, &app->snapshot->additional_data)) {
+        free_app(&app->rcu);
+        return NULL;
+    }
+    return app;
+}
+
+/**
+ * Publish a new application table with an application added and/or removed,
+ * and retire the previous table and the removed application.
+ *
+ * Must be called with the DIAL server mutex held, and the lock of the
+ * application to remove.
+ *
+ * @param ds the DIAL server.
+ * @param add the application to add, or NULL.
+ * @param remove the application to remove, or NULL.
+ * @return 1 if successful, 0 if out-of-memory.
+ */
+static int publish_table(DIALServer *ds, DIALApp *add, DIALApp *remove) {
+    DIALAppTable *old = ds->apps, *table = NULL;
+    size_t count = (old != NULL ? old->count : 0) + (add != NULL) - (remove != NULL);
+
+    if (count > 0) {
+        table = (DIALAppTable *) malloc(sizeof(DIALAppTable) + count * sizeof(DIALAppEntry));
+        if (table == NULL) {
+            return 0;
+        }
+        table->count = 0;
+        for (size_t i = 0; old != NULL && i < old->count; i++) {
+            if (old->entries[i].app != remove) {
+                table->entries[table->count++] = old->entries[i];
+            }
+        }
+        if (add != NULL) {
+            table->entries[table->count].name_hash = hash_app_name(add->info->name);
+            table->entries[table->count++].app = add;
+        }
+    }
+    if (add != NULL) {
+        share_app_state(ds, add);
+    }
+    if (remove != NULL) {
+        unshare_app_state(remove);
+        remove->unregistered = 1;
+    }
+    rcu_assign_pointer(ds->apps, table);
+
+    // Requests in flight may still be using them.
+    if (old != NULL) {
+        rcu_retire(&old->rcu, free_table);
+    }
+    if (remove != NULL) {
+        rcu_retire(&remove->rcu, free_app);
+    }
+    return 1;
+}
+
+static void forget_missing_app(DIALServer *ds, const char *app_name);
+
 int DIAL_register_app(DIALServer *ds, const char *app_name,
                       struct DIALAppCallbacks *callbacks, void *user_data,
                       int useAdditionalData,
                       const char* corsAllowedOrigin) {
-    DIALApp **ptr, *app;
+    struct DIALAppRegistration registration = {
+        *callbacks, user_data, useAdditionalData, corsAllowedOrigin, 0
+    };
+    return DIAL_register_app_ex(ds, app_name, &registration);
+}
+
+int DIAL_register_app_ex(DIALServer *ds, const char *app_name,
+                         const struct DIALAppRegistration *registration) {
+    DIALApp *app;
 
     if (!ds_lock(ds)) {
         return -1;
     }
-    ptr = find_app(ds, app_name);
-    if (*ptr != NULL) {  // app already registered
+    if (find_app(ds, app_name) != NULL) {  // app already registered
         ds_unlock(ds);
         return 0;
-    } else {
-        app = malloc(sizeof(DIALApp));
-        if (app == NULL) {
-            ds_unlock(ds);
-            return -1;
-        }
-        app->callbacks = *callbacks;
-        app->name = strdup(app_name);
-        if (app->name == NULL) {
-            free(app); app = NULL;
-            ds_unlock(ds);
-            return -1;
-        }
-        app->next = *ptr;
-        app->state = kDIALStatusStopped;
-        app->callback_data = user_data;
-        app->dial_data = retrieve_dial_data(app->name);
-        app->useAdditionalData = useAdditionalData;
-        app->corsAllowedOrigin[0] = '\0';
-        if (corsAllowedOrigin && strlen(corsAllowedOrigin) < sizeof(app->corsAllowedOrigin)) {
-            strcpy(app->corsAllowedOrigin, corsAllowedOrigin);
-        } else {
-            return -1;
+    }
+    app = create_app(app_name, registration, 0);
+    if (app == NULL || !publish_table(ds, app, NULL)) {
+        if (app != NULL) {
+            free_app(&app->rcu);
         }
-        *ptr = app;
         ds_unlock(ds);
-        return 1;
+        return -1;
     }
+    ds_unlock(ds);
+    forget_missing_app(ds, app_name);
+    return 1;
 }
 
 int DIAL_unregister_app(DIALServer *ds, const char *app_name) {
-    DIALApp **ptr, *app;
+    DIALApp *app;
+    int result;
 
     if (!ds_lock(ds)) {
         return -1;
     }
-    ptr = find_app(ds, app_name);
-    if (*ptr == NULL) {  // no such app
-        ds_unlock(ds);
-        return 0;
+    app = find_app(ds, app_name);
+    if (app == NULL) {  // no such app
+        result = 0;
     } else {
-        app = *ptr;
-        *ptr = app->next;
-        free(app->name); app->name = NULL;
-        free(app); app = NULL;
-        ds_unlock(ds);
-        return 1;
+        pthread_mutex_lock(&app->lock);
+        result = publish_table(ds, NULL, app) ? 1 : -1;
+        pthread_mutex_unlock(&app->lock);
+    }
+    ds_unlock(ds);
+    return result;
+}
+
+int DIAL_app_exited(DIALServer *ds, const char *app_name, DIAL_run_t run_id) {
+    DIALApp *app;
+    int result = -1;
+
+    rcu_read_lock();
+    app = find_app(ds, app_name);
+    if (app != NULL) {
+        pthread_mutex_lock(&app->lock);
+        result = app->snapshot->run_id == run_id &&
+                 app->snapshot->state != kDIALStatusStopped;
+        if (result) {
+            set_app_state(app, kDIALStatusStopped, run_id);
+        }
+        pthread_mutex_unlock(&app->lock);
+    }
+    rcu_read_unlock();
+    return result;
+}
+
+int DIAL_report_state(DIALServer *ds, const char *app_name, DIALStatus state,
+                      DIAL_run_t run_id, int can_stop) {
+    DIALApp *app;
+    int result = -1;
+
+    rcu_read_lock();
+    app = find_app(ds, app_name);
+    if (app != NULL) {
+        pthread_mutex_lock(&app->lock);
+        DIALAppSnapshot *snapshot = copy_snapshot(app);
+        if (snapshot != NULL) {
+            snapshot->state = state;
+            snapshot->run_id = run_id;
+            snapshot->can_stop = can_stop;
+            publish_snapshot(app, snapshot);
+            result = 1;
+        } else {
+            printf("Unable to update the %s state, out-of-memory.\n", app->info->name);
+        }
+        pthread_mutex_unlock(&app->lock);
     }
+    rcu_read_unlock();
+    return result;
 }
 
 const char * DIAL_get_payload(DIALServer *ds, const char *app_name) {
     const char * pPayload = NULL;
-    DIALApp **ptr, *app;
+    DIALApp *app;
+
+    // The payload only changes on launch, with the application lock held,
+    // which makes it stable within the application callbacks.
+    rcu_read_lock();
+    app = find_app(ds, app_name);
+    if (app != NULL) {
+        DIALBlob *payload = rcu_dereference(app->snapshot)->payload;
+        pPayload = payload != NULL ? payload->data : gEmptyPayload;
+    }
+    rcu_read_unlock();
+    return pPayload;
+}
+
+const char *DIAL_acquire_payload(DIALServer *ds, const char *app_name) {
+    const char *pPayload = NULL;
+    DIALApp *app;
 
-    // NOTE: Don't grab the mutex as we are calling this function from
-    // inside the application callback which already has the lock.
-    //ds_lock(ds);
-    ptr = find_app(ds, app_name);
-    if (*ptr != NULL) {
-        app = *ptr;
-        pPayload = app->payload;
+    rcu_read_lock();
+    app = find_app(ds, app_name);
+    if (app != NULL) {
+        DIALBlob *payload = blob_retain(rcu_dereference(app->snapshot)->payload);
+        pPayload = payload != NULL ? payload->data : gEmptyPayload;
     }
-    //ds_unlock(ds);
+    rcu_read_unlock();
     return pPayload;
 }
 
+void DIAL_release_payload(const char *payload) {
+    if (payload != NULL && payload != gEmptyPayload) {
+        blob_release((DIALBlob *) (payload - offsetof(DIALBlob, data)));
+    }
+}
+
+/**
+ * Run an operation on an application's DIAL data store and persist the
+ * result.
+ *
+ * @return the operation result, or -1 if the application is not registered.
+ */
+static int update_app_data(DIALServer *ds, const char *app_name,
+                           const char *key, const char *value) {
+    DIALApp *app;
+    int result = -1;
+
+    rcu_read_lock();
+    app = find_app(ds, app_name);
+    if (app != NULL) {
+        pthread_mutex_lock(&app->lock);
+        result = value ? dial_data_store_set(app->info->dial_data, key, value)
+                       : dial_data_store_delete(app->info->dial_data, key);
+        if (result == 1) {
+            persist_dial_data(app);
+        }
+        pthread_mutex_unlock(&app->lock);
+    }
+    rcu_read_unlock();
+    return result;
+}
+
+int DIAL_set_app_data(DIALServer *ds, const char *app_name, const char *key,
+                      const char *value) {
+    return update_app_data(ds, app_name, key, value);
+}
+
+int DIAL_delete_app_data(DIALServer *ds, const char *app_name, const char *key) {
+    return update_app_data(ds, app_name, key, NULL);
+}
+
+int DIAL_replace_app_data(DIALServer *ds, const char *app_name, const DIALData *data) {
+    DIALApp *app;
+    int result = -1;
+
+    rcu_read_lock();
+    app = find_app(ds, app_name);
+    if (app != NULL) {
+        pthread_mutex_lock(&app->lock);
+        result = replace_app_data(app, data);
+        pthread_mutex_unlock(&app->lock);
+    }
+    rcu_read_unlock();
+    return result;
+}
+
+int DIAL_set_app_data_quota(DIALServer *ds, const char *app_name,
+                            size_t max_entries, size_t max_bytes,
+                            DIALDataQuotaPolicy policy) {
+    DIALApp *app;
+    int result = -1;
+
+    rcu_read_lock();
+    app = find_app(ds, app_name);
+    if (app != NULL) {
+        pthread_mutex_lock(&app->lock);
+        size_t count = dial_data_store_count(app->info->dial_data);
+        result = dial_data_store_set_quota(app->info->dial_data, max_entries,
+                                           max_bytes, policy);
+        // Keys evicted to fit the new quotas are gone from disk too.
+        if (result == 1 && dial_data_store_count(app->info->dial_data) != count) {
+            persist_dial_data(app);
+        }
+        pthread_mutex_unlock(&app->lock);
+    }
+    rcu_read_unlock();
+    return result;
+}
+
+static time_t monotonic_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+/**
+ * Return the cache slot of an application name the provider did not know.
+ * The cache is direct-mapped, so a name evicts the one in its slot.
+ */
+static DIALProviderMiss *miss_slot(DIALServer *ds, uint32_t name_hash) {
+    return &ds->misses[name_hash % DIAL_PROVIDER_MISS_CACHE_SIZE];
+}
+
+static int is_missing_app(DIALServer *ds, const char *app_name, uint32_t name_hash) {
+    pthread_mutex_lock(&ds->miss_mux);
+    DIALProviderMiss *miss = miss_slot(ds, name_hash);
+    int missing = miss->name != NULL && miss->name_hash == name_hash &&
+        miss->expires > monotonic_seconds() && !strcmp(miss->name, app_name);
+    pthread_mutex_unlock(&ds->miss_mux);
+    return missing;
+}
+
+static void remember_missing_app(DIALServer *ds, const char *app_name, uint32_t name_hash) {
+    char *name = strdup(app_name);
+    if (name == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ds->miss_mux);
+    DIALProviderMiss *miss = miss_slot(ds, name_hash);
+    free(miss->name);
+    miss->name = name;
+    miss->name_hash = name_hash;
+    miss->expires = monotonic_seconds() + DIAL_PROVIDER_MISS_TTL_SEC;
+    pthread_mutex_unlock(&ds->miss_mux);
+}
+
+static void forget_missing_app(DIALServer *ds, const char *app_name) {
+    uint32_t name_hash = hash_app_name(app_name);
+    pthread_mutex_lock(&ds->miss_mux);
+    DIALProviderMiss *miss = miss_slot(ds, name_hash);
+    if (miss->name != NULL && !strcmp(miss->name, app_name)) {
+        free(miss->name);
+        miss->name = NULL;
+    }
+    pthread_mutex_unlock(&ds->miss_mux);
+}
+
+static void clear_missing_apps(DIALServer *ds) {
+    pthread_mutex_lock(&ds->miss_mux);
+    for (size_t i = 0; i < DIAL_PROVIDER_MISS_CACHE_SIZE; i++) {
+        free(ds->misses[i].name);
+        ds->misses[i].name = NULL;
+    }
+    pthread_mutex_unlock(&ds->miss_mux);
+}
+
+void DIAL_set_app_provider(DIALServer *ds, DIAL_app_provider_cb provider,
+                           void *provider_data, size_t max_apps) {
+    if (!ds_lock(ds)) {
+        return;
+    }
+    ds->provider_data = provider_data;
+    ds->max_provided_apps = max_apps;
+    __atomic_store_n(&ds->provider, provider, __ATOMIC_RELEASE);
+    ds_unlock(ds);
+    clear_missing_apps(ds);
+}
+
+/**
+ * Return the least recently used provided application that can be
+ * unregistered to make room for another one, locked, if there are too many.
+ *
+ * Must be called with the DIAL server mutex held.
+ */
+static DIALApp *lock_provided_app_to_evict(DIALServer *ds) {
+    DIALAppTable *table = ds->apps;
+    DIALApp *lru = NULL;
+    size_t provided = 0;
+
+    for (size_t i = 0; table != NULL && i < table->count; i++) {
+        DIALApp *app = table->entries[i].app;
+        if (app->info->provided) {
+            provided++;
+            if ((lru == NULL || __atomic_load_n(&app->last_used, __ATOMIC_RELAXED) <
+                                __atomic_load_n(&lru->last_used, __ATOMIC_RELAXED)) &&
+                rcu_dereference(app->snapshot)->state == kDIALStatusStopped) {
+                lru = app;
+            }
+        }
+    }
+    if (provided < ds->max_provided_apps || lru == NULL) {
+        return NULL;
+    }
+    // Skip the application if a request is using it, e.g. launching it.
+    if (pthread_mutex_trylock(&lru->lock) != 0) {
+        return NULL;
+    }
+    if (lru->snapshot->state != kDIALStatusStopped) {
+        pthread_mutex_unlock(&lru->lock);
+        return NULL;
+    }
+    return lru;
+}
+
+/**
+ * Ask the app provider for an application that is not registered, and
+ * register it.
+ *
+ * Must be called from a read-side critical section.
+ *
+ * @return the provided application, or NULL if the provider does not know it
+ *         or on error.
+ */
+static DIALApp *provide_app(DIALServer *ds, const char *app_name, uint32_t name_hash) {
+    struct DIALAppRegistration registration;
+    DIALApp *app;
+
+    if (!ds_lock(ds)) {
+        return NULL;
+    }
+    // Another request may have had it provided meanwhile.
+    app = find_app(ds, app_name);
+    if (app != NULL || ds->provider == NULL || is_missing_app(ds, app_name, name_hash)) {
+        ds_unlock(ds);
+        return app;
+    }
+    memset(&registration, 0, sizeof(registration));
+    if (!ds->provider(ds, app_name, &registration, ds->provider_data)) {
+        ds_unlock(ds);
+        remember_missing_app(ds, app_name, name_hash);
+        return NULL;
+    }
+    app = create_app(app_name, &registration, 1);
+    if (app == NULL) {
+        ds_unlock(ds);
+        return NULL;
+    }
+    app->last_used = __atomic_add_fetch(&ds->use_clock, 1, __ATOMIC_RELAXED);
+    DIALApp *evicted = lock_provided_app_to_evict(ds);
+    if (!publish_table(ds, app, evicted)) {
+        free_app(&app->rcu);
+        app = NULL;
+    }
+    if (evicted != NULL) {
+        pthread_mutex_unlock(&evicted->lock);
+    }
+    ds_unlock(ds);
+    return app;
+}
+
+/**
+ * Finds an application, asking the app provider for it if it is not
+ * registered.
+ *
+ * Must be called from a read-side critical section.
+ *
+ * @param ds the DIAL server.
+ * @param app_name application name.
+ * @return the DIAL application or NULL if the application was not found.
+ */
+static DIALApp *lookup_app(DIALServer *ds, const char *app_name) {
+    DIALApp *app = find_app(ds, app_name);
+    if (app != NULL) {
+        if (app->info->provided) {
+            __atomic_store_n(&app->last_used,
+                             __atomic_add_fetch(&ds->use_clock, 1, __ATOMIC_RELAXED),
+                             __ATOMIC_RELAXED);
+        }
+        return app;
+    }
+    if (__atomic_load_n(&ds->provider, __ATOMIC_ACQUIRE) == NULL) {
+        return NULL;
+    }
+    uint32_t name_hash = hash_app_name(app_name);
+    if (is_missing_app(ds, app_name, name_hash)) {
+        return NULL;
+    }
+    return provide_app(ds, app_name, name_hash);
+}
@@ -27,6 +27,9 @@
 #define DIAL_SERVER_H_
 
 #include <netinet/in.h>
+#include <stddef.h>
+
+#include "dial_data_store.h"
 
 //#define DEBUG
 #ifdef DEBUG
@@ -113,11 +116,126 @@ struct DIALAppCallbacks {
     DIAL_app_status_cb status_cb;
 };
 
+/*
+ * Registration of an application, see DIAL_register_app_ex(), or built on
+ * demand by an application provider.
+ */
+struct DIALAppRegistration {
+    struct DIALAppCallbacks callbacks;
+    void *callback_data;
+    int useAdditionalData;              // non-0 if DIALadditionalDataURL is supported
+    const char *corsAllowedOrigin;      // copied, NULL or empty to allow any origin
+    int statePushed;                    // non-0 if the state is only reported with
+                                        // DIAL_report_state(), status_cb is not called
+};
+
+/*
+ * DIAL application provider callback, called for a request to an application
+ * that is not registered. Calls are serialized, and must not register or
+ * unregister applications.
+ *
+ * @return 1 after filling in the registration if the application exists, 0
+ *         otherwise.
+ */
+typedef int (*DIAL_app_provider_cb)(DIALServer *ds, const char *app_name,
+                                    struct DIALAppRegistration *registration,
+                                    void *provider_data);
+
+/*
+ * Number of application names a provider did not know that are remembered,
+ * and for how long, so requests for them do not call the provider again.
+ */
+#define DIAL_PROVIDER_MISS_CACHE_SIZE (256)
+#define DIAL_PROVIDER_MISS_TTL_SEC (30)
+
 /*
  * Creates the DIAL server.  Returns a handle to the DIAL server.
  */
 DIALServer *DIAL_create();
 
+/*
+ * Set the port of the DIAL REST endpoint, 0 for any free port. Must be
+ * called before DIAL_start(). Defaults to 56789.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] port port number
+ */
+void DIAL_set_port(DIALServer *ds, in_port_t port);
+
+/*
+ * Requests limited per client address, each with its own token bucket.
+ */
+typedef enum {
+    kDIALRateLaunch,    // launch, hide and stop
+    kDIALRateStatus,    // application status
+    kDIALRateData,      // DIAL data
+    kDIALRateNumClasses
+} DIALRateClass;
+
+/*
+ * Suggested rate limits, in requests per second and requests allowed at once,
+ * and a suggested window over which identical launches are collapsed. Neither
+ * is applied unless set with DIAL_set_rate_limit() and
+ * DIAL_set_launch_debounce(). Clients are told apart by address, so every
+ * client on the device itself shares one bucket.
+ */
+#define DIAL_RATE_LAUNCH_PER_SECOND (2)
+#define DIAL_RATE_LAUNCH_BURST (10)
+#define DIAL_RATE_STATUS_PER_SECOND (20)
+#define DIAL_RATE_STATUS_BURST (50)
+#define DIAL_RATE_DATA_PER_SECOND (10)
+#define DIAL_RATE_DATA_BURST (20)
+#define DIAL_LAUNCH_DEBOUNCE_MS (500)
+
+/*
+ * Set the rate limit of a class of requests. A client over the limit is
+ * answered 429 Too Many Requests, before any application is looked at. Must
+ * be called before DIAL_start(). Requests are not limited by default.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] request_class the class of requests
+ * @param[in] per_second sustained requests per second, 0 for no limit
+ * @param[in] burst requests allowed at once, at least 1 if limited
+ *
+ * @return 1 if the limit is set, 0 if the class is unknown or the burst is 0
+ *         with a nonzero rate.
+ */
+int DIAL_set_rate_limit(DIALServer *ds, DIALRateClass request_class,
+                        unsigned int per_second, unsigned int burst);
+
+/*
+ * Set the time window over which a launch with the same payload and query
+ * string as the previous one, while the application it started is still
+ * running, is answered with the previous result instead of starting the
+ * application again. Launches are not collapsed by default.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] window_ms debounce window in milliseconds, 0 to disable
+ */
+void DIAL_set_launch_debounce(DIALServer *ds, unsigned int window_ms);
+
+/*
+ * Set the time window over which DIAL data updates posted by an application
+ * are coalesced before being written to disk, in the background. Must be
+ * called before DIAL_start(). Defaults to DIAL_DATA_WRITE_WINDOW_MS.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] window_ms write window in milliseconds
+ */
+void DIAL_set_data_write_window(DIALServer *ds, unsigned int window_ms);
+
+/*
+ * Publish the state of the registered applications in a shared memory
+ * segment, which local components read with the app_state_shm.h reader
+ * functions, until DIAL_stop() removes it.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] shm_name shared memory object name, e.g. "/dial_app_state"
+ *
+ * @return 1 if the states are published, 0 on error.
+ */
+int DIAL_publish_app_states(DIALServer *ds, const char *shm_name);
+
 /*
  * Starts the DIAL server.
  *
@@ -128,7 +246,7 @@ DIALServer *DIAL_create();
 int DIAL_start(DIALServer *ds);
 
 /*
- * Stop the DIAL server.
+ * Stop the DIAL server. Pending DIAL data is written to disk before returning.
  *
  * @param[in] ds DIAL server handle
  */
@@ -152,6 +270,33 @@ int DIAL_register_app(DIALServer *ds, const char *app_name,
                       void *callback_data, int useAdditionalData,
                       const char* corsAllowedOrigin);
 
+/*
+ * Register a DIAL application with all of its registration options.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] app_name Name of the application.
+ * @param[in] registration the registration, copied
+ *
+ * @return 1 if successful, 0 if already registered, -1 on error.
+ */
+int DIAL_register_app_ex(DIALServer *ds, const char *app_name,
+                         const struct DIALAppRegistration *registration);
+
+/*
+ * Set the provider of applications that are not registered in advance. An
+ * application it provides is registered on first use; once there are more
+ * than max_apps of them, the least recently used stopped one is unregistered
+ * again. The provider is not called again for a name it did not know for
+ * DIAL_PROVIDER_MISS_TTL_SEC, or until that application is registered.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] provider the provider callback, NULL to remove it
+ * @param[in] provider_data passed to the provider
+ * @param[in] max_apps number of provided applications kept registered
+ */
+void DIAL_set_app_provider(DIALServer *ds, DIAL_app_provider_cb provider,
+                           void *provider_data, size_t max_apps);
+
 /*
  * Unregsiter an application
  *
@@ -162,6 +307,39 @@ int DIAL_register_app(DIALServer *ds, const char *app_name,
  */
 int DIAL_unregister_app(DIALServer *ds, const char *app_name);
 
+/*
+ * Report that a run of an application ended, e.g. its process exited. The
+ * application is stopped if it is still its current run. Must not be called
+ * from the application callbacks.
+ *
+ * @param ds DIAL server handle
+ * @param app_name Name of the application
+ * @param run_id the run id set by the start callback
+ *
+ * @return 1 if the application was stopped, 0 if run_id is not its current
+ *         run or it was already stopped, -1 if it is not registered.
+ */
+int DIAL_app_exited(DIALServer *ds, const char *app_name, DIAL_run_t run_id);
+
+/*
+ * Report the state of an application, e.g. from the runtime of an application
+ * registered with statePushed. Status requests for such an application are
+ * answered from the last reported state. Each report is published as a new
+ * state version, even if the state is unchanged. Must not be called from the
+ * application callbacks.
+ *
+ * @param ds DIAL server handle
+ * @param app_name Name of the application
+ * @param state the application state
+ * @param run_id the run id of the application
+ * @param can_stop non-0 if the application can be stopped
+ *
+ * @return 1 if successful, -1 if the application is not registered or on
+ *         error.
+ */
+int DIAL_report_state(DIALServer *ds, const char *app_name, DIALStatus state,
+                      DIAL_run_t run_id, int can_stop);
+
 /*
  * Get the DIAL REST endpoint
  *
@@ -173,11 +351,96 @@ in_port_t DIAL_get_port(DIALServer *ds);
  * Get the last payload delivered to an application.  This can be used
  * by application clients to see if the payload changed between lauches.
  *
+ * The payload is only guaranteed to remain valid within the callbacks of the
+ * application; use DIAL_acquire_payload() to hold on to it.
+ *
  * @param[in] ds DIAL server handle
  * @param[in] app_name Name of the application
  *
- * @return Pointer to a NULL terminated string.
+ * @return Pointer to a NULL terminated string, or NULL if the application is
+ *         not registered.
  */
 const char * DIAL_get_payload(DIALServer *ds, const char *app_name);
 
+/*
+ * Get a reference to the last payload delivered to an application, which
+ * remains valid until released with DIAL_release_payload(), even if the
+ * application is launched again or unregistered.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] app_name Name of the application
+ *
+ * @return Pointer to a NULL terminated string, or NULL if the application is
+ *         not registered.
+ */
+const char * DIAL_acquire_payload(DIALServer *ds, const char *app_name);
+
+/*
+ * Release a payload returned by DIAL_acquire_payload().
+ *
+ * @param[in] payload the payload, may be NULL
+ */
+void DIAL_release_payload(const char *payload);
+
+/*
+ * Add or update a single DIAL data key of an application. The data store is
+ * persisted like data posted to the dial_data endpoint.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] app_name Name of the application
+ * @param[in] key URL-escaped key
+ * @param[in] value URL-escaped value
+ *
+ * @return 1 if successful, 0 if rejected by the application data quota, -1 if
+ *         the application is not registered or on error.
+ */
+int DIAL_set_app_data(DIALServer *ds, const char *app_name, const char *key,
+                      const char *value);
+
+/*
+ * Delete a single DIAL data key of an application.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] app_name Name of the application
+ * @param[in] key URL-escaped key
+ *
+ * @return 1 if successful, 0 if the key was not set, -1 if the application is
+ *         not registered or on error.
+ */
+int DIAL_delete_app_data(DIALServer *ds, const char *app_name, const char *key);
+
+/*
+ * Replace all the DIAL data of an application, like data posted to the
+ * dial_data endpoint.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] app_name Name of the application
+ * @param[in] data the new URL-escaped keys and values, NULL to clear them
+ *
+ * @return 1 if successful, 0 if rejected by the application data quotas, -1 if
+ *         the application is not registered or on error.
+ */
+int DIAL_replace_app_data(DIALServer *ds, const char *app_name, const DIALData *data);
+
+/*
+ * Set the DIAL data quotas of an application. Applications are registered
+ * with DIAL_DATA_STORE_DEFAULT_MAX_ENTRIES, DIAL_DATA_STORE_DEFAULT_MAX_BYTES
+ * and kDIALDataQuotaReject.
+ *
+ * @param[in] ds DIAL server handle
+ * @param[in] app_name Name of the application
+ * @param[in] max_entries Maximum number of keys, 0 for no limit
+ * @param[in] max_bytes Maximum total size of the keys and values, 0 for no
+ *            limit
+ * @param[in] policy Whether updates exceeding a quota are rejected or evict
+ *            the oldest keys
+ *
+ * @return 1 if successful, 0 if the current data does not fit the new quotas
+ *         and the policy is kDIALDataQuotaReject, -1 if the application is not
+ *         registered or on error.
+ */
+int DIAL_set_app_data_quota(DIALServer *ds, const char *app_name,
+                            size_t max_entries, size_t max_bytes,
+                            DIALDataQuotaPolicy policy);
+
 #endif  // DIAL_SERVER_H_
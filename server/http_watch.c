@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#define _GNU_SOURCE
+#include "http_watch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    int sock;
+    int64_t deadline_ms;    // CLOCK_MONOTONIC
+    http_watch_cb cb;
+    void *data;
+} Watcher;
+
+static struct {
+    int running;
+    pthread_t thread;
+    int stop_fd;            // eventfd
+    int wake_fd;            // eventfd
+    pthread_mutex_t mutex;  // guards the watchers
+    Watcher watchers[HTTP_WATCH_MAX_WATCHERS];
+    size_t count;           // also read without the mutex by http_watch_notify()
+} gWatch = { .stop_fd = -1, .wake_fd = -1, .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static int64_t monotonic_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void end_watch(Watcher *watcher) {
+    shutdown(watcher->sock, SHUT_WR);
+    close(watcher->sock);
+    free(watcher->data);
+}
+
+/**
+ * Call the watch callbacks and end the watches that are over.
+ *
+ * Must be called with the mutex held.
+ *
+ * @param fds the polled connections, which are dropped if readable.
+ * @param polled number of polled connections, the first ones.
+ * @param notified whether the watch thread was woken.
+ */
+static void run_watchers(const struct pollfd *fds, size_t polled, int notified) {
+    int64_t now = monotonic_ms();
+    size_t kept = 0;
+    for (size_t i = 0; i < gWatch.count; i++) {
+        Watcher *watcher = &gWatch.watchers[i];
+        int keep;
+        if (i < polled && fds[i].revents) {
+            // The client hung up, or sent more than the watch request.
+            keep = 0;
+        } else if (now >= watcher->deadline_ms) {
+            watcher->cb(watcher->sock, watcher->data, 1);
+            keep = 0;
+        } else {
+            keep = !notified || watcher->cb(watcher->sock, watcher->data, 0);
+        }
+        if (keep) {
+            gWatch.watchers[kept++] = *watcher;
+        } else {
+            end_watch(watcher);
+        }
+    }
+    __atomic_store_n(&gWatch.count, kept, __ATOMIC_RELAXED);
+}
+
+static void *watch_thread(void *arg) {
+    struct pollfd fds[2 + HTTP_WATCH_MAX_WATCHERS];
+    for (;;) {
+        int timeout = -1;
+        pthread_mutex_lock(&gWatch.mutex);
+        size_t polled = gWatch.count;
+        int64_t now = monotonic_ms();
+        for (size_t i = 0; i < polled; i++) {
+            int64_t left = gWatch.watchers[i].deadline_ms - now;
+            if (left < 0) {
+                left = 0;
+            }
+            if (timeout == -1 || left < timeout) {
+                timeout = (int) left;
+            }
+            fds[2 + i] = (struct pollfd) { gWatch.watchers[i].sock, POLLIN | POLLRDHUP, 0 };
+        }
+        pthread_mutex_unlock(&gWatch.mutex);
+        fds[0] = (struct pollfd) { gWatch.stop_fd, POLLIN, 0 };
+        fds[1] = (struct pollfd) { gWatch.wake_fd, POLLIN, 0 };
+
+        if (poll(fds, 2 + polled, timeout) < 0) {
+            continue;
+        }
+        if (fds[0].revents) {
+            break;
+        }
+        uint64_t wakes;
+        int notified = fds[1].revents && read(gWatch.wake_fd, &wakes, sizeof(wakes)) == sizeof(wakes);
+        pthread_mutex_lock(&gWatch.mutex);
+        run_watchers(fds + 2, polled, notified);
+        pthread_mutex_unlock(&gWatch.mutex);
+    }
+    return NULL;
+}
+
+int start_http_watch() {
+    if (gWatch.running) {
+        return 1;
+    }
+    gWatch.count = 0;
+    gWatch.stop_fd = eventfd(0, EFD_CLOEXEC);
+    gWatch.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (gWatch.stop_fd != -1 && gWatch.wake_fd != -1) {
+        sigset_t all, previous;
+        sigfillset(&all);
+        pthread_sigmask(SIG_SETMASK, &all, &previous);
+        gWatch.running = pthread_create(&gWatch.thread, NULL, watch_thread, NULL) == 0;
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    }
+    if (!gWatch.running) {
+        if (gWatch.stop_fd != -1) {
+            close(gWatch.stop_fd);
+        }
+        if (gWatch.wake_fd != -1) {
+            close(gWatch.wake_fd);
+        }
+        gWatch.stop_fd = gWatch.wake_fd = -1;
+    }
+    return gWatch.running;
+}
+
+void stop_http_watch() {
+    if (!gWatch.running) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(gWatch.stop_fd, &one, sizeof(one)) != sizeof(one)) {
+        printf("Unable to stop the watch thread: %s\n", strerror(errno));
+        return;
+    }
+    pthread_join(gWatch.thread, NULL);
+    pthread_mutex_lock(&gWatch.mutex);
+    gWatch.running = 0;
+    for (size_t i = 0; i < gWatch.count; i++) {
+        end_watch(&gWatch.watchers[i]);
+    }
+    gWatch.count = 0;
+    pthread_mutex_unlock(&gWatch.mutex);
+    close(gWatch.stop_fd);
+    close(gWatch.wake_fd);
+    gWatch.stop_fd = gWatch.wake_fd = -1;
+}
+
+int http_watch_add(int sock, unsigned int timeout_ms, http_watch_cb cb, void *data) {
+    int added = 0;
+    pthread_mutex_lock(&gWatch.mutex);
+    if (gWatch.running && gWatch.count < HTTP_WATCH_MAX_WATCHERS) {
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+        gWatch.watchers[gWatch.count] = (Watcher) {
+            sock, monotonic_ms() + timeout_ms, cb, data
+        };
+        __atomic_store_n(&gWatch.count, gWatch.count + 1, __ATOMIC_SEQ_CST);
+        added = 1;
+    }
+    pthread_mutex_unlock(&gWatch.mutex);
+    if (added) {
+        // The change may have happened before the connection was parked.
+        uint64_t one = 1;
+        if (write(gWatch.wake_fd, &one, sizeof(one)) != sizeof(one)) {
+            // The counter is already non-zero, so the watchers run anyway.
+        }
+    }
+    return added;
+}
+
+void http_watch_notify() {
+    // Orders the change before the check, against http_watch_add().
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&gWatch.count, __ATOMIC_SEQ_CST) > 0) {
+        uint64_t one = 1;
+        if (write(gWatch.wake_fd, &one, sizeof(one)) != sizeof(one)) {
+            // The counter is already non-zero, so the watchers run anyway.
+        }
+    }
+}
+
+int http_watch_send(int sock, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(sock, buf, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent <= 0) {
+            return 0;
+        }
+        buf += sent;
+        len -= sent;
+    }
+    return 1;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Connections waiting for a change.
+ *
+ * An HTTP request that waits for an event, such as an application state
+ * change, is detached from its worker thread and parked here. A single thread
+ * polls the parked connections; http_watch_notify() wakes it to check all of
+ * them at once, and each connection is answered when its watch times out at
+ * the latest.
+ */
+
+#ifndef SRC_SERVER_HTTP_WATCH_H_
+#define SRC_SERVER_HTTP_WATCH_H_
+
+#include <stddef.h>
+
+/*
+ * Maximum number of parked connections.
+ */
+#define HTTP_WATCH_MAX_WATCHERS (64)
+
+/**
+ * Called from the watch thread, after every notification and once when the
+ * watch times out.
+ *
+ * @param sock the parked connection.
+ * @param data the watch data.
+ * @param timed_out 1 if the watch timed out, after which it ends anyway.
+ * @return 1 to keep watching, 0 to end the watch.
+ */
+typedef int (*http_watch_cb)(int sock, void *data, int timed_out);
+
+/**
+ * Start the watch thread.
+ *
+ * @return 1 if the watch thread is running, 0 on error.
+ */
+int start_http_watch();
+
+/**
+ * Stop the watch thread and close the parked connections without answering
+ * them.
+ */
+void stop_http_watch();
+
+/**
+ * Park a connection. The watch callback is called right away, and the
+ * connection is closed and the data freed with free() when the watch ends.
+ *
+ * @param sock the connection, detached from its worker thread.
+ * @param timeout_ms maximum duration of the watch.
+ * @param cb the watch callback.
+ * @param data the watch data, allocated with malloc().
+ * @return 1 if the connection is parked, 0 if the watch thread is not running
+ *         or there are too many, in which case the caller keeps the
+ *         connection and the data.
+ */
+int http_watch_add(int sock, unsigned int timeout_ms, http_watch_cb cb, void *data);
+
+/**
+ * Wake the watch thread to call the watch callbacks. Does not block, and only
+ * makes a system call if connections are parked.
+ */
+void http_watch_notify();
+
+/**
+ * Send a response on a parked connection, without blocking.
+ *
+ * @return 1 if all of it was sent, 0 otherwise.
+ */
+int http_watch_send(int sock, const char *buf, size_t len);
+
+#endif /* SRC_SERVER_HTTP_WATCH_H_ */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#define _GNU_SOURCE
+#include "launcher.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern char **environ;
+
+char **merge_env(char * const env[]) {
+    size_t count = 0, added = 0;
+    while (environ[count] != NULL) {
+        count++;
+    }
+    while (env != NULL && env[added] != NULL) {
+        added++;
+    }
+    char **merged = (char **) malloc((count + added + 1) * sizeof(char *));
+    if (merged == NULL) {
+        return NULL;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t name_len = strcspn(environ[i], "=");
+        int replaced = 0;
+        for (size_t j = 0; j < added && !replaced; j++) {
+            replaced = !strncmp(env[j], environ[i], name_len) && env[j][name_len] == '=';
+        }
+        if (!replaced) {
+            merged[n++] = environ[i];
+        }
+    }
+    for (size_t j = 0; j < added; j++) {
+        merged[n++] = env[j];
+    }
+    merged[n] = NULL;
+    return merged;
+}
+
+pid_t launch_process(const char *path, char * const argv[], char * const env[],
+                     const int *keep_fds, size_t keep_count) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t none, pipe_signal;
+    pid_t pid = -1;
+    int ret;
+
+    // Move the descriptors to keep above their targets first, so moving them
+    // to their targets cannot overwrite one another.
+    int *moved = (int *) calloc(keep_count ? keep_count : 1, sizeof(int));
+    char **merged = merge_env(env);
+    size_t n_moved = 0;
+    if (moved == NULL || merged == NULL) {
+        free(moved);
+        free(merged);
+        return -1;
+    }
+    for (; n_moved < keep_count; n_moved++) {
+        moved[n_moved] = fcntl(keep_fds[n_moved], F_DUPFD_CLOEXEC, (int) (3 + keep_count));
+        if (moved[n_moved] == -1) {
+            break;
+        }
+    }
+
+    sigemptyset(&none);
+    sigemptyset(&pipe_signal);
+    sigaddset(&pipe_signal, SIGPIPE);
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+    ret = n_moved == keep_count ? 0 : errno;
+    for (size_t i = 0; ret == 0 && i < keep_count; i++) {
+        ret = posix_spawn_file_actions_adddup2(&actions, moved[i], (int) (3 + i));
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 34)
+    if (ret == 0) {
+        ret = posix_spawn_file_actions_addclosefrom_np(&actions, (int) (3 + keep_count));
+    }
+#endif
+    if (ret == 0) {
+        ret = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    }
+    if (ret == 0) {
+        ret = posix_spawnattr_setsigmask(&attr, &none);
+    }
+    if (ret == 0) {
+        ret = posix_spawnattr_setsigdefault(&attr, &pipe_signal);
+    }
+    if (ret == 0) {
+        ret = posix_spawn(&pid, path, &actions, &attr, argv, merged);
+    }
+    if (ret != 0) {
+        printf("%s failed to launch: %s\n", path, strerror(ret));
+        pid = -1;
+    }
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    for (size_t i = 0; i < n_moved; i++) {
+        close(moved[i]);
+    }
+    free(moved);
+    free(merged);
+    return pid;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Launches application processes without duplicating the server.
+ *
+ * Processes are created with posix_spawn(), which does not copy the address
+ * space of the server, and only inherit the descriptors they are given. The
+ * server opens every other descriptor close-on-exec, and with glibc 2.34 or
+ * later any descriptor left open is closed in the process too.
+ */
+
+#ifndef SRC_SERVER_LAUNCHER_H_
+#define SRC_SERVER_LAUNCHER_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * Launch a program. The process inherits the standard streams and the
+ * descriptors in keep_fds, keep_fds[i] as descriptor 3 + i, and no other. It
+ * starts with no signal blocked and SIGPIPE handled by default.
+ *
+ * @param path path of the program.
+ * @param argv NULL terminated arguments.
+ * @param env NULL terminated "NAME=value" variables added to or replacing the
+ *        environment of the server, or NULL.
+ * @param keep_fds descriptors to pass to the process, or NULL.
+ * @param keep_count number of descriptors in keep_fds.
+ * @return the PID of the process, or -1 if it cannot be created or the
+ *         program cannot be executed.
+ */
+pid_t launch_process(const char *path, char * const argv[], char * const env[],
+                     const int *keep_fds, size_t keep_count);
+
+/**
+ * Merge variables into the environment of the process.
+ *
+ * @param env NULL terminated "NAME=value" variables added to or replacing
+ *        the environment, or NULL.
+ * @return a NULL terminated array referencing the variables, or NULL if
+ *         out-of-memory. The caller must free the array only.
+ */
+char **merge_env(char * const env[]);
+
+#endif /* SRC_SERVER_LAUNCHER_H_ */
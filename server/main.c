@@ -32,15 +32,21 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
-#include <dirent.h>
-#include <regex.h>
 
 #include "dial_server.h"
 #include "dial_options.h"
 #include <signal.h>
 #include <stdbool.h>
 
+#include "child_reaper.h"
+#include "dial_control.h"
+#include "dial_data_db.h"
+#include "launcher.h"
+#include "proc_table.h"
+#include "proc_watch.h"
 #include "url_lib.h"
+#include "warm_app.h"
+#include "zygote.h"
 #include "nf_callbacks.h"
 #include "system_callbacks.h"
 
@@ -60,8 +66,19 @@ static char spModelName[BUFSIZE];
 static char spUuid[BUFSIZE];
 extern bool wakeOnWifiLan;
 static int gDialPort;
+static bool gUseZygote = false;
+// Keeping hidden applications resident, see warm_app.h
+enum { WARM_APPS_OFF, WARM_APPS_ON, WARM_APPS_PRELAUNCH };
+static int gWarmApps = WARM_APPS_OFF;
+static int gResumeSignal = 0;
+unsigned int gStopGraceMs = CHILD_REAPER_STOP_GRACE_MS;
+WarmApp gNetflixWarmApp;
+static WarmApp gYouTubeWarmApp;
 
 char spSleepPassword[BUFSIZE];
+static char spDialDataStore[BUFSIZE];
+static char spControlSocket[BUFSIZE];
+static char spAppStateShm[BUFSIZE];
 
 static char *spAppYouTube = "chrome";
 static char *spAppYouTubeMatch = "chrome.*google-chrome-dial";
@@ -71,25 +88,6 @@ static char *spYouTubePS3UserAgent = "--user-agent="
     "Chrome/19.0.1048.0 LeanbackShell/01.00.01.73 QA Safari/535.22 Sony PS3/ "
     "(PS3, , no, CH)";
 
-int doesMatch( char* pzExp, char* pzStr)
-{
-    regex_t exp;
-    int ret;
-    int match = 0;
-    if ((ret = regcomp( &exp, pzExp, REG_EXTENDED ))) {
-        char errbuf[1024] = {0,};
-        regerror(ret, &exp, errbuf, sizeof(errbuf));
-        fprintf( stderr, "regexp error: %s", errbuf );
-    } else {
-        regmatch_t matches[1];
-        if( regexec( &exp, pzStr, 1, matches, 0 ) == 0 ) {
-            match = 1;
-        }
-    }
-    regfree(&exp);
-    return match;
-}
-
 void signalHandler(int signal)
 {
     switch(signal)
@@ -101,81 +99,38 @@ void signalHandler(int signal)
 }
 
 /*
- * This function will walk /proc and look for the application in
- * /proc/<PID>/comm. and /proc/<PID>/cmdline to find it's command (executable
- * name) and command line (if needed).
+ * This function looks the application up in the process table (see
+ * proc_table.h), by the end of its executable path and, if needed, its
+ * command line. The patterns are compiled the first time they are used and
+ * /proc is walked at most once per refresh interval, whatever the number of
+ * calls, or not at all once the process watcher (see proc_watch.h) reports
+ * every process event.
  * Implementors can override this function with an equivalent.
  */
 int isAppRunning( char *pzName, char *pzCommandPattern ) {
-  DIR* proc_fd = opendir("/proc");
-  if( proc_fd != NULL ) {
-    struct dirent* procEntry;
-    while((procEntry=readdir(proc_fd)) != NULL) {
-      if( doesMatch( "^[0-9][0-9]*$", procEntry->d_name ) ) {
-        char exePath[384] = {0,};
-        char link[256] = {0,};
-        char cmdlinePath[384] = {0,};
-        char buffer[1024] = {0,};
-        int len;
-        snprintf( exePath, sizeof(exePath), "/proc/%s/exe", procEntry->d_name);
-        snprintf( cmdlinePath, sizeof(cmdlinePath), "/proc/%s/cmdline", procEntry->d_name);
-
-        if( (len = readlink( exePath, link, sizeof(link)-1)) != -1 ) {
-          char executable[256] = {0,};
-          strncpy( executable, pzName, sizeof(executable) - 2 );
-          strcat( executable, "$" );
-          // TODO: Make this search for EOL to prevent false positives
-          if( !doesMatch( executable, link ) ) {
-            continue;
-          }
-          // else //fall through, we found it
-        }
-        else continue;
-
-        if (pzCommandPattern != NULL) {
-          FILE *cmdline = fopen(cmdlinePath, "r");
-          if (!cmdline) {
-            continue;
-          }
-          if (fgets(buffer, 1024, cmdline) == NULL) {
-            fclose(cmdline);
-            continue;
-          }
-          fclose(cmdline);
-
-          if (!doesMatch( pzCommandPattern, buffer )) {
-            continue;
-          }
-        }
-        int d_name = atoi(procEntry->d_name);
-        closedir(proc_fd);
-        return d_name;
-      }
-    }
+  return proc_table_find( proc_table_register( pzName, pzCommandPattern ) );
+}
 
-    closedir(proc_fd);
-  } else {
-    printf("/proc failed to open\n");
+static pid_t spawnApplication( void *spawn_data ) {
+  const char * const *args = (const char * const *) spawn_data;
+  int template_id = zygote_find_template( *args );
+  if (template_id != -1) {
+    return zygote_spawn( template_id, args + 1 );
   }
-  return 0;
+  char * const env[] = { spDataDir, NULL };
+  return launch_process( *args, (char * const *) args, env, NULL, 0 );
 }
 
-pid_t runApplication( const char * const args[], DIAL_run_t *run_id ) {
-  pid_t pid = fork();
+pid_t runApplication( DIALServer *ds, const char *app_name,
+                      const char * const args[], DIAL_run_t *run_id ) {
+  printf("Execute:\n");
+  for(int i = 0; args[i]; ++i) {
+    printf(" %d) %s\n", i, args[i]);
+  }
+  pid_t pid = child_reaper_spawn(ds, app_name, spawnApplication, (void *) args);
   if (pid != -1) {
-    if (!pid) { // child
-      putenv(spDataDir);
-      printf("Execute:\n");
-      for(int i = 0; args[i]; ++i) {
-        printf(" %d) %s\n", i, args[i]);
-      }
-      if( execv(*args, (char * const *) args) == -1) {
-		printf("%s failed to launch\n", *args);
-		perror("Failed to Launch \n");
-      }
-    } else {
-      *run_id = (void *)(long)pid; // parent PID
-    }
+    *run_id = (void *)(long)pid;
+    proc_table_invalidate();
     return kDIALStatusRunning;
   } else {
     return kDIALStatusStopped;
@@ -192,7 +147,10 @@ int shouldRelaunch(
     const char *pAppName,
     const char *args )
 {
-    return ( strncmp( DIAL_get_payload(pServer, pAppName), args, DIAL_MAX_PAYLOAD ) != 0 );
+    const char *pPayload = DIAL_acquire_payload(pServer, pAppName);
+    int relaunch = ( pPayload == NULL || strncmp( pPayload, args, DIAL_MAX_PAYLOAD ) != 0 );
+    DIAL_release_payload(pPayload);
+    return relaunch;
 }
 
 static DIALStatus youtube_start(DIALServer *ds, const char *appname,
@@ -215,7 +173,22 @@ static DIALStatus youtube_start(DIALServer *ds, const char *appname,
       spYouTubePS3UserAgent,
       data, "--app", url, NULL
     };
-    runApplication( youtube_args, run_id );
+
+    // resume a hidden YouTube, unless it cannot take the new URL
+    pid_t hiddenPid = warm_app_hidden( &gYouTubeWarmApp );
+    int resumed = warm_app_resume( &gYouTubeWarmApp, youtube_args );
+    if (resumed == 1) {
+      *run_id = (DIAL_run_t)(long)hiddenPid;
+      return kDIALStatusRunning;
+    } else if (resumed == 0) {
+      if (child_reaper_stop(hiddenPid, gStopGraceMs) == -1) {
+        kill(hiddenPid, SIGTERM);
+      }
+      proc_table_invalidate();
+    }
+    if (runApplication( ds, appname, youtube_args, run_id ) == kDIALStatusRunning) {
+      warm_app_started( &gYouTubeWarmApp, (pid_t)(long)*run_id, youtube_args );
+    }
 
     return kDIALStatusRunning;
 }
@@ -223,22 +196,44 @@ static DIALStatus youtube_start(DIALServer *ds, const char *appname,
 static DIALStatus youtube_hide(DIALServer *ds, const char *app_name,
                                         DIAL_run_t *run_id, void *callback_data)
 {
-    return (isAppRunning( spAppYouTube, spAppYouTubeMatch )) ? kDIALStatusRunning : kDIALStatusStopped;
+    // keep the process resident if enabled, suspended
+    pid_t pid = (pid_t)(long)*run_id;
+    if (!pid || child_reaper_exited(pid, NULL, NULL) != 0) {
+      pid = isAppRunning( spAppYouTube, spAppYouTubeMatch );
+    }
+    if (warm_app_hide( &gYouTubeWarmApp, pid )) {
+      *run_id = (DIAL_run_t)(long)pid;
+      return kDIALStatusHide;
+    }
+    return pid ? kDIALStatusRunning : kDIALStatusStopped;
 }
         
 static DIALStatus youtube_status(DIALServer *ds, const char *appname,
                                  DIAL_run_t run_id, int *pCanStop, void *callback_data) {
     // YouTube can stop
     *pCanStop = 1;
+    if (warm_app_hidden( &gYouTubeWarmApp )) {
+        return kDIALStatusHide;
+    }
+    if (run_id && child_reaper_exited((pid_t)(long)run_id, NULL, NULL) == 0) {
+        return kDIALStatusRunning;
+    }
     return isAppRunning( spAppYouTube, spAppYouTubeMatch ) ? kDIALStatusRunning : kDIALStatusStopped;
 }
 
 static void youtube_stop(DIALServer *ds, const char *appname, DIAL_run_t run_id,
                          void *callback_data) {
     printf("\n\n ** KILL YouTube **\n\n");
-    pid_t pid;
-    if ((pid = isAppRunning( spAppYouTube, spAppYouTubeMatch ))) {
-        kill(pid, SIGTERM);
+    pid_t pid = warm_app_hidden( &gYouTubeWarmApp );
+    if (!pid && run_id && child_reaper_exited((pid_t)(long)run_id, NULL, NULL) == 0) {
+        pid = (pid_t)(long)run_id;
+    }
+    if (pid || (pid = isAppRunning( spAppYouTube, spAppYouTubeMatch ))) {
+        if (child_reaper_stop(pid, gStopGraceMs) == -1) {
+            kill(pid, SIGTERM);
+        }
+        warm_app_stopping( &gYouTubeWarmApp );
+        proc_table_invalidate();
     }
 }
 
@@ -272,6 +267,20 @@ static void setDataDir(char *pData)
     strncat(spDataDir, pData, sizeof(spDataDir) - 1);
 }
 
+/*
+ * Launch an application and hide it right away, so its first launch only
+ * resumes it.
+ */
+static void prelaunchApplication(DIALServer *ds, const char *app_name,
+                                 struct DIALAppCallbacks *callbacks)
+{
+    DIAL_run_t run_id = NULL;
+    if (callbacks->start_cb(ds, app_name, "", NULL, "", &run_id, NULL) == kDIALStatusRunning &&
+        callbacks->hide_cb(ds, app_name, &run_id, NULL) == kDIALStatusHide) {
+        printf("%s prelaunched hidden\n", app_name);
+    }
+}
+
 void runDial(void)
 {
     DIALServer *ds;
@@ -280,6 +289,15 @@ void runDial(void)
         printf("Unable to create DIAL server.\n");
         return;
     }
+    if (spDialDataStore[0] && !open_dial_data_db(spDialDataStore)) {
+        printf("Unable to open DIAL data store, using per application files.\n");
+    }
+    if (!start_child_reaper()) {
+        printf("Unable to start the child reaper.\n");
+    }
+    if (start_proc_watch(1) == kProcWatchNone) {
+        printf("Unable to watch processes, walking /proc.\n");
+    }
     
     struct DIALAppCallbacks cb_nf;
     cb_nf.start_cb = netflix_start;
@@ -299,15 +317,31 @@ void runDial(void)
         DIAL_register_app(ds, "system", &cb_system, NULL, 1, "") == -1)
     {
         printf("Unable to register DIAL applications.\n");
-    } else if (!DIAL_start(ds)) {
-        printf("Unable to start DIAL master listening thread.\n");
     } else {
-        gDialPort = DIAL_get_port(ds);
-        printf("launcher listening on gDialPort %d\n", gDialPort);
-        run_ssdp(gDialPort, spFriendlyName, spModelName, spUuid);
-        
-        DIAL_stop(ds);
+        if (spAppStateShm[0] && !DIAL_publish_app_states(ds, spAppStateShm)) {
+            printf("Unable to publish the application states in shared memory.\n");
+        }
+        if (gWarmApps == WARM_APPS_PRELAUNCH) {
+            prelaunchApplication(ds, "Netflix", &cb_nf);
+            prelaunchApplication(ds, "YouTube", &cb_yt);
+        }
+        if (!DIAL_start(ds)) {
+            printf("Unable to start DIAL master listening thread.\n");
+        } else {
+            gDialPort = DIAL_get_port(ds);
+            printf("launcher listening on gDialPort %d\n", gDialPort);
+            if (spControlSocket[0] && !start_dial_control(ds, spControlSocket)) {
+                printf("Unable to start the control socket.\n");
+            }
+            run_ssdp(gDialPort, spFriendlyName, spModelName, spUuid);
+
+            stop_dial_control();
+            DIAL_stop(ds);
+        }
     }
+    stop_child_reaper();
+    stop_proc_watch();
+    close_dial_data_db();
     free(ds);
 }
 
@@ -345,6 +379,48 @@ static void processOption( int index, char * pOption )
     case 6:
         setValue( pOption, spSleepPassword );
         break;
+    case 7: // DIAL data store
+        setValue( pOption, spDialDataStore );
+        break;
+    case 8: // Process table refresh interval
+        proc_table_set_refresh_interval( (unsigned int) strtoul( pOption, NULL, 10 ) );
+        break;
+    case 9: // Zygote
+        if (strcmp(pOption, "on")==0) {
+            gUseZygote=true;
+        } else if (strcmp(pOption, "off") == 0) {
+            gUseZygote=false;
+        } else {
+            fprintf(stderr, "Option %s is not valid for %s",
+                    pOption, ZYGOTE_OPTION_LONG);
+            exit(1);
+        }
+        break;
+    case 10: // Warm applications
+        if (strcmp(pOption, "on")==0) {
+            gWarmApps=WARM_APPS_ON;
+        } else if (strcmp(pOption, "prelaunch") == 0) {
+            gWarmApps=WARM_APPS_PRELAUNCH;
+        } else if (strcmp(pOption, "off") == 0) {
+            gWarmApps=WARM_APPS_OFF;
+        } else {
+            fprintf(stderr, "Option %s is not valid for %s",
+                    pOption, WARM_APPS_OPTION_LONG);
+            exit(1);
+        }
+        break;
+    case 11: // Resume signal
+        gResumeSignal = atoi( pOption );
+        break;
+    case 12: // Stop grace period
+        gStopGraceMs = (unsigned int) strtoul( pOption, NULL, 10 );
+        break;
+    case 13: // Control socket
+        setValue( pOption, spControlSocket );
+        break;
+    case 14: // Application state shared memory
+        setValue( pOption, spAppStateShm );
+        break;
     default:
         // Should not get here
         fprintf( stderr, "Option %d not valid\n", index);
@@ -354,6 +430,9 @@ static void processOption( int index, char * pOption )
 
 int main(int argc, char* argv[])
 {
+    // Launched applications are reaped by the child reaper thread
+    child_reaper_block_signal();
+
     struct sigaction action;
     action.sa_handler = signalHandler;
     sigemptyset(&action.sa_mask);
@@ -399,7 +478,24 @@ int main(int argc, char* argv[])
             exit(1);
         }
     }
+    // The zygote must be forked before the server creates any thread
+    if (gUseZygote) {
+        const char * const env[] = { spDataDir, NULL };
+        zygote_add_template(spNetflix, NULL, env);
+        zygote_add_template(spAppYouTubeExecutable, NULL, env);
+        if (!start_zygote()) {
+            printf("Unable to start the zygote, launching applications directly\n");
+        }
+    }
+    if (gWarmApps != WARM_APPS_OFF) {
+        warm_app_init(&gNetflixWarmApp, DIAL_DATA_DIR "Netflix.launch", gResumeSignal);
+        warm_app_init(&gYouTubeWarmApp, DIAL_DATA_DIR "YouTube.launch", gResumeSignal);
+    }
     runDial();
+    warm_app_free(&gNetflixWarmApp);
+    warm_app_free(&gYouTubeWarmApp);
+    stop_zygote();
+    proc_table_clear();
 
     return 0;
 }
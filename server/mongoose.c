@@ -44,6 +44,10 @@
 
 #define MAX_REQUEST_SIZE 4096
 #define NUM_THREADS 4
+#define MAX_PENDING_SOCKETS 32  // Accepted, waiting for the request line
+#define RECV_TIMEOUT_MS 500     // Workers give up on a silent client
+#define PENDING_TIMEOUT_MS 500  // So does the master, before classifying it
+#include <sys/eventfd.h>
 #include <sys/wait.h>
 #include <sys/socket.h>
 #include <sys/select.h>
@@ -53,6 +57,7 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <netdb.h>
+#include <poll.h>
 #include <unistd.h>
 #include <pthread.h>
 
@@ -93,6 +98,17 @@ struct socket {
   struct sockaddr_in remote_addr;  // Remote socket address
 };
 
+// Accepted sockets of one lane, see enum mg_lane.
+struct lane {
+  struct socket queue[20];
+  int head;                  // Head of the socket queue
+  int tail;                  // Tail of the socket queue
+  int credit;                // Weighted round-robin credit
+};
+
+// Share of the workers each lane gets when all of them are backlogged.
+static const int lane_weights[MG_NUM_LANES] = { 4, 2, 1 };
+
 struct mg_context {
   volatile int stop_flag;       // Should we stop event loop
   mg_callback_t user_callback;  // User-defined callback function
@@ -105,11 +121,12 @@ struct mg_context {
   pthread_mutex_t mutex;     // Protects (max|num)_threads
   pthread_cond_t  cond;      // Condvar for tracking workers terminations
 
-  struct socket queue[20];   // Accepted sockets
-  volatile int sq_head;      // Head of the socket queue
-  volatile int sq_tail;      // Tail of the socket queue
+  struct lane lanes[MG_NUM_LANES];  // Accepted sockets, protected by mutex
   pthread_cond_t sq_full;    // Singaled when socket is produced
-  pthread_cond_t sq_empty;   // Signaled when socket is consumed
+  int wakeup;                // eventfd waking the master: a full lane has room,
+                             // or stop_flag is set
+  pthread_t master;          // Master thread, joined by mg_stop()
+  mg_classify_t classify;    // Sorts requests into lanes, or NULL
 };
 
 struct mg_connection {
@@ -124,6 +141,7 @@ struct mg_connection {
   int buf_size;               // Buffer size
   int request_len;            // Size of the request + headers in a buffer
   int data_len;               // Total size of data in a buffer
+  int continue_pending;       // Expect: 100-continue not answered yet
 };
 
 static void *call_user(struct mg_connection *conn, enum mg_event event) {
@@ -376,10 +394,35 @@ static int pull(SOCKET sock, char *buf, int len) {
   return nread;
 }
 
+int mg_detach(struct mg_connection *conn) {
+  SOCKET sock = conn->client.sock;
+  conn->client.sock = INVALID_SOCKET;
+  return sock;
+}
+
+// Answer an Expect: 100-continue request, if not done yet. Once a final
+// response is sent instead the client does not send the body.
+static void answer_expect_continue(struct mg_connection *conn, int proceed) {
+  static const char continue_response[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+  if (!conn->continue_pending) {
+    return;
+  }
+  conn->continue_pending = 0;
+  if (proceed) {
+    push(NULL, conn->client.sock, continue_response,
+         (int64_t) sizeof(continue_response) - 1);
+  } else {
+    conn->content_len = conn->consumed_content;
+  }
+}
+
 int mg_read(struct mg_connection *conn, void *buf, size_t len) {
   int n, buffered_len, nread;
   const char *buffered;
 
+  answer_expect_continue(conn, 1);
+
   assert((conn->content_len == -1 && conn->consumed_content == 0) ||
          conn->consumed_content <= conn->content_len);
   DEBUG_TRACE(("%p %zu %" PRId64 " %" PRId64, buf, len,
@@ -427,9 +470,41 @@ int mg_read(struct mg_connection *conn, void *buf, size_t len) {
 }
 
 int mg_write(struct mg_connection *conn, const void *buf, size_t len) {
+  answer_expect_continue(conn, 0);
   return (int) push(NULL, conn->client.sock, (const char *) buf, (int64_t) len);
 }
 
+int mg_writev(struct mg_connection *conn, const struct iovec *iov, int iovcnt) {
+  struct iovec rest[iovcnt];
+  struct msghdr msg;
+  int64_t sent = 0;
+  ssize_t n;
+
+  answer_expect_continue(conn, 0);
+  memcpy(rest, iov, iovcnt * sizeof(*iov));
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = rest;
+  msg.msg_iovlen = iovcnt;
+  while (msg.msg_iovlen > 0) {
+    n = sendmsg(conn->client.sock, &msg, 0);
+    if (n < 0) {
+      break;
+    }
+    sent += n;
+    // Skip what was sent, the kernel may send less than everything.
+    while (msg.msg_iovlen > 0 && (size_t) n >= msg.msg_iov->iov_len) {
+      n -= msg.msg_iov->iov_len;
+      msg.msg_iov++;
+      msg.msg_iovlen--;
+    }
+    if (msg.msg_iovlen > 0) {
+      msg.msg_iov->iov_base = (char *) msg.msg_iov->iov_base + n;
+      msg.msg_iov->iov_len -= n;
+    }
+  }
+  return (int) sent;
+}
+
 int mg_printf(struct mg_connection *conn, const char *fmt, ...) {
   char buf[BUFSIZ];
   int len;
@@ -631,15 +706,12 @@ static int set_ports_option(struct mg_context *ctx, int port) {
   ctx->local_address.sin_port = htons((uint16_t) port);
   ctx->local_address.sin_addr.s_addr = htonl(INADDR_ANY);
 
-  struct timeval tv;
-  tv.tv_sec = 0;
-  tv.tv_usec = 500 * 1000;
-
   // TODO This code calls close(INVALID_SOCKET), even though close expects positive file descriptors.
   // Not sure what the behavior is as a result, might be fine.
-  if ((ctx->local_socket = socket(PF_INET, SOCK_STREAM, 6)) == INVALID_SOCKET ||
+  // Non-blocking, so accept() cannot block the master thread if the
+  // connection it polled goes away before it is accepted.
+  if ((ctx->local_socket = socket(PF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 6)) == INVALID_SOCKET ||
       setsockopt(ctx->local_socket, SOL_SOCKET, SO_REUSEADDR, &reuseaddr, sizeof(reuseaddr)) != 0 ||
-      setsockopt(ctx->local_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0 ||
       bind(ctx->local_socket, (const struct sockaddr *) &ctx->local_address, sock_len) != 0 ||
       // TODO(steineldar): Replace 20 (max socket backlog len in connections).
       listen(ctx->local_socket, 20) != 0) {
@@ -672,6 +744,7 @@ static void reset_per_request_attributes(struct mg_connection *conn) {
   conn->num_bytes_sent = conn->consumed_content = 0;
   conn->content_len = -1;
   conn->request_len = conn->data_len = 0;
+  conn->continue_pending = 0;
 }
 
 static void close_socket_gracefully(SOCKET sock) {
@@ -728,7 +801,7 @@ static void discard_current_request_from_buffer(struct mg_connection *conn) {
 
 static void process_new_connection(struct mg_connection *conn) {
   struct mg_request_info *ri = &conn->request_info;
-  const char *cl;
+  const char *cl, *expect;
 
   reset_per_request_attributes(conn);
 
@@ -763,19 +836,58 @@ static void process_new_connection(struct mg_connection *conn) {
             "Invalid Content-Length header value: [%s]", cl);
         return;
     }
+    // The body is only sent once the handler reads it, unless it already
+    // came along with the headers.
+    expect = get_header(ri, "Expect");
+    conn->continue_pending = expect != NULL &&
+        !mg_strcasecmp(expect, "100-continue") &&
+        !strcmp(ri->http_version, "1.1") &&
+        conn->content_len > 0 && conn->data_len == conn->request_len;
     conn->birth_time = time(NULL);
     handle_request(conn);
     discard_current_request_from_buffer(conn);
   }
 }
 
+static int lane_length(const struct lane *lane) {
+  return lane->head - lane->tail;
+}
+
+// Pick the lane to serve next among the non-empty ones with a smooth
+// weighted round-robin, so no lane waits more than a few turns however
+// long the other ones are. Return -1 if all lanes are empty.
+static int pick_lane(struct mg_context *ctx) {
+  int i, picked = -1, total = 0;
+
+  for (i = 0; i < MG_NUM_LANES; i++) {
+    struct lane *lane = &ctx->lanes[i];
+    if (lane_length(lane) == 0) {
+      lane->credit = 0;
+    } else {
+      lane->credit += lane_weights[i];
+      total += lane_weights[i];
+      if (picked == -1 || lane->credit > ctx->lanes[picked].credit) {
+        picked = i;
+      }
+    }
+  }
+  if (picked != -1) {
+    ctx->lanes[picked].credit -= total;
+  }
+  return picked;
+}
+
 // Worker threads take accepted socket from the queue
 static int consume_socket(struct mg_context *ctx, struct socket *sp) {
+  struct lane *lane;
+  int picked;
+  uint64_t one = 1;
+
   (void) pthread_mutex_lock(&ctx->mutex);
   DEBUG_TRACE(("going idle"));
 
   // If the queue is empty, wait. We're idle at this point.
-  while (ctx->sq_head == ctx->sq_tail && ctx->stop_flag == 0) {
+  while ((picked = pick_lane(ctx)) == -1 && ctx->stop_flag == 0) {
     pthread_cond_wait(&ctx->sq_full, &ctx->mutex);
   }
   // Master thread could wake us up without putting a socket.
@@ -784,20 +896,24 @@ static int consume_socket(struct mg_context *ctx, struct socket *sp) {
     (void) pthread_mutex_unlock(&ctx->mutex);
     return 0;
   }
-  assert(ctx->sq_head > ctx->sq_tail);
+  lane = &ctx->lanes[picked];
+
+  // The master thread holds on to sockets for a full lane.
+  if (lane_length(lane) == (int) ARRAY_SIZE(lane->queue)) {
+    (void) write(ctx->wakeup, &one, sizeof(one));
+  }
 
   // Copy socket from the queue and increment tail
-  *sp = ctx->queue[ctx->sq_tail % ARRAY_SIZE(ctx->queue)];
-  ctx->sq_tail++;
-  DEBUG_TRACE(("grabbed socket %d, going busy", sp->sock));
+  *sp = lane->queue[lane->tail % ARRAY_SIZE(lane->queue)];
+  lane->tail++;
+  DEBUG_TRACE(("grabbed socket %d from lane %d, going busy", sp->sock, picked));
 
   // Wrap pointers if needed
-  while (ctx->sq_tail > (int) ARRAY_SIZE(ctx->queue)) {
-    ctx->sq_tail -= ARRAY_SIZE(ctx->queue);
-    ctx->sq_head -= ARRAY_SIZE(ctx->queue);
+  while (lane->tail > (int) ARRAY_SIZE(lane->queue)) {
+    lane->tail -= ARRAY_SIZE(lane->queue);
+    lane->head -= ARRAY_SIZE(lane->queue);
   }
 
-  (void) pthread_cond_signal(&ctx->sq_empty);
   (void) pthread_mutex_unlock(&ctx->mutex);
 
   return 1;
@@ -853,65 +969,179 @@ static void worker_thread(struct mg_context *ctx) {
   DEBUG_TRACE(("exiting"));
 }
 
+// An accepted socket the master thread has not queued yet.
+struct pending_socket {
+  struct socket socket;
+  int lane;             // -1 until the request line is in
+  int64_t deadline_ms;  // when it is closed if still unclassified
+};
+
+static int64_t monotonic_ms(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
 /**
- * Copy an accepted socket onto the queue. Blocks if the queue is full. This
+ * Sort an accepted socket into a lane from the request line, without
+ * consuming it. This function is called from the master thread once the
+ * socket is readable.
+ *
+ * @param ctx Mongoose context.
+ * @param sock the socket.
+ * @return the lane.
+ */
+static int classify_socket(struct mg_context *ctx, SOCKET sock) {
+  char buf[256], *uri, *end;
+  int n, lane;
+
+  n = recv(sock, buf, sizeof(buf) - 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n <= 0) {
+    return MG_LANE_QUERY;  // Closed, let a worker clean up
+  }
+  buf[n] = '\0';
+
+  // Only the method and the path are needed, not the full request.
+  if ((uri = strchr(buf, ' ')) == NULL) {
+    return MG_LANE_QUERY;
+  }
+  *uri++ = '\0';
+  end = uri + strcspn(uri, " ?\r\n");
+  if (*end == '\0') {
+    return MG_LANE_QUERY;  // Request line longer than what we looked at
+  }
+  *end = '\0';
+  lane = __atomic_load_n(&ctx->classify, __ATOMIC_ACQUIRE)(buf, uri);
+  return lane >= 0 && lane < MG_NUM_LANES ? lane : MG_LANE_QUERY;
+}
+
+/**
+ * Copy the classified pending sockets onto their lanes, in the order they
+ * were accepted. Sockets for a full lane are kept until it has room. This
  * function is called from the master thread.
  *
  * @param ctx Mongoose context.
- * @param sp the socket.
+ * @param pending the pending sockets, compacted on return.
+ * @param num_pending the number of pending sockets, updated on return.
  * @return true if successful, false if there was a mutex error.
  */
-static int produce_socket(struct mg_context *ctx, const struct socket *sp) {
+static int produce_sockets(struct mg_context *ctx, struct pending_socket *pending,
+                           int *num_pending) {
+  int i, kept = 0;
+
   if (pthread_mutex_lock(&ctx->mutex) != 0) {
     return 0;
   };
 
-  // If the queue is full, wait
-  while (ctx->sq_head - ctx->sq_tail >= (int) ARRAY_SIZE(ctx->queue)) {
-      if (pthread_cond_wait(&ctx->sq_empty, &ctx->mutex) != 0) {
-          (void) pthread_mutex_unlock(&ctx->mutex);
-          return 0;
-      };
-  }
-  assert(ctx->sq_head - ctx->sq_tail < (int) ARRAY_SIZE(ctx->queue));
+  for (i = 0; i < *num_pending; i++) {
+    struct lane *lane = pending[i].lane >= 0 ? &ctx->lanes[pending[i].lane] : NULL;
+    if (lane == NULL || lane_length(lane) >= (int) ARRAY_SIZE(lane->queue)) {
+      pending[kept++] = pending[i];
+      continue;
+    }
+
+    // Copy socket to the queue and increment head
+    lane->queue[lane->head % ARRAY_SIZE(lane->queue)] = pending[i].socket;
+    lane->head++;
+    DEBUG_TRACE(("queued socket %d on lane %d", pending[i].socket.sock, pending[i].lane));
 
-  // Copy socket to the queue and increment head
-  ctx->queue[ctx->sq_head % ARRAY_SIZE(ctx->queue)] = *sp;
-  ctx->sq_head++;
-  DEBUG_TRACE(("queued socket %d", sp->sock));
+    // Nothing to do if there is an error on signal.
+    (void) pthread_cond_signal(&ctx->sq_full);
+  }
+  *num_pending = kept;
 
-  // Nothing to do if there is an error on signal. But if we fail to unlock
-  // then we're in a bad state.
-  (void) pthread_cond_signal(&ctx->sq_full);
+  // If we fail to unlock then we're in a bad state.
   return (pthread_mutex_unlock(&ctx->mutex) == 0);
 }
 
 
 static void master_thread(struct mg_context *ctx) {
+  struct pending_socket pending[MAX_PENDING_SOCKETS];
+  struct pollfd fds[2 + MAX_PENDING_SOCKETS];
   struct socket accepted;
+  int i, kept, timeout, num_pending = 0;
+  int64_t now;
+  uint64_t count;
 
   socklen_t sock_len = sizeof(accepted.local_addr);
   memcpy(&accepted.local_addr, &ctx->local_address, sock_len);
 
   while (ctx->stop_flag == 0) {
-    memset(&accepted.remote_addr, 0, sock_len);
-
-    accepted.sock = accept(ctx->local_socket,
-        (struct sockaddr *) &accepted.remote_addr, &sock_len);
-
-    if (accepted.sock != INVALID_SOCKET) {
-      // Put accepted socket structure into the queue.
-      DEBUG_TRACE(("accepted socket %d", accepted.sock));
-      // If the socket fails, trigger stop and try to exit gracefully.
-      if (!produce_socket(ctx, &accepted)) {
-        ctx->stop_flag = 1;
-      };
+    // Stop accepting while too many connections are pending, the kernel
+    // backlog holds them meanwhile.
+    fds[0].fd = ctx->local_socket;
+    fds[0].events = num_pending < MAX_PENDING_SOCKETS ? POLLIN : 0;
+    fds[1].fd = ctx->wakeup;
+    fds[1].events = POLLIN;
+    // No timeout unless a connection is waited on: an idle server does not
+    // wake up until mg_stop().
+    timeout = -1;
+    now = monotonic_ms();
+    for (i = 0; i < num_pending; i++) {
+      fds[2 + i].fd = pending[i].lane < 0 ? pending[i].socket.sock : -1;
+      fds[2 + i].events = POLLIN;
+      if (pending[i].lane < 0 && (timeout == -1 ||
+          pending[i].deadline_ms - now < timeout)) {
+        timeout = pending[i].deadline_ms > now ? (int) (pending[i].deadline_ms - now) : 0;
+      }
+    }
+    if (poll(fds, 2 + num_pending, timeout) < 0) {
+      continue;
+    }
+    if (fds[1].revents & POLLIN) {
+      (void) read(ctx->wakeup, &count, sizeof(count));
+    }
+
+    // Classify the connections whose request line is in, and close the ones
+    // that sent nothing in time so they cannot keep others from being
+    // accepted.
+    now = monotonic_ms();
+    for (i = 0, kept = 0; i < num_pending; i++) {
+      if (fds[2 + i].revents != 0) {
+        pending[i].lane = classify_socket(ctx, pending[i].socket.sock);
+      } else if (pending[i].lane < 0 && pending[i].deadline_ms <= now) {
+        DEBUG_TRACE(("closing silent socket %d", pending[i].socket.sock));
+        (void) close(pending[i].socket.sock);
+        continue;
+      }
+      pending[kept++] = pending[i];
+    }
+    num_pending = kept;
+
+    if (fds[0].revents & POLLIN) {
+      memset(&accepted.remote_addr, 0, sock_len);
+
+      // Launched applications must not inherit the connection.
+      accepted.sock = accept4(ctx->local_socket,
+          (struct sockaddr *) &accepted.remote_addr, &sock_len, SOCK_CLOEXEC);
+
+      if (accepted.sock != INVALID_SOCKET) {
+        struct timeval tv = { 0, RECV_TIMEOUT_MS * 1000 };
+        DEBUG_TRACE(("accepted socket %d", accepted.sock));
+        // A client that stops sending must not hold a worker forever.
+        (void) setsockopt(accepted.sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        pending[num_pending].socket = accepted;
+        // Without a classifier there is nothing to wait for.
+        pending[num_pending].lane =
+            __atomic_load_n(&ctx->classify, __ATOMIC_ACQUIRE) == NULL ? MG_LANE_QUERY : -1;
+        pending[num_pending].deadline_ms = monotonic_ms() + PENDING_TIMEOUT_MS;
+        num_pending++;
+      }
+    }
+
+    // Put classified socket structures into the queue.
+    // If that fails, trigger stop and try to exit gracefully.
+    if (!produce_sockets(ctx, pending, &num_pending)) {
+      ctx->stop_flag = 1;
     }
   }
   DEBUG_TRACE(("stopping workers"));
 
   // Stop signal received: somebody called mg_stop. Quit.
   close_all_listening_sockets(ctx);
+  for (i = 0; i < num_pending; i++) {
+    (void) close(pending[i].socket.sock);
+  }
 
   // Wakeup workers that are waiting for connections to handle.
   // Nothing we can do if there is an error.
@@ -927,15 +1157,18 @@ static void master_thread(struct mg_context *ctx) {
     (void) pthread_mutex_unlock(&ctx->mutex);
   }
 
-  // All threads exited, no sync is needed. Destroy mutex and condvars
+  // All threads exited, no sync is needed. Close the sockets nobody served,
+  // destroy mutex and condvars.
+  for (i = 0; i < MG_NUM_LANES; i++) {
+    struct lane *lane = &ctx->lanes[i];
+    for (; lane->tail != lane->head; lane->tail++) {
+      (void) close(lane->queue[lane->tail % ARRAY_SIZE(lane->queue)].sock);
+    }
+  }
   (void) pthread_mutex_destroy(&ctx->mutex);
   (void) pthread_cond_destroy(&ctx->cond);
-  (void) pthread_cond_destroy(&ctx->sq_empty);
   (void) pthread_cond_destroy(&ctx->sq_full);
 
-  // Signal mg_stop() that we're done
-  ctx->stop_flag = 2;
-
   DEBUG_TRACE(("exiting"));
 }
 
@@ -945,16 +1178,21 @@ static void free_context(struct mg_context *ctx) {
 }
 
 void mg_stop(struct mg_context *ctx) {
+  uint64_t one = 1;
+
   ctx->stop_flag = 1;
+  (void) write(ctx->wakeup, &one, sizeof(one));
 
-  // Wait until mg_fini() stops
-  while (ctx->stop_flag != 2) {
-    // TODO(steineldar): Avoid busy waiting.
-    (void) sleep(0);
-  }
+  // Wait until the master thread has stopped the workers
+  (void) pthread_join(ctx->master, NULL);
+  (void) close(ctx->wakeup);
   free_context(ctx);
 }
 
+void mg_set_classifier(struct mg_context *ctx, mg_classify_t classify) {
+  __atomic_store_n(&ctx->classify, classify, __ATOMIC_RELEASE);
+}
+
 struct mg_context *mg_start(mg_callback_t user_callback, void *user_data, int port) {
   struct mg_context *ctx;
   int retval;
@@ -979,16 +1217,18 @@ struct mg_context *mg_start(mg_callback_t user_callback, void *user_data, int po
   };
   if (pthread_mutex_init(&ctx->mutex, NULL) != 0 ||
       pthread_cond_init(&ctx->cond, NULL) != 0 ||
-      pthread_cond_init(&ctx->sq_empty, NULL) != 0 ||
-      pthread_cond_init(&ctx->sq_full, NULL) != 0)
+      pthread_cond_init(&ctx->sq_full, NULL) != 0 ||
+      (ctx->wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1)
   {
     free_context(ctx);
     return NULL;
   };
 
-  // Start master (listening) thread
-  retval = start_thread(ctx, (mg_thread_func_t) master_thread, ctx);
+  // Start master (listening) thread, joined by mg_stop()
+  retval = pthread_create(&ctx->master, NULL, (mg_thread_func_t) master_thread, ctx);
   if (retval != 0) {
+    cry(fc(ctx), "%s: %s", __func__, strerror(retval));
+    (void) close(ctx->wakeup);
     free_context(ctx);
     return NULL;
   }
@@ -33,6 +33,7 @@ extern "C" {
 #endif // __cplusplus
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
 
@@ -87,6 +88,27 @@ typedef void * (*mg_callback_t)(enum mg_event event,
                                 const struct mg_request_info *request_info);
 
 
+// Lanes requests are queued on until a worker thread is free. Workers serve
+// the lanes with a weighted round-robin, so a flood of requests on one lane
+// only delays the others by a few requests.
+enum mg_lane {
+  MG_LANE_CONTROL,   // Requests a user waits on, served first
+  MG_LANE_QUERY,     // Polling, and requests that are not classified
+  MG_LANE_INTERNAL,  // Requests from other local components
+  MG_NUM_LANES
+};
+
+// Prototype for the function sorting requests into lanes.
+//
+// Parameters:
+//   method: the request method, e.g. "GET".
+//   uri: the request path, not URL-decoded and without the query string.
+//
+// Return:
+//   the request lane.
+typedef int (*mg_classify_t)(const char *method, const char *uri);
+
+
 // Start web server.
 //
 // Parameters:
@@ -111,10 +133,22 @@ struct mg_context *mg_start(mg_callback_t callback, void *user_data, int port);
 void mg_stop(struct mg_context *);
 
 
+// Sort requests into lanes from their request line, before they are read.
+// Without a classifier all requests are served in order on one lane.
+void mg_set_classifier(struct mg_context *, mg_classify_t classify);
+
+
 // Send data to the client.
 int mg_write(struct mg_connection *, const void *buf, size_t len);
 
 
+// Send several buffers to the client with a single system call when possible.
+//
+// Return:
+//   the number of bytes sent.
+int mg_writev(struct mg_connection *, const struct iovec *iov, int iovcnt);
+
+
 // Send data to the browser using printf() semantics.
 //
 // Works exactly like mg_write(), but allows to do message formatting.
@@ -125,9 +159,22 @@ int mg_printf(struct mg_connection *, const char *fmt, ...);
 
 
 // Read data from the remote end, return number of bytes read.
+//
+// If the client sent "Expect: 100-continue", the first read sends it
+// "100 Continue". A response sent before the first read refuses the body
+// instead, so handlers should check the request before reading it.
 int mg_read(struct mg_connection *, void *buf, size_t len);
 
 
+// Take the connection socket over from Mongoose, e.g. to answer the request
+// later from another thread. Mongoose no longer reads, writes or closes it
+// once the callback returns.
+//
+// Return:
+//   the socket, or -1 if it was already detached.
+int mg_detach(struct mg_connection *);
+
+
 // Get the value of particular HTTP header.
 //
 // This is a helper function. It traverses request_info->http_headers array,
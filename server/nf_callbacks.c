@@ -32,10 +32,15 @@
 #include <regex.h>
 #include "dial_server.h"
 #include "url_lib.h"
+#include "child_reaper.h"
 #include "nf_callbacks.h"
+#include "proc_table.h"
+#include "warm_app.h"
 
 extern char *spAppNetflix;
 extern char spNetflix[];
+extern WarmApp gNetflixWarmApp;
+extern unsigned int gStopGraceMs;
 static char *defaultLaunchParam = "source_type=12";
 
 // Adding 40 bytes for defaultLaunchParam, plus additional characters that
@@ -49,7 +54,8 @@ static char sQueryParam[3 * DIAL_MAX_PAYLOAD + DIAL_MAX_ADDITIONALURL + 40];
 
 int isAppRunning( char *pzName, char *pzCommandPattern );
 int shouldRelaunch(DIALServer *pServer, const char *pAppName, const char *args );
-pid_t runApplication( const char * const args[], DIAL_run_t *run_id );
+pid_t runApplication( DIALServer *ds, const char *app_name,
+                      const char * const args[], DIAL_run_t *run_id );
 
 DIALStatus netflix_start(DIALServer *ds, const char *appname,
                                 const char *payload, const char* query_string,
@@ -97,10 +103,20 @@ DIALStatus netflix_start(DIALServer *ds, const char *appname,
           sQueryParam );
 
     // if its not running, launch it.  The Netflix application should
-    // never be relaunched
+    // never be relaunched, a hidden one is resumed instead
+    const char * const netflix_args[] = {spNetflix, "-Q", sQueryParam, 0};
+    pid_t hiddenPid = warm_app_hidden( &gNetflixWarmApp );
+    if( hiddenPid ){
+        warm_app_resume( &gNetflixWarmApp, netflix_args );
+        *run_id = (DIAL_run_t)(long)hiddenPid;
+        return kDIALStatusRunning;
+    }
     if( !appPid ){
-        const char * const netflix_args[] = {spNetflix, "-Q", sQueryParam, 0};
-        return runApplication( netflix_args, run_id );
+        DIALStatus status = runApplication( ds, appname, netflix_args, run_id );
+        if( status == kDIALStatusRunning ){
+            warm_app_started( &gNetflixWarmApp, (pid_t)(long)*run_id, netflix_args );
+        }
+        return status;
     }
     else return kDIALStatusRunning;
 }
@@ -108,27 +124,52 @@ DIALStatus netflix_start(DIALServer *ds, const char *appname,
 DIALStatus netflix_hide(DIALServer *ds, const char *app_name,
                                DIAL_run_t *run_id, void *callback_data)
 {
-    return (isAppRunning( spAppNetflix, NULL )) ? kDIALStatusRunning : kDIALStatusStopped;
+    // keep the process resident if enabled, suspended
+    pid_t pid = (pid_t)(long)*run_id;
+    if (!pid || child_reaper_exited(pid, NULL, NULL) != 0) {
+        pid = isAppRunning( spAppNetflix, NULL );
+    }
+    if (warm_app_hide( &gNetflixWarmApp, pid )) {
+        *run_id = (DIAL_run_t)(long)pid;
+        return kDIALStatusHide;
+    }
+    return pid ? kDIALStatusRunning : kDIALStatusStopped;
 }
 
 DIALStatus netflix_status(DIALServer *ds, const char *appname,
                                  DIAL_run_t run_id, int* pCanStop, void *callback_data) {
     // Netflix application can stop
     *pCanStop = 1;
-    
-    waitpid((pid_t)(long)run_id, NULL, WNOHANG); // reap child
-    
+
+    if (warm_app_hidden( &gNetflixWarmApp )) {
+        return kDIALStatusHide;
+    }
+    // running for as long as the process we launched has not exited
+    if (run_id && child_reaper_exited((pid_t)(long)run_id, NULL, NULL) == 0) {
+        return kDIALStatusRunning;
+    }
     return isAppRunning( spAppNetflix, NULL ) ? kDIALStatusRunning : kDIALStatusStopped;
 }
 
 void netflix_stop(DIALServer *ds, const char *appname, DIAL_run_t run_id,
                          void *callback_data) {
     int pid;
-    pid = isAppRunning( spAppNetflix, NULL );
+    pid = warm_app_hidden( &gNetflixWarmApp );
+    if( !pid && run_id && child_reaper_exited((pid_t)(long)run_id, NULL, NULL) == 0 ){
+        pid = (pid_t)(long)run_id;
+    }
+    if( !pid ){
+        pid = isAppRunning( spAppNetflix, NULL );
+    }
     if( pid ){
-            printf("Killing pid %d\n", pid);
-            kill((pid_t)pid, SIGTERM);
-            waitpid((pid_t)pid, NULL, 0); // reap child
+            // SIGTERM, escalated to SIGKILL by the reaper after the grace
+            // period; a stop already in progress is left alone
+            printf("Stopping pid %d\n", pid);
+            if (child_reaper_stop((pid_t)pid, gStopGraceMs) == -1) {
+                kill((pid_t)pid, SIGTERM);
+            }
+            warm_app_stopping( &gNetflixWarmApp );
+            proc_table_invalidate();
         }
 }
 
@@ -0,0 +1,541 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "proc_table.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <regex.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PROC_DIR "/proc"
+
+typedef struct {
+    char *exe_name;
+    char *cmdline_pattern;
+    regex_t exe;                // exe_name anchored at the end of the path
+    regex_t cmdline;
+    pid_t pid;                  // first match in the snapshot
+} ProcPattern;
+
+typedef struct {
+    pid_t pid;                  // 0 for an empty slot
+    uint32_t exe_hash;          // of the executable path, 0 if unreadable
+    unsigned long long start_time;  // tells a reused PID apart, 0 if unreadable
+    uint32_t checked;           // patterns the process was matched against
+    uint32_t matches;           // patterns the process matches
+} ProcEntry;
+
+typedef struct {
+    ProcEntry *slots;           // open addressing, power-of-two capacity
+    size_t capacity;
+    size_t count;
+} ProcIndex;
+
+static struct {
+    pthread_mutex_t mutex;
+    unsigned int interval_ms;
+    ProcPattern patterns[PROC_TABLE_MAX_PATTERNS];
+    int pattern_count;
+    ProcIndex index;            // the snapshot
+    ProcIndex scratch;          // the next snapshot, while refreshing
+    int valid;
+    int event_driven;
+    long long refreshed_ms;
+    void (*match_hook)(pid_t pid);
+} gProcs = { PTHREAD_MUTEX_INITIALIZER, PROC_TABLE_REFRESH_MS };
+
+static long long monotonic_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static uint32_t hash_path(const char *path, size_t len) {
+    uint32_t hash = 2166136261u;
+    while (len--) {
+        hash = (hash ^ (unsigned char) *path++) * 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+/**
+ * @return the PID a /proc entry name is made of, or 0 if it is not a PID.
+ */
+static pid_t parse_pid(const char *name) {
+    long pid = 0;
+    if (*name == '\0') {
+        return 0;
+    }
+    for (; *name; name++) {
+        if (*name < '0' || *name > '9' || pid > (INT_MAX - 9) / 10) {
+            return 0;
+        }
+        pid = pid * 10 + (*name - '0');
+    }
+    return (pid_t) pid;
+}
+
+static size_t home_slot(pid_t pid, size_t mask) {
+    return ((uint32_t) pid * 2654435761u) & mask;
+}
+
+static size_t pid_slot(const ProcIndex *index, pid_t pid) {
+    size_t mask = index->capacity - 1;
+    size_t i = home_slot(pid, mask);
+    while (index->slots[i].pid != 0 && index->slots[i].pid != pid) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static const ProcEntry *find_entry(const ProcIndex *index, pid_t pid) {
+    if (index->count == 0) {
+        return NULL;
+    }
+    const ProcEntry *entry = &index->slots[pid_slot(index, pid)];
+    return entry->pid ? entry : NULL;
+}
+
+static int grow_index(ProcIndex *index) {
+    size_t capacity = index->capacity ? index->capacity * 2 : 512;
+    ProcEntry *old = index->slots;
+    size_t old_capacity = index->capacity;
+    ProcEntry *slots = (ProcEntry *) calloc(capacity, sizeof(ProcEntry));
+    if (slots == NULL) {
+        return 0;
+    }
+    index->slots = slots;
+    index->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].pid != 0) {
+            slots[pid_slot(index, old[i].pid)] = old[i];
+        }
+    }
+    free(old);
+    return 1;
+}
+
+static int insert_entry(ProcIndex *index, const ProcEntry *entry) {
+    if ((index->count + 1) * 2 > index->capacity && !grow_index(index)) {
+        return 0;
+    }
+    ProcEntry *slot = &index->slots[pid_slot(index, entry->pid)];
+    if (slot->pid == 0) {
+        index->count++;
+    }
+    *slot = *entry;
+    return 1;
+}
+
+static void remove_entry(ProcIndex *index, pid_t pid) {
+    if (index->count == 0) {
+        return;
+    }
+    size_t mask = index->capacity - 1;
+    size_t hole = pid_slot(index, pid);
+    if (index->slots[hole].pid == 0) {
+        return;
+    }
+    // Move back the following entries that can no longer be reached.
+    for (size_t i = (hole + 1) & mask; index->slots[i].pid != 0; i = (i + 1) & mask) {
+        size_t home = home_slot(index->slots[i].pid, mask);
+        if (hole <= i ? (home <= hole || home > i) : (home <= hole && home > i)) {
+            index->slots[hole] = index->slots[i];
+            hole = i;
+        }
+    }
+    index->slots[hole].pid = 0;
+    index->count--;
+}
+
+/**
+ * Read the command line of a process with its arguments separated by spaces.
+ */
+static int read_cmdline(pid_t pid, char *buffer, size_t size) {
+    char path[32];
+    snprintf(path, sizeof(path), PROC_DIR "/%d/cmdline", (int) pid);
+    FILE *file = fopen(path, "re");
+    if (file == NULL) {
+        return 0;
+    }
+    size_t len = fread(buffer, 1, size - 1, file);
+    fclose(file);
+    while (len > 0 && buffer[len - 1] == '\0') {
+        len--;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (buffer[i] == '\0') {
+            buffer[i] = ' ';
+        }
+    }
+    buffer[len] = '\0';
+    return 1;
+}
+
+/**
+ * Match a process against the patterns it has not been matched against yet.
+ */
+static void classify(ProcEntry *entry, const char *exe, uint32_t registered) {
+    char cmdline[4096];
+    int cmdline_read = 0;
+    for (int i = 0; i < gProcs.pattern_count; i++) {
+        uint32_t bit = 1u << i;
+        const ProcPattern *pattern = &gProcs.patterns[i];
+        if (entry->checked & bit) {
+            continue;
+        }
+        if (entry->exe_hash != 0 && !regexec(&pattern->exe, exe, 0, NULL, 0)) {
+            if (pattern->cmdline_pattern == NULL) {
+                entry->matches |= bit;
+            } else {
+                if (!cmdline_read) {
+                    cmdline_read = read_cmdline(entry->pid, cmdline, sizeof(cmdline)) ? 1 : -1;
+                }
+                if (cmdline_read == 1 && !regexec(&pattern->cmdline, cmdline, 0, NULL, 0)) {
+                    entry->matches |= bit;
+                }
+            }
+        }
+    }
+    entry->checked = registered;
+}
+
+static uint32_t registered_patterns() {
+    return gProcs.pattern_count == 32 ? UINT32_MAX : (1u << gProcs.pattern_count) - 1;
+}
+
+/**
+ * Read the start time of a process, field 22 of /proc/<pid>/stat.
+ *
+ * @return the start time in clock ticks since boot, or 0 if unreadable.
+ */
+static unsigned long long read_start_time(pid_t pid) {
+    char path[32], stat[512];
+    snprintf(path, sizeof(path), PROC_DIR "/%d/stat", (int) pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return 0;
+    }
+    ssize_t len = read(fd, stat, sizeof(stat) - 1);
+    close(fd);
+    if (len <= 0) {
+        return 0;
+    }
+    stat[len] = '\0';
+    // Skip the command name, which may contain spaces, then fields 3 to 21.
+    const char *field = strrchr(stat, ')');
+    for (int i = 2; field != NULL && i < 22; i++) {
+        field = strchr(field + 1, ' ');
+    }
+    return field != NULL ? strtoull(field + 1, NULL, 10) : 0;
+}
+
+/**
+ * Read the executable path and start time of a process and start its entry.
+ */
+static ProcEntry read_entry(pid_t pid, char *exe, size_t size) {
+    char path[32];
+    snprintf(path, sizeof(path), PROC_DIR "/%d/exe", (int) pid);
+    ssize_t len = readlink(path, exe, size - 1);
+    if (len < 0) {
+        len = 0;
+    }
+    exe[len] = '\0';
+    ProcEntry entry = { pid, len ? hash_path(exe, len) : 0, read_start_time(pid), 0, 0 };
+    return entry;
+}
+
+static void set_pattern_pid(int i, pid_t pid) {
+    if (pid != 0 && pid != gProcs.patterns[i].pid && gProcs.match_hook != NULL) {
+        gProcs.match_hook(pid);
+    }
+    gProcs.patterns[i].pid = pid;
+}
+
+/**
+ * Find another match for a pattern whose process exited or no longer matches.
+ */
+static void rematch_pattern(int i) {
+    pid_t pid = 0;
+    for (size_t j = 0; j < gProcs.index.capacity; j++) {
+        const ProcEntry *entry = &gProcs.index.slots[j];
+        if (entry->pid != 0 && (entry->matches & (1u << i)) &&
+            (pid == 0 || entry->pid < pid)) {
+            pid = entry->pid;
+        }
+    }
+    gProcs.patterns[i].pid = 0;
+    set_pattern_pid(i, pid);
+}
+
+/**
+ * Update the matches of the patterns after the entry of a process changed.
+ */
+static void update_patterns(const ProcEntry *entry) {
+    for (int i = 0; i < gProcs.pattern_count; i++) {
+        int matches = (entry->matches >> i) & 1;
+        if (matches && gProcs.patterns[i].pid == 0) {
+            set_pattern_pid(i, entry->pid);
+        } else if (!matches && gProcs.patterns[i].pid == entry->pid) {
+            rematch_pattern(i);
+        }
+    }
+}
+
+static int refresh_locked() {
+    DIR *dir = opendir(PROC_DIR);
+    if (dir == NULL) {
+        printf(PROC_DIR " failed to open\n");
+        return 0;
+    }
+    ProcIndex *next = &gProcs.scratch;
+    if (next->capacity) {
+        memset(next->slots, 0, next->capacity * sizeof(ProcEntry));
+    }
+    next->count = 0;
+    uint32_t registered = registered_patterns();
+    uint32_t found = 0;
+    pid_t first[PROC_TABLE_MAX_PATTERNS] = {0,};
+
+    struct dirent *dirent;
+    int success = 1;
+    while (success && (dirent = readdir(dir)) != NULL) {
+        pid_t pid = parse_pid(dirent->d_name);
+        if (pid == 0) {
+            continue;
+        }
+        char exe[PATH_MAX];
+        ProcEntry entry = read_entry(pid, exe, sizeof(exe));
+
+        // A process keeps its classification until it executes something
+        // else, or exits and its PID is reused.
+        const ProcEntry *known = find_entry(&gProcs.index, pid);
+        if (known != NULL && known->exe_hash == entry.exe_hash &&
+            known->start_time == entry.start_time) {
+            entry = *known;
+        }
+        if (entry.checked != registered) {
+            classify(&entry, exe, registered);
+        }
+        success = insert_entry(next, &entry);
+
+        uint32_t matches = entry.matches & ~found;
+        for (int i = 0; matches; i++, matches >>= 1) {
+            if (matches & 1) {
+                first[i] = pid;
+            }
+        }
+        found |= entry.matches;
+    }
+    closedir(dir);
+
+    if (success) {
+        ProcIndex previous = gProcs.index;
+        gProcs.index = *next;
+        gProcs.scratch = previous;
+        for (int i = 0; i < gProcs.pattern_count; i++) {
+            set_pattern_pid(i, first[i]);
+        }
+    }
+    return success;
+}
+
+static int compile(regex_t *exp, const char *pattern) {
+    int ret = regcomp(exp, pattern, REG_EXTENDED | REG_NOSUB);
+    if (ret) {
+        char errbuf[1024] = {0,};
+        regerror(ret, exp, errbuf, sizeof(errbuf));
+        fprintf(stderr, "regexp error: %s\n", errbuf);
+    }
+    return ret == 0;
+}
+
+static void free_pattern(ProcPattern *pattern) {
+    regfree(&pattern->exe);
+    if (pattern->cmdline_pattern != NULL) {
+        regfree(&pattern->cmdline);
+    }
+    free(pattern->exe_name);
+    free(pattern->cmdline_pattern);
+}
+
+static int same_pattern(const char *a, const char *b) {
+    return a == NULL || b == NULL ? a == b : !strcmp(a, b);
+}
+
+/**
+ * Compile a new pattern, the executable name anchored at the end of the path.
+ */
+static int init_pattern(ProcPattern *pattern, const char *exe_name,
+                        const char *cmdline_pattern) {
+    size_t len = strlen(exe_name);
+    char *anchored = (char *) malloc(len + 2);
+    pattern->exe_name = strdup(exe_name);
+    pattern->cmdline_pattern = cmdline_pattern ? strdup(cmdline_pattern) : NULL;
+    pattern->pid = 0;
+    int success = anchored != NULL && pattern->exe_name != NULL &&
+            (cmdline_pattern == NULL || pattern->cmdline_pattern != NULL);
+    if (success) {
+        memcpy(anchored, exe_name, len);
+        strcpy(anchored + len, "$");
+        success = compile(&pattern->exe, anchored);
+    }
+    if (success && cmdline_pattern != NULL && !compile(&pattern->cmdline, cmdline_pattern)) {
+        regfree(&pattern->exe);
+        success = 0;
+    }
+    free(anchored);
+    if (!success) {
+        free(pattern->exe_name);
+        free(pattern->cmdline_pattern);
+    }
+    return success;
+}
+
+int proc_table_register(const char *exe_name, const char *cmdline_pattern) {
+    int handle = -1;
+    pthread_mutex_lock(&gProcs.mutex);
+    for (int i = 0; i < gProcs.pattern_count && handle == -1; i++) {
+        if (!strcmp(gProcs.patterns[i].exe_name, exe_name) &&
+            same_pattern(gProcs.patterns[i].cmdline_pattern, cmdline_pattern)) {
+            handle = i;
+        }
+    }
+    if (handle == -1 && gProcs.pattern_count < PROC_TABLE_MAX_PATTERNS &&
+        init_pattern(&gProcs.patterns[gProcs.pattern_count], exe_name, cmdline_pattern)) {
+        handle = gProcs.pattern_count++;
+        gProcs.valid = 0;       // the snapshot has not been matched against it
+    }
+    pthread_mutex_unlock(&gProcs.mutex);
+    return handle;
+}
+
+pid_t proc_table_find(int handle) {
+    pid_t pid = 0;
+    pthread_mutex_lock(&gProcs.mutex);
+    if (handle >= 0 && handle < gProcs.pattern_count) {
+        long long now = monotonic_ms();
+        if (!gProcs.valid ||
+            (!gProcs.event_driven && now - gProcs.refreshed_ms >= gProcs.interval_ms)) {
+            gProcs.valid = refresh_locked();
+            gProcs.refreshed_ms = now;
+        }
+        if (gProcs.valid) {
+            pid = gProcs.patterns[handle].pid;
+        }
+    }
+    pthread_mutex_unlock(&gProcs.mutex);
+    return pid;
+}
+
+void proc_table_set_refresh_interval(unsigned int interval_ms) {
+    pthread_mutex_lock(&gProcs.mutex);
+    gProcs.interval_ms = interval_ms;
+    pthread_mutex_unlock(&gProcs.mutex);
+}
+
+void proc_table_invalidate() {
+    pthread_mutex_lock(&gProcs.mutex);
+    gProcs.valid = 0;
+    pthread_mutex_unlock(&gProcs.mutex);
+}
+
+void proc_table_clear() {
+    pthread_mutex_lock(&gProcs.mutex);
+    for (int i = 0; i < gProcs.pattern_count; i++) {
+        free_pattern(&gProcs.patterns[i]);
+    }
+    gProcs.pattern_count = 0;
+    gProcs.match_hook = NULL;
+    free(gProcs.index.slots);
+    free(gProcs.scratch.slots);
+    memset(&gProcs.index, 0, sizeof(gProcs.index));
+    memset(&gProcs.scratch, 0, sizeof(gProcs.scratch));
+    gProcs.valid = 0;
+    pthread_mutex_unlock(&gProcs.mutex);
+}
+
+void proc_table_set_event_driven(int event_driven) {
+    pthread_mutex_lock(&gProcs.mutex);
+    gProcs.event_driven = event_driven;
+    pthread_mutex_unlock(&gProcs.mutex);
+}
+
+void proc_table_fork(pid_t parent, pid_t child) {
+    pthread_mutex_lock(&gProcs.mutex);
+    const ProcEntry *known;
+    if (gProcs.valid && (known = find_entry(&gProcs.index, parent)) != NULL) {
+        ProcEntry entry = *known;
+        entry.pid = child;
+        entry.start_time = read_start_time(child);
+        if (insert_entry(&gProcs.index, &entry)) {
+            update_patterns(&entry);
+        } else {
+            gProcs.valid = 0;
+        }
+    }
+    pthread_mutex_unlock(&gProcs.mutex);
+}
+
+void proc_table_exec(pid_t pid) {
+    pthread_mutex_lock(&gProcs.mutex);
+    if (gProcs.valid) {
+        char exe[PATH_MAX];
+        ProcEntry entry = read_entry(pid, exe, sizeof(exe));
+        classify(&entry, exe, registered_patterns());
+        if (insert_entry(&gProcs.index, &entry)) {
+            update_patterns(&entry);
+        } else {
+            gProcs.valid = 0;
+        }
+    }
+    pthread_mutex_unlock(&gProcs.mutex);
+}
+
+void proc_table_exit(pid_t pid) {
+    pthread_mutex_lock(&gProcs.mutex);
+    if (gProcs.valid) {
+        remove_entry(&gProcs.index, pid);
+        for (int i = 0; i < gProcs.pattern_count; i++) {
+            if (gProcs.patterns[i].pid == pid) {
+                rematch_pattern(i);
+            }
+        }
+    }
+    pthread_mutex_unlock(&gProcs.mutex);
+}
+
+void proc_table_set_match_hook(void (*hook)(pid_t pid)) {
+    pthread_mutex_lock(&gProcs.mutex);
+    gProcs.match_hook = hook;
+    pthread_mutex_unlock(&gProcs.mutex);
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Shared snapshot of the running processes.
+ *
+ * Callers register the processes they look for once, which compiles their
+ * patterns, and then look them up by handle. The snapshot is refreshed from
+ * /proc at most once per refresh interval; processes already classified in
+ * the previous snapshot are not matched against the patterns again unless
+ * their executable changed.
+ *
+ * A process watcher (see proc_watch.h) can keep the snapshot up to date with
+ * the events of the processes instead.
+ */
+
+#ifndef SRC_SERVER_PROC_TABLE_H_
+#define SRC_SERVER_PROC_TABLE_H_
+
+#include <sys/types.h>
+
+/*
+ * Default minimum time between two refreshes of the snapshot, and maximum
+ * number of registered patterns.
+ */
+#define PROC_TABLE_REFRESH_MS (250)
+#define PROC_TABLE_MAX_PATTERNS (32)
+
+/**
+ * Register the processes to look for. Registering the same pattern again
+ * returns the same handle.
+ *
+ * @param exe_name end of the path of the process executable, an extended
+ *        regular expression.
+ * @param cmdline_pattern extended regular expression that the command line, with
+ *        its arguments separated by spaces, must match, or NULL.
+ * @return the handle of the pattern, or -1 if a pattern does not compile or
+ *         on out-of-memory or if PROC_TABLE_MAX_PATTERNS are registered.
+ */
+int proc_table_register(const char *exe_name, const char *cmdline_pattern);
+
+/**
+ * Find a running process matching a registered pattern, refreshing the
+ * snapshot first if it is older than the refresh interval.
+ *
+ * @param handle handle returned by proc_table_register().
+ * @return the PID of the first matching process in /proc, or 0 if there is
+ *         none, the handle is not valid or /proc cannot be read.
+ */
+pid_t proc_table_find(int handle);
+
+/**
+ * Set the minimum time between two refreshes of the snapshot, 0 to refresh
+ * it on every lookup. Defaults to PROC_TABLE_REFRESH_MS.
+ *
+ * @param interval_ms refresh interval in milliseconds.
+ */
+void proc_table_set_refresh_interval(unsigned int interval_ms);
+
+/**
+ * Refresh the snapshot on the next lookup, e.g. after starting or stopping a
+ * process.
+ */
+void proc_table_invalidate();
+
+/**
+ * Unregister all patterns and free the snapshot.
+ */
+void proc_table_clear();
+
+/**
+ * Stop refreshing the snapshot periodically, because every fork, exec and exit
+ * is reported with the functions below. /proc is still walked on the first
+ * lookup and after proc_table_invalidate().
+ *
+ * @param event_driven non-0 to only refresh the snapshot when invalidated.
+ */
+void proc_table_set_event_driven(int event_driven);
+
+/**
+ * Report that a process forked a new process, which runs the same program.
+ *
+ * @param parent PID of the parent process.
+ * @param child PID of the new process.
+ */
+void proc_table_fork(pid_t parent, pid_t child);
+
+/**
+ * Report that a process executed a new program.
+ *
+ * @param pid PID of the process.
+ */
+void proc_table_exec(pid_t pid);
+
+/**
+ * Report that a process exited.
+ *
+ * @param pid PID of the process.
+ */
+void proc_table_exit(pid_t pid);
+
+/**
+ * Set the function called with the PID of each process that becomes the match
+ * of a pattern, e.g. to watch for its exit. It is called with the process
+ * table locked and must not call it.
+ *
+ * @param hook the function, NULL for none.
+ */
+void proc_table_set_match_hook(void (*hook)(pid_t pid));
+
+#endif /* SRC_SERVER_PROC_TABLE_H_ */
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "proc_watch.h"
+
+#include <errno.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "proc_table.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+typedef struct {
+    pid_t pid;
+    int fd;                 // pidfd, -1 until opened by the thread
+} WatchedProc;
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    ProcWatchMode mode;
+    int stopping;
+    int wake_fd;            // eventfd
+    int netlink_fd;
+    WatchedProc *procs;     // exits watched through pidfds
+    size_t count;
+    size_t capacity;
+} gWatch = { PTHREAD_MUTEX_INITIALIZER, 0, kProcWatchNone, 0, -1, -1 };
+
+static void wake_watcher() {
+    uint64_t one = 1;
+    if (write(gWatch.wake_fd, &one, sizeof(one)) != sizeof(one)) {
+        // Already woken up.
+    }
+}
+
+/**
+ * Called by the process table with a process to watch for the exit of.
+ */
+static void watch_pid(pid_t pid) {
+    pthread_mutex_lock(&gWatch.mutex);
+    int known = 0;
+    for (size_t i = 0; i < gWatch.count && !known; i++) {
+        known = gWatch.procs[i].pid == pid;
+    }
+    if (!known && gWatch.count == gWatch.capacity) {
+        size_t capacity = gWatch.capacity ? gWatch.capacity * 2 : 8;
+        WatchedProc *procs = (WatchedProc *) realloc(gWatch.procs, capacity * sizeof(WatchedProc));
+        if (procs != NULL) {
+            gWatch.procs = procs;
+            gWatch.capacity = capacity;
+        }
+    }
+    if (!known && gWatch.count < gWatch.capacity) {
+        gWatch.procs[gWatch.count].pid = pid;
+        gWatch.procs[gWatch.count].fd = -1;
+        gWatch.count++;
+        wake_watcher();
+    }
+    pthread_mutex_unlock(&gWatch.mutex);
+}
+
+static int open_connector() {
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd == -1) {
+        return -1;
+    }
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK, .nl_groups = CN_IDX_PROC };
+    struct __attribute__((packed)) {
+        struct nlmsghdr header;
+        struct cn_msg msg;
+        enum proc_cn_mcast_op op;
+    } request;
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = sizeof(request);
+    request.header.nlmsg_type = NLMSG_DONE;
+    request.msg.id.idx = CN_IDX_PROC;
+    request.msg.id.val = CN_VAL_PROC;
+    request.msg.len = sizeof(request.op);
+    request.op = PROC_CN_MCAST_LISTEN;
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+        send(fd, &request, sizeof(request), 0) != sizeof(request)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void handle_event(const struct proc_event *event) {
+    switch (event->what) {
+    case PROC_EVENT_FORK:
+        if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid) {
+            proc_table_fork(event->event_data.fork.parent_tgid,
+                            event->event_data.fork.child_tgid);
+        }
+        break;
+    case PROC_EVENT_EXEC:
+        proc_table_exec(event->event_data.exec.process_tgid);
+        break;
+    case PROC_EVENT_EXIT:
+        if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+            proc_table_exit(event->event_data.exit.process_tgid);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void read_events() {
+    char buffer[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+    struct sockaddr_nl from;
+    socklen_t from_len = sizeof(from);
+    ssize_t len = recvfrom(gWatch.netlink_fd, buffer, sizeof(buffer), MSG_DONTWAIT,
+                           (struct sockaddr *) &from, &from_len);
+    if (len < 0) {
+        if (errno == ENOBUFS) {
+            // Events were dropped, walk /proc again.
+            proc_table_invalidate();
+        }
+        return;
+    }
+    if (from.nl_pid != 0) {
+        return;     // not from the kernel
+    }
+    for (struct nlmsghdr *header = (struct nlmsghdr *) buffer; NLMSG_OK(header, len);
+         header = NLMSG_NEXT(header, len)) {
+        if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_OVERRUN) {
+            proc_table_invalidate();
+        } else if (header->nlmsg_type != NLMSG_NOOP &&
+                   header->nlmsg_len >= NLMSG_LENGTH(sizeof(struct cn_msg))) {
+            const struct cn_msg *msg = (const struct cn_msg *) NLMSG_DATA(header);
+            if (msg->id.idx == CN_IDX_PROC && msg->id.val == CN_VAL_PROC &&
+                msg->len >= sizeof(struct proc_event)) {
+                handle_event((const struct proc_event *) msg->data);
+            }
+        }
+    }
+}
+
+/**
+ * Open the pidfds of the processes added since the last call, and report the
+ * exit of the ones that are already gone.
+ */
+static void open_pidfds() {
+    pthread_mutex_lock(&gWatch.mutex);
+    for (size_t i = 0; i < gWatch.count;) {
+        WatchedProc *proc = &gWatch.procs[i];
+        if (proc->fd == -1) {
+            proc->fd = (int) syscall(SYS_pidfd_open, proc->pid, 0);
+        }
+        if (proc->fd == -1) {
+            pid_t pid = proc->pid;
+            gWatch.procs[i] = gWatch.procs[--gWatch.count];
+            pthread_mutex_unlock(&gWatch.mutex);
+            proc_table_exit(pid);
+            pthread_mutex_lock(&gWatch.mutex);
+        } else {
+            i++;
+        }
+    }
+    pthread_mutex_unlock(&gWatch.mutex);
+}
+
+/**
+ * Report the exit of the watched process with the pidfd fd.
+ */
+static void exited(int fd) {
+    pid_t pid = 0;
+    pthread_mutex_lock(&gWatch.mutex);
+    for (size_t i = 0; i < gWatch.count; i++) {
+        if (gWatch.procs[i].fd == fd) {
+            pid = gWatch.procs[i].pid;
+            gWatch.procs[i] = gWatch.procs[--gWatch.count];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&gWatch.mutex);
+    close(fd);
+    if (pid != 0) {
+        proc_table_exit(pid);
+    }
+}
+
+static void *watch_thread(void *arg) {
+    struct pollfd *fds = NULL;
+    size_t fds_capacity = 0;
+    for (;;) {
+        open_pidfds();
+
+        pthread_mutex_lock(&gWatch.mutex);
+        if (gWatch.stopping) {
+            pthread_mutex_unlock(&gWatch.mutex);
+            break;
+        }
+        size_t count = 0, needed = gWatch.count + 2;
+        if (needed > fds_capacity) {
+            struct pollfd *grown = (struct pollfd *) realloc(fds, needed * sizeof(struct pollfd));
+            if (grown != NULL) {
+                fds = grown;
+                fds_capacity = needed;
+            }
+        }
+        if (fds != NULL) {
+            fds[count++] = (struct pollfd) { gWatch.wake_fd, POLLIN, 0 };
+            if (gWatch.netlink_fd != -1) {
+                fds[count++] = (struct pollfd) { gWatch.netlink_fd, POLLIN, 0 };
+            }
+            for (size_t i = 0; i < gWatch.count && count < fds_capacity; i++) {
+                fds[count++] = (struct pollfd) { gWatch.procs[i].fd, POLLIN, 0 };
+            }
+        }
+        pthread_mutex_unlock(&gWatch.mutex);
+        if (count == 0) {
+            break;  // out-of-memory
+        }
+
+        if (poll(fds, count, -1) < 0) {
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (!fds[i].revents) {
+                continue;
+            }
+            if (fds[i].fd == gWatch.wake_fd) {
+                uint64_t value;
+                if (read(gWatch.wake_fd, &value, sizeof(value)) != sizeof(value)) {
+                    // Spurious wake up.
+                }
+            } else if (fds[i].fd == gWatch.netlink_fd) {
+                read_events();
+            } else {
+                exited(fds[i].fd);
+            }
+        }
+    }
+    free(fds);
+    return NULL;
+}
+
+ProcWatchMode start_proc_watch(int use_connector) {
+    if (gWatch.mode != kProcWatchNone) {
+        return gWatch.mode;
+    }
+    gWatch.wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (gWatch.wake_fd == -1) {
+        return kProcWatchNone;
+    }
+    gWatch.netlink_fd = use_connector ? open_connector() : -1;
+    gWatch.mode = gWatch.netlink_fd != -1 ? kProcWatchEvents : kProcWatchExits;
+    gWatch.stopping = 0;
+
+    // The thread must not take signals meant for the rest of the server.
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    int started = pthread_create(&gWatch.thread, NULL, watch_thread, NULL) == 0;
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (!started) {
+        if (gWatch.netlink_fd != -1) {
+            close(gWatch.netlink_fd);
+        }
+        close(gWatch.wake_fd);
+        gWatch.netlink_fd = gWatch.wake_fd = -1;
+        gWatch.mode = kProcWatchNone;
+        return kProcWatchNone;
+    }
+
+    if (gWatch.mode == kProcWatchEvents) {
+        proc_table_set_event_driven(1);
+    } else {
+        proc_table_set_match_hook(watch_pid);
+    }
+    // Events before the subscription are lost: walk /proc after it.
+    proc_table_invalidate();
+    return gWatch.mode;
+}
+
+void stop_proc_watch() {
+    if (gWatch.mode == kProcWatchNone) {
+        return;
+    }
+    proc_table_set_event_driven(0);
+    proc_table_set_match_hook(NULL);
+    pthread_mutex_lock(&gWatch.mutex);
+    gWatch.stopping = 1;
+    wake_watcher();
+    pthread_mutex_unlock(&gWatch.mutex);
+    pthread_join(gWatch.thread, NULL);
+
+    for (size_t i = 0; i < gWatch.count; i++) {
+        if (gWatch.procs[i].fd != -1) {
+            close(gWatch.procs[i].fd);
+        }
+    }
+    free(gWatch.procs);
+    gWatch.procs = NULL;
+    gWatch.count = gWatch.capacity = 0;
+    if (gWatch.netlink_fd != -1) {
+        close(gWatch.netlink_fd);
+    }
+    close(gWatch.wake_fd);
+    gWatch.netlink_fd = gWatch.wake_fd = -1;
+    gWatch.mode = kProcWatchNone;
+    // Changes missed from now on are caught up with by walking /proc.
+    proc_table_invalidate();
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Keeps the process table (see proc_table.h) up to date from the events of
+ * the processes, so looking up a running application does not walk /proc.
+ *
+ * A background thread subscribes to the fork, exec and exit events of every
+ * process through the netlink process connector, which requires the
+ * CAP_NET_ADMIN capability. Without it the thread only watches for the exit
+ * of the processes matching a registered pattern through process file
+ * descriptors, and the process table keeps walking /proc periodically to find
+ * new ones.
+ */
+
+#ifndef SRC_SERVER_PROC_WATCH_H_
+#define SRC_SERVER_PROC_WATCH_H_
+
+typedef enum {
+    kProcWatchNone,         // not watching
+    kProcWatchExits,        // exits of the matching processes only
+    kProcWatchEvents        // fork, exec and exit of every process
+} ProcWatchMode;
+
+/**
+ * Start the process watcher thread.
+ *
+ * @param use_connector 0 to only watch for exits even if the process
+ *        connector is available.
+ * @return how processes are watched, kProcWatchNone on error.
+ */
+ProcWatchMode start_proc_watch(int use_connector);
+
+/**
+ * Stop the process watcher thread. The process table goes back to walking
+ * /proc periodically.
+ */
+void stop_proc_watch();
+
+#endif /* SRC_SERVER_PROC_WATCH_H_ */
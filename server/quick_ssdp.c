@@ -126,7 +126,7 @@ static char * get_local_address() {
     char buf[4096];
     char * hw_addr = NULL;
     int s, i;
-    if (-1 == (s = socket(AF_INET, SOCK_DGRAM, 0))) {
+    if (-1 == (s = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0))) {
         perror("socket");
         exit(1);
     }
@@ -188,7 +188,7 @@ static void handle_mcast(char *hw_addr) {
         snprintf(wakeup_buf, sizeof(wakeup_buf), wakeup_header, hw_addr, wakeup_timeout);
     }
     send_size = snprintf(send_buf, sizeof(send_buf), ssdp_reply, ip_addr, my_port, uuid, wakeup_buf);
-    if (-1 == (s = socket(AF_INET, SOCK_DGRAM, 0))) {
+    if (-1 == (s = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0))) {
         perror("socket");
         exit(1);
     }
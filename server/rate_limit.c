@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Token buckets in a set-associative table: a client hashes to a set of
+ * RATE_LIMIT_WAYS entries and replaces the least recently seen one of them,
+ * so lookups and eviction only touch one set. Tokens are counted in
+ * thousandths so the buckets refill every millisecond.
+ */
+#include "rate_limit.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RATE_LIMIT_WAYS (8)
+#define MILLI (1000)
+
+typedef struct {
+    int64_t tokens;             // in thousandths
+    uint64_t updated_ms;
+} RateBucket;
+
+typedef struct {
+    uint32_t client;
+    uint64_t last_seen_ms;      // 0 if the entry is free
+    RateBucket buckets[RATE_LIMIT_MAX_CLASSES];
+} RateClient;
+
+struct RateLimiter_ {
+    pthread_mutex_t lock;
+    RateLimit limits[RATE_LIMIT_MAX_CLASSES];
+    size_t num_classes;
+    size_t set_mask;
+    RateClient clients[];
+};
+
+static uint64_t now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // Never 0, which marks free entries.
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000 + 1;
+}
+
+RateLimiter *rate_limiter_create(const RateLimit *limits, size_t num_classes,
+                                 size_t max_clients) {
+    size_t num_sets = 1;
+    if (num_classes > RATE_LIMIT_MAX_CLASSES) {
+        return NULL;
+    }
+    while (num_sets * RATE_LIMIT_WAYS < max_clients) {
+        num_sets <<= 1;
+    }
+    RateLimiter *limiter = calloc(1, sizeof(RateLimiter) +
+                                     num_sets * RATE_LIMIT_WAYS * sizeof(RateClient));
+    if (limiter == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&limiter->lock, NULL) != 0) {
+        free(limiter);
+        return NULL;
+    }
+    memcpy(limiter->limits, limits, num_classes * sizeof(RateLimit));
+    limiter->num_classes = num_classes;
+    limiter->set_mask = num_sets - 1;
+    return limiter;
+}
+
+void rate_limiter_free(RateLimiter **limiter) {
+    if (*limiter != NULL) {
+        pthread_mutex_destroy(&(*limiter)->lock);
+        free(*limiter);
+        *limiter = NULL;
+    }
+}
+
+/**
+ * Find the entry of a client, or replace the least recently seen entry of
+ * its set with a full one.
+ *
+ * Must be called with the lock held.
+ */
+static RateClient *find_client(RateLimiter *limiter, uint32_t client, uint64_t now) {
+    size_t set = ((client * 2654435761u) >> 16) & limiter->set_mask;
+    RateClient *entries = &limiter->clients[set * RATE_LIMIT_WAYS];
+    RateClient *victim = &entries[0];
+    for (size_t i = 0; i < RATE_LIMIT_WAYS; i++) {
+        if (entries[i].last_seen_ms != 0 && entries[i].client == client) {
+            return &entries[i];
+        }
+        if (entries[i].last_seen_ms < victim->last_seen_ms) {
+            victim = &entries[i];
+        }
+    }
+    victim->client = client;
+    for (size_t i = 0; i < limiter->num_classes; i++) {
+        victim->buckets[i].tokens = (int64_t) limiter->limits[i].burst * MILLI;
+        victim->buckets[i].updated_ms = now;
+    }
+    return victim;
+}
+
+int rate_limiter_take(RateLimiter *limiter, uint32_t client, unsigned int request_class,
+                      unsigned int *retry_after_ms) {
+    if (request_class >= limiter->num_classes ||
+            limiter->limits[request_class].per_second == 0) {
+        return 1;
+    }
+    const RateLimit *limit = &limiter->limits[request_class];
+    int allowed;
+
+    pthread_mutex_lock(&limiter->lock);
+    uint64_t now = now_ms();
+    RateClient *entry = find_client(limiter, client, now);
+    RateBucket *bucket = &entry->buckets[request_class];
+    entry->last_seen_ms = now;
+
+    // per_second tokens a second are per_second thousandths a millisecond.
+    bucket->tokens += (int64_t) (now - bucket->updated_ms) * limit->per_second;
+    if (bucket->tokens > (int64_t) limit->burst * MILLI) {
+        bucket->tokens = (int64_t) limit->burst * MILLI;
+    }
+    bucket->updated_ms = now;
+    allowed = bucket->tokens >= MILLI;
+    if (allowed) {
+        bucket->tokens -= MILLI;
+    } else {
+        *retry_after_ms = (MILLI - bucket->tokens + limit->per_second - 1) / limit->per_second;
+    }
+    pthread_mutex_unlock(&limiter->lock);
+    return allowed;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Per-client token bucket rate limiting.
+ *
+ * Each client, identified by its IPv4 address, has one token bucket per
+ * request class. Clients are kept in a fixed-size table; when it is full the
+ * least recently seen client of a set is forgotten.
+ */
+
+#ifndef SRC_SERVER_RATE_LIMIT_H_
+#define SRC_SERVER_RATE_LIMIT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Maximum number of request classes.
+ */
+#define RATE_LIMIT_MAX_CLASSES (4)
+
+/*
+ * Default number of clients remembered.
+ */
+#define RATE_LIMIT_DEFAULT_CLIENTS (256)
+
+/**
+ * The limit of a request class.
+ */
+typedef struct {
+    unsigned int per_second;    // sustained requests per second, 0 for no limit
+    unsigned int burst;         // requests allowed at once
+} RateLimit;
+
+struct RateLimiter_;
+typedef struct RateLimiter_ RateLimiter;
+
+/**
+ * Create a rate limiter.
+ *
+ * @param limits the limit of each request class.
+ * @param num_classes number of request classes, at most
+ *        RATE_LIMIT_MAX_CLASSES.
+ * @param max_clients number of clients remembered, rounded up.
+ * @return the rate limiter or NULL if out-of-memory or there are too many
+ *         classes.
+ */
+RateLimiter *rate_limiter_create(const RateLimit *limits, size_t num_classes,
+                                 size_t max_clients);
+
+/**
+ * Free a rate limiter.
+ *
+ * @param limiter the rate limiter, set to NULL.
+ */
+void rate_limiter_free(RateLimiter **limiter);
+
+/**
+ * Take a token from the bucket of a client for a request.
+ *
+ * @param limiter the rate limiter.
+ * @param client the client address.
+ * @param request_class the class of the request.
+ * @param retry_after_ms set to the time until a token is available, if
+ *        limited.
+ * @return 1 if the request is allowed, 0 if it is limited.
+ */
+int rate_limiter_take(RateLimiter *limiter, uint32_t client, unsigned int request_class,
+                      unsigned int *retry_after_ms);
+
+#endif /* SRC_SERVER_RATE_LIMIT_H_ */
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Epoch-based reclamation. A global epoch is advanced every time data is
+ * retired, and stamped on it. Each reader thread announces the epoch it
+ * entered its critical section in; data retired in epoch e is freed once
+ * every reader is either outside a critical section or announced an epoch
+ * after e, as it then loaded its pointers after the data was unpublished.
+ */
+#include "rcu.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct RcuReader_ {
+    struct RcuReader_ *next;
+    unsigned long epoch;    // 0 outside of a read-side critical section
+    int in_use;             // owned by a live thread
+} RcuReader;
+
+static struct {
+    pthread_mutex_t mutex;  // protects the lists
+    pthread_once_t once;
+    pthread_key_t key;
+    RcuReader *readers;     // slots are reused, never freed
+    RcuHead *retired;
+    unsigned long epoch;
+    unsigned long pinned;   // readers without a slot, blocking reclamation
+} gRcu = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_ONCE_INIT, 0, NULL, NULL, 1, 0 };
+
+static __thread RcuReader *tReader;
+static __thread unsigned int tDepth;
+static __thread int tPinned;
+
+static void release_reader(void *arg) {
+    RcuReader *reader = (RcuReader *) arg;
+    pthread_mutex_lock(&gRcu.mutex);
+    reader->in_use = 0;
+    pthread_mutex_unlock(&gRcu.mutex);
+}
+
+static void create_key() {
+    pthread_key_create(&gRcu.key, release_reader);
+}
+
+/**
+ * Claim a reader slot for the calling thread, released when it exits.
+ */
+static RcuReader *register_reader() {
+    RcuReader *reader;
+
+    pthread_once(&gRcu.once, create_key);
+    pthread_mutex_lock(&gRcu.mutex);
+    for (reader = gRcu.readers; reader != NULL; reader = reader->next) {
+        if (!reader->in_use) {
+            break;
+        }
+    }
+    if (reader == NULL && (reader = (RcuReader *) calloc(1, sizeof(RcuReader))) != NULL) {
+        reader->next = gRcu.readers;
+        gRcu.readers = reader;
+    }
+    if (reader != NULL) {
+        reader->in_use = 1;
+        pthread_setspecific(gRcu.key, reader);
+    }
+    pthread_mutex_unlock(&gRcu.mutex);
+    return reader;
+}
+
+void rcu_read_lock() {
+    if (tDepth++ > 0) {
+        return;
+    }
+    if (tReader == NULL) {
+        tReader = register_reader();
+    }
+    if (tReader != NULL) {
+        __atomic_store_n(&tReader->epoch, __atomic_load_n(&gRcu.epoch, __ATOMIC_ACQUIRE),
+                         __ATOMIC_SEQ_CST);
+    } else {
+        // Out of memory: hold off all reclamation instead.
+        __atomic_add_fetch(&gRcu.pinned, 1, __ATOMIC_SEQ_CST);
+        tPinned = 1;
+    }
+    // The announcement must be visible before any published pointer is read.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void rcu_read_unlock() {
+    if (--tDepth > 0) {
+        return;
+    }
+    if (tPinned) {
+        tPinned = 0;
+        __atomic_sub_fetch(&gRcu.pinned, 1, __ATOMIC_RELEASE);
+    } else {
+        __atomic_store_n(&tReader->epoch, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * Free the retired data older than every active reader.
+ *
+ * Must be called with the mutex held.
+ */
+static void reclaim_locked() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&gRcu.pinned, __ATOMIC_ACQUIRE) != 0) {
+        return;
+    }
+    unsigned long oldest = __atomic_load_n(&gRcu.epoch, __ATOMIC_RELAXED);
+    for (RcuReader *reader = gRcu.readers; reader != NULL; reader = reader->next) {
+        unsigned long epoch = __atomic_load_n(&reader->epoch, __ATOMIC_ACQUIRE);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    RcuHead **ptr = &gRcu.retired;
+    while (*ptr != NULL) {
+        RcuHead *head = *ptr;
+        if (head->epoch < oldest) {
+            *ptr = head->next;
+            head->free_fn(head);
+        } else {
+            ptr = &head->next;
+        }
+    }
+}
+
+void rcu_retire(RcuHead *head, void (*free_fn)(RcuHead *)) {
+    pthread_mutex_lock(&gRcu.mutex);
+    head->free_fn = free_fn;
+    head->epoch = __atomic_fetch_add(&gRcu.epoch, 1, __ATOMIC_SEQ_CST);
+    head->next = gRcu.retired;
+    gRcu.retired = head;
+    reclaim_locked();
+    pthread_mutex_unlock(&gRcu.mutex);
+}
+
+void rcu_reclaim() {
+    pthread_mutex_lock(&gRcu.mutex);
+    reclaim_locked();
+    pthread_mutex_unlock(&gRcu.mutex);
+}
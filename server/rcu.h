@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Read-copy-update with epoch-based reclamation.
+ *
+ * Readers bracket their accesses to shared data with rcu_read_lock() and
+ * rcu_read_unlock(), which never block. Writers, serialized by their own
+ * lock, publish a new version of the data and hand the old one to
+ * rcu_retire(), which frees it once every reader that might still see it has
+ * left its read-side critical section.
+ */
+
+#ifndef SRC_SERVER_RCU_H_
+#define SRC_SERVER_RCU_H_
+
+/*
+ * Load a pointer published with rcu_assign_pointer().
+ */
+#define rcu_dereference(p) __atomic_load_n(&(p), __ATOMIC_ACQUIRE)
+
+/*
+ * Publish a pointer to fully initialized data.
+ */
+#define rcu_assign_pointer(p, v) __atomic_store_n(&(p), (v), __ATOMIC_RELEASE)
+
+/**
+ * Enter a read-side critical section. Sections may be nested.
+ */
+void rcu_read_lock();
+
+/**
+ * Leave a read-side critical section.
+ */
+void rcu_read_unlock();
+
+/*
+ * Embedded in data that is retired, so retiring it never allocates.
+ */
+typedef struct RcuHead_ {
+    struct RcuHead_ *next;
+    void (*free_fn)(struct RcuHead_ *);
+    unsigned long epoch;
+} RcuHead;
+
+/**
+ * Free data that has been unpublished once no reader can reference it any
+ * more. May be called from within a read-side critical section.
+ *
+ * @param head the head embedded in the unpublished data.
+ * @param free_fn called with head to free the data.
+ */
+void rcu_retire(RcuHead *head, void (*free_fn)(RcuHead *));
+
+/**
+ * Free the retired data no reader can reference any more.
+ */
+void rcu_reclaim();
+
+#endif /* SRC_SERVER_RCU_H_ */
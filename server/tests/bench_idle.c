@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Counts the wake-ups of an idle DIAL server's threads, from the number of
+ * times each was scheduled in /proc/self/task/<tid>/schedstat, and how long
+ * it takes to stop. A second HTTP server stands in for the dd.xml one.
+ */
+#include "../dial_server.h"
+#include "../mongoose.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_IDLE_SEC (60)
+#define BENCH_MAX_THREADS (64)
+
+typedef struct {
+    pid_t tid;
+    unsigned long long scheduled;
+} ThreadCount;
+
+static double now_us() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+static void *no_requests(enum mg_event event, struct mg_connection *conn,
+                         const struct mg_request_info *request_info) {
+    return NULL;
+}
+
+/**
+ * Read how many times each thread but the calling one was scheduled.
+ *
+ * @return the number of threads.
+ */
+static size_t read_counts(ThreadCount *counts, size_t max_counts) {
+    DIR *dir = opendir("/proc/self/task");
+    struct dirent *entry;
+    size_t count = 0;
+
+    while (dir != NULL && count < max_counts && (entry = readdir(dir)) != NULL) {
+        char path[64];
+        unsigned long long run_ns, wait_ns;
+        pid_t tid = (pid_t) atoi(entry->d_name);
+        if (tid <= 0 || tid == getpid()) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", tid);
+        FILE *file = fopen(path, "r");
+        if (file != NULL) {
+            if (fscanf(file, "%llu %llu %llu", &run_ns, &wait_ns,
+                       &counts[count].scheduled) == 3) {
+                counts[count++].tid = tid;
+            }
+            fclose(file);
+        }
+    }
+    if (dir != NULL) {
+        closedir(dir);
+    }
+    return count;
+}
+
+int main(int argc, char **argv) {
+    ThreadCount before[BENCH_MAX_THREADS], after[BENCH_MAX_THREADS];
+    int idle_sec = argc > 1 ? atoi(argv[1]) : BENCH_IDLE_SEC;
+    unsigned long long wakeups = 0;
+
+    DIALServer *ds = DIAL_create();
+    DIAL_set_port(ds, 0);
+    struct mg_context *dd_ctx = mg_start(&no_requests, NULL, 0);
+    if (dd_ctx == NULL || !DIAL_start(ds)) {
+        printf("servers failed to start\n");
+        return 1;
+    }
+
+    // Let the threads settle before counting.
+    sleep(1);
+    size_t num_before = read_counts(before, BENCH_MAX_THREADS);
+    sleep(idle_sec);
+    size_t num_after = read_counts(after, BENCH_MAX_THREADS);
+
+    printf("%zu threads idle for %d s:\n", num_after, idle_sec);
+    for (size_t i = 0; i < num_after; i++) {
+        for (size_t j = 0; j < num_before; j++) {
+            if (before[j].tid == after[i].tid) {
+                unsigned long long woken = after[i].scheduled - before[j].scheduled;
+                printf("  thread %d: %llu wake-ups\n", after[i].tid, woken);
+                wakeups += woken;
+            }
+        }
+    }
+
+    double start = now_us();
+    DIAL_stop(ds);
+    mg_stop(dd_ctx);
+    printf("%llu wake-ups, stopped in %.1f us\n", wakeups, now_us() - start);
+    free(ds);
+    return wakeups == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Compares the time from launching an application to it executing its
+ * program, with fork() and execv() as runApplication() used to, and with
+ * launch_process(), from a process the size of a busy server.
+ */
+#define _GNU_SOURCE
+#include "../launcher.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_HEAP_MB (256)
+#define BENCH_THREADS (6)
+#define BENCH_LAUNCHES (50)
+
+static double now_us() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+static void *idle_thread(void *arg) {
+    pause();
+    return NULL;
+}
+
+/**
+ * Launch /bin/true and return the time until it executes, which closes the
+ * close-on-exec pipe the parent is reading.
+ */
+static double launch(int use_fork) {
+    char * const argv[] = { "true", NULL };
+    int fds[2];
+    char c;
+    pid_t pid;
+
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return 0;
+    }
+    double start = now_us();
+    if (use_fork) {
+        if ((pid = fork()) == 0) {
+            execv("/bin/true", argv);
+            _exit(127);
+        }
+    } else {
+        pid = launch_process("/bin/true", argv, NULL, NULL, 0);
+    }
+    close(fds[1]);
+    if (read(fds[0], &c, 1) != 0) {
+        printf("unexpected data\n");
+    }
+    double elapsed = now_us() - start;
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    return elapsed;
+}
+
+int main(int argc, char **argv) {
+    size_t heap_size = (size_t) BENCH_HEAP_MB << 20;
+    char *heap = (char *) malloc(heap_size);
+    pthread_t thread;
+
+    if (heap == NULL) {
+        return 1;
+    }
+    memset(heap, 1, heap_size);
+    for (int i = 0; i < BENCH_THREADS; i++) {
+        pthread_create(&thread, NULL, idle_thread, NULL);
+    }
+
+    double forked = 0, spawned = 0;
+    for (int i = 0; i < BENCH_LAUNCHES; i++) {
+        forked += launch(1);
+        spawned += launch(0);
+    }
+    printf("%d MB resident, %d threads, launch to exec:\n", BENCH_HEAP_MB, BENCH_THREADS + 1);
+    printf("  fork, execv:    %10.1f us\n", forked / BENCH_LAUNCHES);
+    printf("  launch_process: %10.1f us\n", spawned / BENCH_LAUNCHES);
+    free(heap);
+    return 0;
+}
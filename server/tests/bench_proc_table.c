@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Compares the cost of finding a running application by walking /proc and
+ * compiling the patterns on every lookup, as isAppRunning() used to, with the
+ * process table, while BENCH_PROCESSES processes are running.
+ */
+#include "../proc_table.h"
+
+#include <dirent.h>
+#include <regex.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_PROCESSES (500)
+#define BENCH_LOOKUPS (20)
+
+static int doesMatch(const char *pzExp, const char *pzStr) {
+    regex_t exp;
+    int match = 0;
+    if (regcomp(&exp, pzExp, REG_EXTENDED) == 0) {
+        regmatch_t matches[1];
+        match = regexec(&exp, pzStr, 1, matches, 0) == 0;
+    }
+    regfree(&exp);
+    return match;
+}
+
+static int legacyIsAppRunning(const char *pzName, const char *pzCommandPattern) {
+    DIR *proc_fd = opendir("/proc");
+    if (proc_fd == NULL) {
+        return 0;
+    }
+    struct dirent *procEntry;
+    while ((procEntry = readdir(proc_fd)) != NULL) {
+        if (doesMatch("^[0-9][0-9]*$", procEntry->d_name)) {
+            char exePath[384], link[256] = {0,}, cmdlinePath[384];
+            char buffer[1024] = {0,}, executable[256] = {0,};
+            snprintf(exePath, sizeof(exePath), "/proc/%s/exe", procEntry->d_name);
+            snprintf(cmdlinePath, sizeof(cmdlinePath), "/proc/%s/cmdline", procEntry->d_name);
+            if (readlink(exePath, link, sizeof(link) - 1) == -1) {
+                continue;
+            }
+            strncpy(executable, pzName, sizeof(executable) - 2);
+            strcat(executable, "$");
+            if (!doesMatch(executable, link)) {
+                continue;
+            }
+            if (pzCommandPattern != NULL) {
+                FILE *cmdline = fopen(cmdlinePath, "r");
+                if (!cmdline) {
+                    continue;
+                }
+                char *line = fgets(buffer, sizeof(buffer), cmdline);
+                fclose(cmdline);
+                if (line == NULL || !doesMatch(pzCommandPattern, buffer)) {
+                    continue;
+                }
+            }
+            int pid = atoi(procEntry->d_name);
+            closedir(proc_fd);
+            return pid;
+        }
+    }
+    closedir(proc_fd);
+    return 0;
+}
+
+static double now_us() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+int main(int argc, char **argv) {
+    static pid_t pids[BENCH_PROCESSES];
+    for (int i = 0; i < BENCH_PROCESSES; i++) {
+        if ((pids[i] = fork()) == 0) {
+            execl("/bin/sleep", "sleep", "60", (char *) NULL);
+            _exit(127);
+        }
+    }
+    sleep(1);
+
+    // Looking for an application that is not running walks all of /proc.
+    double start = now_us();
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        legacyIsAppRunning("netflix", NULL);
+    }
+    double legacy = (now_us() - start) / BENCH_LOOKUPS;
+
+    int handle = proc_table_register("netflix", NULL);
+    proc_table_set_refresh_interval(0);
+    proc_table_find(handle);
+    start = now_us();
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        proc_table_find(handle);
+    }
+    double refresh = (now_us() - start) / BENCH_LOOKUPS;
+
+    proc_table_set_refresh_interval(PROC_TABLE_REFRESH_MS);
+    start = now_us();
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        proc_table_find(handle);
+    }
+    double cached = (now_us() - start) / BENCH_LOOKUPS;
+
+    printf("%d processes, per lookup:\n", BENCH_PROCESSES);
+    printf("  walk /proc, compile patterns: %10.1f us\n", legacy);
+    printf("  process table refresh:        %10.1f us\n", refresh);
+    printf("  process table lookup:         %10.1f us\n", cached);
+
+    for (int i = 0; i < BENCH_PROCESSES; i++) {
+        kill(pids[i], SIGKILL);
+        waitpid(pids[i], NULL, 0);
+    }
+    proc_table_clear();
+    return 0;
+}
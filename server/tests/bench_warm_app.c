@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Compares the time from launching an application to it being ready, when
+ * started cold with launch_process(), and when resumed from hidden with new
+ * arguments by warm_app_resume().
+ */
+#include "../launcher.h"
+#include "../warm_app.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_LAUNCHES (100)
+#define BENCH_LAUNCH_FILE "/tmp/bench_warm_app.launch"
+
+// Reports being ready on descriptor 3 once started, and once it read its new
+// arguments after being resumed. It idles waiting for a single child, so it
+// does not fork again once ready.
+static const char *gScript = "trap 'read -r args < \"$LAUNCH\"; echo ready >&3' USR1; "
+                             "trap 'kill $idle; exit' TERM; sleep 1000 & idle=$!; "
+                             "echo ready >&3; while :; do wait $idle; done";
+
+static double now_us() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+/**
+ * Wait for the application to report being ready.
+ */
+static int wait_ready(int fd) {
+    char line[16];
+    ssize_t n = read(fd, line, sizeof(line));
+    return n == (ssize_t) strlen("ready\n") && !strncmp(line, "ready\n", n);
+}
+
+/**
+ * Launch the application.
+ *
+ * @param fd receives the read end of its ready pipe.
+ * @return its PID, or -1 on error.
+ */
+static pid_t launch(const char * const args[], int *fd) {
+    char * const env[] = { "LAUNCH=" BENCH_LAUNCH_FILE, NULL };
+    int fds[2];
+
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    pid_t pid = launch_process(args[0], (char * const *) args, env, &fds[1], 1);
+    close(fds[1]);
+    *fd = fds[0];
+    return pid;
+}
+
+static void stop(pid_t pid, int fd) {
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    close(fd);
+}
+
+int main(int argc, char **argv) {
+    char arg[32];
+    const char * const args[] = { "/bin/sh", "-c", gScript, arg, NULL };
+    double cold = 0, warm = 0;
+    WarmApp app;
+    int fd;
+
+    for (int i = 0; i < BENCH_LAUNCHES; i++) {
+        snprintf(arg, sizeof(arg), "%d", i);
+        double start = now_us();
+        pid_t pid = launch(args, &fd);
+        if (pid == -1 || !wait_ready(fd)) {
+            printf("cold launch failed\n");
+            return 1;
+        }
+        cold += now_us() - start;
+        stop(pid, fd);
+    }
+
+    warm_app_init(&app, BENCH_LAUNCH_FILE, SIGUSR1);
+    pid_t pid = launch(args, &fd);
+    if (pid == -1 || !wait_ready(fd)) {
+        printf("launch failed\n");
+        return 1;
+    }
+    warm_app_started(&app, pid, args);
+    for (int i = 0; i < BENCH_LAUNCHES; i++) {
+        snprintf(arg, sizeof(arg), "%d", BENCH_LAUNCHES + i);
+        warm_app_hide(&app, pid);
+        double start = now_us();
+        if (warm_app_resume(&app, args) != 1 || !wait_ready(fd)) {
+            printf("warm resume failed\n");
+            return 1;
+        }
+        warm += now_us() - start;
+    }
+    stop(pid, fd);
+    warm_app_free(&app);
+    unlink(BENCH_LAUNCH_FILE);
+
+    printf("launch to ready, with new arguments:\n");
+    printf("  cold launch: %10.1f us\n", cold / BENCH_LAUNCHES);
+    printf("  warm resume: %10.1f us\n", warm / BENCH_LAUNCHES);
+    return 0;
+}
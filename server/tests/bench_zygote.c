@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Compares the time from posting a launch request to receiving the 201
+ * response, with the application launched by the server with fork() and
+ * execv() as runApplication() used to, with launch_process(), and by the
+ * zygote, from a process the size of a busy server.
+ */
+#include "../child_reaper.h"
+#include "../dial_server.h"
+#include "../launcher.h"
+#include "../zygote.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_HEAP_MB (256)
+#define BENCH_THREADS (6)
+#define BENCH_LAUNCHES (200)
+
+static int gTemplate = -1;
+
+static double now_us() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+static void *idle_thread(void *arg) {
+    pause();
+    return NULL;
+}
+
+static pid_t spawn_fork(void *spawn_data) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execv("/bin/true", (char * const []) { "true", NULL });
+        _exit(127);
+    }
+    return pid;
+}
+
+static pid_t spawn_direct(void *spawn_data) {
+    char * const argv[] = { "true", NULL };
+    return launch_process("/bin/true", argv, NULL, NULL, 0);
+}
+
+static pid_t spawn_zygote(void *spawn_data) {
+    return zygote_spawn(gTemplate, NULL);
+}
+
+static DIALStatus bench_start(DIALServer *ds, const char *app_name,
+                              const char *payload, const char *query_string,
+                              const char *additionalDataUrl,
+                              DIAL_run_t *run_id, void *callback_data) {
+    pid_t pid = child_reaper_spawn(ds, app_name, (pid_t (*)(void *)) callback_data, NULL);
+    *run_id = (DIAL_run_t) (long) pid;
+    return pid > 0 ? kDIALStatusRunning : kDIALStatusError;
+}
+
+static DIALStatus bench_status(DIALServer *ds, const char *app_name,
+                               DIAL_run_t run_id, int *pCanStop,
+                               void *callback_data) {
+    *pCanStop = 1;
+    return child_reaper_exited((pid_t) (long) run_id, NULL, NULL) == 0
+           ? kDIALStatusRunning : kDIALStatusStopped;
+}
+
+/**
+ * Post a launch request and return the time until the response is read, or -1
+ * if it is not a 201.
+ */
+static double post(DIALServer *ds, const char *app_name) {
+    struct sockaddr_in addr;
+    char request[256], response[1024];
+    int status = -1;
+    size_t len = 0;
+    ssize_t n;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(DIAL_get_port(ds));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    snprintf(request, sizeof(request), "POST /apps/%s HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+             "Content-Length: 0\r\nConnection: close\r\n\r\n", app_name);
+
+    double start = now_us();
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+        write(fd, request, strlen(request)) != (ssize_t) strlen(request)) {
+        if (fd != -1) {
+            close(fd);
+        }
+        return -1;
+    }
+    while (len + 1 < sizeof(response) &&
+           (n = read(fd, response + len, sizeof(response) - len - 1)) > 0) {
+        len += n;
+    }
+    double elapsed = now_us() - start;
+    response[len] = '\0';
+    close(fd);
+    sscanf(response, "HTTP/1.1 %d", &status);
+    return status == 201 ? elapsed : -1;
+}
+
+/**
+ * Return the average POST to 201 time of an application.
+ */
+static double bench(DIALServer *ds, const char *app_name) {
+    double total = 0;
+    for (int i = 0; i < BENCH_LAUNCHES; i++) {
+        double elapsed = post(ds, app_name);
+        if (elapsed < 0) {
+            printf("%s launch failed\n", app_name);
+            return -1;
+        }
+        total += elapsed;
+    }
+    return total / BENCH_LAUNCHES;
+}
+
+int main(int argc, char **argv) {
+    struct DIALAppCallbacks callbacks = { bench_start, NULL, NULL, bench_status };
+    size_t heap_size = (size_t) BENCH_HEAP_MB << 20;
+    pthread_t thread;
+
+    // The zygote is forked first, like the server does at startup.
+    child_reaper_block_signal();
+    gTemplate = zygote_add_template("/bin/true", NULL, NULL);
+    if (gTemplate == -1 || !start_zygote()) {
+        printf("zygote failed to start\n");
+        return 1;
+    }
+
+    char *heap = (char *) malloc(heap_size);
+    if (heap == NULL) {
+        return 1;
+    }
+    memset(heap, 1, heap_size);
+    for (int i = 0; i < BENCH_THREADS; i++) {
+        pthread_create(&thread, NULL, idle_thread, NULL);
+    }
+
+    DIALServer *ds = DIAL_create();
+    DIAL_set_port(ds, 0);
+    start_child_reaper();
+    DIAL_register_app(ds, "Fork", &callbacks, (void *) spawn_fork, 0, NULL);
+    DIAL_register_app(ds, "Direct", &callbacks, (void *) spawn_direct, 0, NULL);
+    DIAL_register_app(ds, "Zygote", &callbacks, (void *) spawn_zygote, 0, NULL);
+    if (!DIAL_start(ds)) {
+        printf("server failed to start\n");
+        return 1;
+    }
+
+    double forked = bench(ds, "Fork");
+    double direct = bench(ds, "Direct");
+    double zygote = bench(ds, "Zygote");
+    printf("%d MB resident, %d threads, POST to 201:\n", BENCH_HEAP_MB, BENCH_THREADS + 1);
+    printf("  fork, execv:    %10.1f us\n", forked);
+    printf("  launch_process: %10.1f us\n", direct);
+    printf("  zygote:         %10.1f us\n", zygote);
+
+    DIAL_stop(ds);
+    stop_child_reaper();
+    stop_zygote();
+    free(ds);
+    free(heap);
+    return 0;
+}
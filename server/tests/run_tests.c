@@ -22,16 +22,44 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include "test_app_state_shm.h"
 #include "test_callbacks.h"
+#include "test_child_reaper.h"
+#include "test_dial_control.h"
 #include "test_dial_data.h"
+#include "test_dial_data_db.h"
+#include "test_dial_data_store.h"
+#include "test_dial_server.h"
+#include "test_http_watch.h"
+#include "test_launcher.h"
+#include "test_proc_table.h"
+#include "test_proc_watch.h"
+#include "test_rate_limit.h"
+#include "test_rcu.h"
 #include "test_url_lib.h"
+#include "test_warm_app.h"
+#include "test_zygote.h"
 
 #include <stdio.h>
 
 
 int main(int argc, char** argv) {
+    test_app_state_shm_suite();
+    test_child_reaper_suite();
+    test_dial_control_suite();
     test_dial_data_suite();
+    test_dial_data_db_suite();
+    test_dial_data_store_suite();
+    test_dial_server_suite();
+    test_http_watch_suite();
+    test_launcher_suite();
+    test_proc_table_suite();
+    test_proc_watch_suite();
+    test_rate_limit_suite();
+    test_rcu_suite();
     test_url_lib_suite();
+    test_warm_app_suite();
+    test_zygote_suite();
     test_callbacks_suite();
     return 0;
 }
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../app_state_shm.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../dial_server.h"
+#include "test.h"
+#include "test_app_state_shm.h"
+
+#define SHM_NAME "/test_dial_app_state"
+
+static void *update_later(void *arg) {
+    usleep(20000);
+    app_state_shm_update((AppStateShm *) arg, 0, kDIALStatusRunning, 7, 2, 0);
+    return NULL;
+}
+
+void test_app_state_shm_slots() {
+    AppState state;
+    pthread_t thread;
+
+    AppStateShm *shm = app_state_shm_create(SHM_NAME);
+    EXPECT(shm != NULL, "segment not created");
+    const AppStateShm *reader = app_state_shm_open(SHM_NAME);
+    EXPECT(reader != NULL, "segment not mapped");
+
+    EXPECT_EQ(app_state_shm_claim(shm, "First"), 0);
+    EXPECT_EQ(app_state_shm_claim(shm, "Second"), 1);
+    EXPECT_EQ(app_state_shm_read(reader, "First", &state), 1);
+    EXPECT_EQ(state.state, kDIALStatusStopped);
+    app_state_shm_update(shm, 1, kDIALStatusHide, 42, 3, 10);
+    EXPECT_EQ(app_state_shm_read(reader, "Second", &state), 1);
+    EXPECT_EQ(state.state, kDIALStatusHide);
+    EXPECT_EQ(state.run_id, 42);
+    EXPECT_EQ(state.version, 3);
+    EXPECT_EQ(state.payload_len, 10);
+    EXPECT(state.changed_ns > 0, "change time not set");
+    EXPECT_EQ(app_state_shm_read(reader, "Third", &state), 0);
+
+    // A released slot is reused.
+    app_state_shm_release(shm, 0);
+    EXPECT_EQ(app_state_shm_read(reader, "First", &state), 0);
+    EXPECT_EQ(app_state_shm_claim(shm, "Third"), 0);
+
+    // Readers block until the next update.
+    uint32_t changes = app_state_shm_changes(reader);
+    EXPECT_EQ(app_state_shm_wait(reader, changes, 0), 0);
+    EXPECT_EQ(pthread_create(&thread, NULL, update_later, shm), 0);
+    EXPECT_EQ(app_state_shm_wait(reader, changes, -1), 1);
+    pthread_join(thread, NULL);
+    EXPECT_EQ(app_state_shm_read(reader, "Third", &state), 1);
+    EXPECT_EQ(state.state, kDIALStatusRunning);
+
+    // A slot left half-written, as by a server killed mid-update, does not
+    // hang the readers.
+    shm->slots[1].seq++;
+    EXPECT_EQ(app_state_shm_read(reader, "Second", &state), -1);
+    EXPECT_EQ(app_state_shm_read(reader, "Third", &state), 1);
+    shm->slots[1].seq++;
+    EXPECT_EQ(app_state_shm_read(reader, "Second", &state), 1);
+
+    app_state_shm_close(reader);
+    app_state_shm_destroy(shm, SHM_NAME);
+    EXPECT(app_state_shm_open(SHM_NAME) == NULL, "segment not removed");
+    DONE();
+}
+
+void test_app_state_shm_server() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppRegistration registration;
+    AppState state;
+
+    memset(&registration, 0, sizeof(registration));
+    registration.statePushed = 1;
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app_ex(ds, "Before", &registration), 1);
+    EXPECT_EQ(DIAL_publish_app_states(ds, SHM_NAME), 1);
+    EXPECT_EQ(DIAL_register_app_ex(ds, "After", &registration), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    const AppStateShm *reader = app_state_shm_open(SHM_NAME);
+    EXPECT(reader != NULL, "segment not mapped");
+    EXPECT_EQ(app_state_shm_read(reader, "Before", &state), 1);
+    EXPECT_EQ(state.state, kDIALStatusStopped);
+    uint32_t changes = app_state_shm_changes(reader);
+    EXPECT_EQ(DIAL_report_state(ds, "After", kDIALStatusRunning, (DIAL_run_t) 5, 1), 1);
+    EXPECT_EQ(app_state_shm_wait(reader, changes, 0), 1);
+    EXPECT_EQ(app_state_shm_read(reader, "After", &state), 1);
+    EXPECT_EQ(state.state, kDIALStatusRunning);
+    EXPECT_EQ(state.run_id, 5);
+    EXPECT_EQ(state.version, 1);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Before"), 1);
+    EXPECT_EQ(app_state_shm_read(reader, "Before", &state), 0);
+    EXPECT_EQ(DIAL_unregister_app(ds, "After"), 1);
+    DIAL_stop(ds);
+    EXPECT_EQ(app_state_shm_read(reader, "After", &state), 0);
+    app_state_shm_close(reader);
+    EXPECT(app_state_shm_open(SHM_NAME) == NULL, "segment not removed");
+    free(ds);
+    DONE();
+}
+
+void test_app_state_shm_suite() {
+    START_SUITE();
+    test_app_state_shm_slots();
+    test_app_state_shm_server();
+}
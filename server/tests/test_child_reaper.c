@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../child_reaper.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_child_reaper.h"
+
+/**
+ * Wait up to a second for a child to exit.
+ */
+static int wait_for_exit(pid_t pid, int *status, struct timespec *exit_time) {
+    int exited = child_reaper_exited(pid, status, exit_time);
+    for (int i = 0; i < 200 && exited != 1; i++) {
+        usleep(5 * 1000);
+        exited = child_reaper_exited(pid, status, exit_time);
+    }
+    return exited;
+}
+
+void test_child_reaper_exit_status() {
+    int status = 0;
+    struct timespec exit_time = {0, 0};
+
+    // No other thread is running, so they all block SIGCHLD from now on.
+    child_reaper_block_signal();
+    EXPECT(start_child_reaper(), "reaper should start");
+
+    pid_t pid = child_reaper_fork(NULL, "TestApp");
+    if (pid == 0) {
+        _exit(3);
+    }
+    EXPECT(pid > 0, "fork failed");
+    EXPECT_EQ(wait_for_exit(pid, &status, &exit_time), 1);
+    EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 3, "exit code expected");
+    EXPECT(exit_time.tv_sec != 0 || exit_time.tv_nsec != 0, "exit time expected");
+    EXPECT_EQ(waitpid(pid, NULL, WNOHANG), -1);
+
+    pid = child_reaper_fork(NULL, "TestApp");
+    if (pid == 0) {
+        pause();
+        _exit(0);
+    }
+    EXPECT_EQ(child_reaper_exited(pid, NULL, NULL), 0);
+    kill(pid, SIGKILL);
+    EXPECT_EQ(wait_for_exit(pid, &status, NULL), 1);
+    EXPECT(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL, "signal expected");
+
+    // Children forked otherwise are reaped too.
+    pid = fork();
+    if (pid == 0) {
+        _exit(0);
+    }
+    EXPECT_EQ(wait_for_exit(pid, NULL, NULL), 1);
+    EXPECT_EQ(child_reaper_exited(getpid(), NULL, NULL), -1);
+
+    stop_child_reaper();
+    DONE();
+}
+
+void test_child_reaper_stop() {
+    int status = 0, fds[2];
+    char c;
+
+    EXPECT(start_child_reaper(), "reaper should start");
+    EXPECT_EQ(pipe(fds), 0);
+
+    // A child that exits on SIGTERM is not killed.
+    pid_t pid = child_reaper_fork(NULL, "TestApp");
+    if (pid == 0) {
+        pause();
+        _exit(0);
+    }
+    EXPECT_EQ(child_reaper_stop(pid, 1000), 1);
+    EXPECT_EQ(wait_for_exit(pid, &status, NULL), 1);
+    EXPECT(WIFSIGNALED(status) && WTERMSIG(status) == SIGTERM, "SIGTERM expected");
+    EXPECT_EQ(child_reaper_stop(pid, 1000), 0);
+
+    // A child that ignores it is killed after the grace period, and stopping
+    // it again meanwhile does not send more signals.
+    pid = child_reaper_fork(NULL, "TestApp");
+    if (pid == 0) {
+        signal(SIGTERM, SIG_IGN);
+        close(fds[0]);
+        if (write(fds[1], "x", 1) != 1) {
+            _exit(1);
+        }
+        for (;;) {
+            pause();
+        }
+    }
+    close(fds[1]);
+    EXPECT_EQ(read(fds[0], &c, 1), 1);
+    close(fds[0]);
+    EXPECT_EQ(child_reaper_stop(pid, 100), 1);
+    EXPECT_EQ(child_reaper_stop(pid, 100), 0);
+    usleep(50 * 1000);
+    EXPECT_EQ(child_reaper_exited(pid, NULL, NULL), 0);
+    EXPECT_EQ(wait_for_exit(pid, &status, NULL), 1);
+    EXPECT(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL, "SIGKILL expected");
+
+    EXPECT_EQ(child_reaper_stop(getpid(), 100), -1);
+    stop_child_reaper();
+    EXPECT_EQ(child_reaper_stop(pid, 100), -1);
+    DONE();
+}
+
+void test_child_reaper_suite() {
+    START_SUITE();
+    test_child_reaper_exit_status();
+    test_child_reaper_stop();
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../dial_control.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_dial_control.h"
+
+#define SOCKET_PATH "/tmp/test_dial_control.sock"
+
+static int connect_control() {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX, .sun_path = SOCKET_PATH };
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd != -1 && connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+void test_dial_control_records() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppRegistration registration;
+    char message[256];
+    int8_t results[8];
+    size_t used = 0;
+
+    memset(&registration, 0, sizeof(registration));
+    registration.statePushed = 1;
+    EXPECT_EQ(DIAL_register_app_ex(ds, "Ctl", &registration), 1);
+    EXPECT_EQ(DIAL_set_app_data_quota(ds, "Ctl", 2, 1024, kDIALDataQuotaReject), 1);
+    EXPECT_EQ(start_dial_control(ds, SOCKET_PATH), 1);
+    int fd = connect_control();
+    EXPECT(fd != -1, "connect failed");
+
+    // Several updates in one message, answered in order.
+    DIALControlState state = { kDIALStatusRunning, 1, { 0 }, 42 };
+    DIALControlState bad_state = { kDIALStatusError, 1, { 0 }, 42 };
+    used = dial_control_add_record(message, sizeof(message), used, kDIALControlData,
+                                   "Ctl", "a=1&b=2", 7);
+    used = dial_control_add_record(message, sizeof(message), used, kDIALControlState,
+                                   "Ctl", &state, sizeof(state));
+    used = dial_control_add_record(message, sizeof(message), used, kDIALControlData,
+                                   "Ctl", "a=1&b=2&c=3", 11);
+    used = dial_control_add_record(message, sizeof(message), used, kDIALControlState,
+                                   "Ctl", &bad_state, sizeof(bad_state));
+    used = dial_control_add_record(message, sizeof(message), used, kDIALControlData,
+                                   "Unknown", "a=1", 3);
+    used = dial_control_add_record(message, sizeof(message), used, kDIALControlData,
+                                   "Ctl", "a=\n", 3);
+    EXPECT(used > 0, "records do not fit");
+    EXPECT_EQ(send(fd, message, used, 0), (ssize_t) used);
+    EXPECT_EQ(recv(fd, results, sizeof(results), 0), 6);
+    EXPECT_EQ(results[0], 1);
+    EXPECT_EQ(results[1], 1);
+    EXPECT_EQ(results[2], 0);
+    EXPECT_EQ(results[3], 0);
+    EXPECT_EQ(results[4], -1);
+    EXPECT_EQ(results[5], 0);
+    EXPECT_EQ(DIAL_delete_app_data(ds, "Ctl", "b"), 1);
+    EXPECT_EQ(DIAL_delete_app_data(ds, "Ctl", "c"), 0);
+
+    // A truncated record ends the message.
+    used = dial_control_add_record(message, sizeof(message), 0, kDIALControlData,
+                                   "Ctl", "", 0);
+    EXPECT_EQ(send(fd, message, used + 3, 0), (ssize_t) used + 3);
+    EXPECT_EQ(recv(fd, results, sizeof(results), 0), 2);
+    EXPECT_EQ(results[0], 1);
+    EXPECT_EQ(results[1], -1);
+    EXPECT_EQ(DIAL_delete_app_data(ds, "Ctl", "a"), 0);
+    EXPECT_EQ(dial_control_add_record(message, 8, 0, kDIALControlData, "Ctl", "", 0), 0);
+
+    close(fd);
+    stop_dial_control();
+    EXPECT(access(SOCKET_PATH, F_OK) != 0, "socket not removed");
+    EXPECT_EQ(DIAL_unregister_app(ds, "Ctl"), 1);
+    unlink(DIAL_DATA_DIR "Ctl");
+    free(ds);
+    DONE();
+}
+
+void test_dial_control_suite() {
+    START_SUITE();
+    test_dial_control_records();
+}
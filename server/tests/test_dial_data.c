@@ -23,6 +23,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "../dial_data.h"
+#include "../url_lib.h"
 
 #include <assert.h>
 #include <string.h>
@@ -47,25 +48,25 @@ void test_read_dial_missing_data() {
 }
 
 void test_write_dial_data() {
-    DIALData *result = NULL;
-    for (int i = 0; i < key_value_pairs; ++i) {
-        DIALData *node = (DIALData *) malloc(sizeof(DIALData));
-        node->key = malloc(strlen(keys[i]) + 1);
-        node->value = malloc(strlen(values[i]) + 1);
-        strcpy(node->key, keys[i]);
-        strcpy(node->value, values[i]);
-
-        node->next = result;
-        result = node;
+    char *strings;
+    DIALData *result = alloc_dial_data(key_value_pairs, 64, &strings);
+    DIALData *node = result;
+    for (int i = 0; i < key_value_pairs; ++i, node = node->next) {
+        node->key = strcpy(strings, keys[i]);
+        strings += strlen(keys[i]) + 1;
+        node->value = strcpy(strings, values[i]);
+        strings += strlen(values[i]) + 1;
     }
     store_dial_data("YouTube", result);
 
     DIALData *readBack = retrieve_dial_data("YouTube");
     DIALData *datum = readBack;
-    for (int i = 0; datum != NULL; datum = datum->next, i++) {
+    int i = 0;
+    for (; datum != NULL; datum = datum->next, i++) {
         EXPECT_STREQ(datum->key, keys[i]);
         EXPECT_STREQ(datum->value, values[i]);
     }
+    EXPECT_EQ(i, key_value_pairs);
 
     free_dial_data(&result);
     free_dial_data(&readBack);
@@ -75,9 +76,10 @@ void test_write_dial_data() {
 
 void test_write_kv_larger_than_max_len() {
     // result contains k & v both larger than DIAL_KEY_OR_VALUE_MAX_LEN
-    DIALData *result = (DIALData *) calloc(1, sizeof(DIALData));
-    result->key = calloc(DIAL_KEY_OR_VALUE_MAX_LEN * 2, sizeof(char));
-    result->value = calloc(DIAL_KEY_OR_VALUE_MAX_LEN * 2, sizeof(char));
+    char *strings;
+    DIALData *result = alloc_dial_data(1, DIAL_KEY_OR_VALUE_MAX_LEN * 4, &strings);
+    result->key = strings;
+    result->value = strings + DIAL_KEY_OR_VALUE_MAX_LEN * 2;
     memset(result->key, 'k', DIAL_KEY_OR_VALUE_MAX_LEN * 2 - 1);
     memset(result->value, 'v', DIAL_KEY_OR_VALUE_MAX_LEN * 2 - 1);
 
@@ -98,9 +100,10 @@ void test_write_kv_larger_than_max_len() {
 }
 
 void test_write_empty_kv() {
-    DIALData *result = (DIALData *) calloc(1, sizeof(DIALData));
-    result->key = calloc(1, sizeof(char));
-    result->value = calloc(1, sizeof(char));
+    char *strings;
+    DIALData *result = alloc_dial_data(1, 2, &strings);
+    result->key = strings;
+    result->value = strings + 1;
 
     store_dial_data("YouTube", result);
 
@@ -116,10 +119,71 @@ void test_write_empty_kv() {
     DONE();
 }
 
+void test_write_dial_data_unwritable_dir() {
+    DIALData *data = parse_params("a=b");
+    set_dial_data_dir("/nonexistent/dial/data/");
+    int stored = store_dial_data("YouTube", data);
+    set_dial_data_dir(DIAL_DATA_DIR);
+    free_dial_data(&data);
+    EXPECT_EQ(stored, 0);
+    DONE();
+}
+
+void test_dial_data_writer() {
+    EXPECT(start_dial_data_writer(60 * 1000, 2), "writer should start");
+
+    // Both updates are coalesced and held for the (long) write window.
+    queue_dial_data("YouTube", parse_params("a=1"));
+    queue_dial_data("YouTube", parse_params("a=2&b=3"));
+    DIALData *readBack = retrieve_dial_data("YouTube");
+    EXPECT_STREQ(readBack->key, "a");
+    EXPECT_STREQ(readBack->value, "2");
+    free_dial_data(&readBack);
+
+    // Stopping the writer flushes pending writes.
+    queue_dial_data("YouTube", parse_params("c=4"));
+    stop_dial_data_writer();
+    readBack = retrieve_dial_data("YouTube");
+    EXPECT_STREQ(readBack->key, "c");
+    EXPECT_STREQ(readBack->value, "4");
+    EXPECT(NULL == readBack->next, "one entry expected");
+    free_dial_data(&readBack);
+
+    FILE *tmp = fopen(DIAL_DATA_DIR "YouTube.tmp", "r");
+    EXPECT(NULL == tmp, "temporary file should be renamed");
+    DONE();
+}
+
+void test_dial_data_writer_order() {
+    char query[32];
+
+    // With room for one pending write, updates of the two applications take
+    // turns between the writer thread and the synchronous fallback.
+    EXPECT(start_dial_data_writer(0, 1), "writer should start");
+    for (int i = 0; i < 200; i++) {
+        snprintf(query, sizeof(query), "v=%d", i);
+        queue_dial_data("Order", parse_params(query));
+        queue_dial_data("Other", parse_params(query));
+    }
+    stop_dial_data_writer();
+
+    DIALData *readBack = retrieve_dial_data("Order");
+    EXPECT_STREQ(readBack->key, "v");
+    EXPECT_STREQ(readBack->value, "199");
+    free_dial_data(&readBack);
+    readBack = retrieve_dial_data("Other");
+    EXPECT_STREQ(readBack->value, "199");
+    free_dial_data(&readBack);
+    DONE();
+}
+
 void test_dial_data_suite() {
     START_SUITE();
 
     test_read_dial_missing_data();
     test_write_dial_data();
     test_write_kv_larger_than_max_len();
+    test_write_dial_data_unwritable_dir();
+    test_dial_data_writer();
+    test_dial_data_writer_order();
 }
\ No newline at end of file
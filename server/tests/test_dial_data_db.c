@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../dial_data_db.h"
+#include "../url_lib.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_dial_data_db.h"
+
+#define TEST_DB DIAL_DATA_DIR "test_dial_data.db"
+
+static off_t file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? st.st_size : -1;
+}
+
+void test_db_store_reopen() {
+    unlink(TEST_DB);
+    EXPECT(open_dial_data_db(TEST_DB), "store should be created");
+
+    // Spaces and long values are kept as is.
+    char long_value[1000];
+    memset(long_value, 'v', sizeof(long_value) - 1);
+    long_value[sizeof(long_value) - 1] = '\0';
+    char *strings;
+    DIALData *data = alloc_dial_data(2, 1024 + 16, &strings);
+    data->key = strcpy(strings, "a b");
+    data->value = strcpy(strings + 4, long_value);
+    data->next->key = strcpy(strings + 4 + sizeof(long_value), "c");
+    data->next->value = strcpy(strings + 6 + sizeof(long_value), "");
+    EXPECT(dial_data_db_store("app1", data), "app1 should be stored");
+    free_dial_data(&data);
+    EXPECT(dial_data_db_store("app2", NULL), "app2 should be stored");
+
+    close_dial_data_db();
+    EXPECT(!is_dial_data_db_open(), "store should be closed");
+    EXPECT(open_dial_data_db(TEST_DB), "store should reopen");
+
+    int found;
+    data = dial_data_db_retrieve("app1", &found);
+    EXPECT_EQ(found, 1);
+    EXPECT_STREQ(data->key, "a b");
+    EXPECT_STREQ(data->value, long_value);
+    EXPECT_STREQ(data->next->key, "c");
+    EXPECT_STREQ(data->next->value, "");
+    EXPECT(NULL == data->next->next, "two entries expected");
+    free_dial_data(&data);
+
+    data = dial_data_db_retrieve("app2", &found);
+    EXPECT_EQ(found, 1);
+    EXPECT(NULL == data, "app2 has no data");
+    data = dial_data_db_retrieve("app3", &found);
+    EXPECT_EQ(found, 0);
+
+    close_dial_data_db();
+    DONE();
+}
+
+void test_db_torn_append() {
+    unlink(TEST_DB);
+    EXPECT(open_dial_data_db(TEST_DB), "store should be created");
+    DIALData *data = parse_params("a=1");
+    dial_data_db_store("app1", data);
+    free_dial_data(&data);
+    close_dial_data_db();
+    off_t size = file_size(TEST_DB);
+
+    // A partially appended record is discarded.
+    int fd = open(TEST_DB, O_WRONLY | O_APPEND);
+    EXPECT(write(fd, "\x40\0\0\0garbage", 11) == 11, "garbage should be appended");
+    close(fd);
+    EXPECT(open_dial_data_db(TEST_DB), "store should reopen");
+    EXPECT_EQ(file_size(TEST_DB), size);
+
+    int found;
+    data = dial_data_db_retrieve("app1", &found);
+    EXPECT_STREQ(data->value, "1");
+    free_dial_data(&data);
+    close_dial_data_db();
+
+    // A file that is not a store is left alone.
+    fd = open(TEST_DB, O_WRONLY | O_TRUNC);
+    EXPECT(write(fd, "not a store, not at all, no", 27) == 27, "file should be written");
+    close(fd);
+    EXPECT(!open_dial_data_db(TEST_DB), "store should be rejected");
+    EXPECT_EQ(file_size(TEST_DB), 27);
+    DONE();
+}
+
+void test_db_compaction() {
+    unlink(TEST_DB);
+    EXPECT(open_dial_data_db(TEST_DB), "store should be created");
+    char query[64];
+    for (int i = 0; i < 2000; i++) {
+        snprintf(query, sizeof(query), "key=%d&other=%d", i, i);
+        DIALData *data = parse_params(query);
+        dial_data_db_store(i % 2 ? "app1" : "app2", data);
+        free_dial_data(&data);
+    }
+    // Superseded records are compacted away as the file grows.
+    EXPECT(file_size(TEST_DB) < 64 * 1024 + 1024, "store should be compacted");
+    EXPECT(compact_dial_data_db(), "store should be compacted");
+    EXPECT(file_size(TEST_DB) < 256, "only the latest records are kept");
+
+    close_dial_data_db();
+    EXPECT(open_dial_data_db(TEST_DB), "store should reopen");
+    int found;
+    DIALData *data = dial_data_db_retrieve("app1", &found);
+    EXPECT_STREQ(data->value, "1999");
+    free_dial_data(&data);
+    data = dial_data_db_retrieve("app2", &found);
+    EXPECT_STREQ(data->next->value, "1998");
+    free_dial_data(&data);
+
+    // Appends after the directory are found too.
+    data = parse_params("key=new");
+    dial_data_db_store("app1", data);
+    free_dial_data(&data);
+    close_dial_data_db();
+    EXPECT(open_dial_data_db(TEST_DB), "store should reopen");
+    data = dial_data_db_retrieve("app1", &found);
+    EXPECT_STREQ(data->value, "new");
+    free_dial_data(&data);
+    close_dial_data_db();
+    DONE();
+}
+
+void test_db_migration() {
+    unlink(TEST_DB);
+    DIALData *data = parse_params("old=1");
+    store_dial_data("MigratedApp", data);
+    free_dial_data(&data);
+
+    // The per application file is moved into the store on first retrieval.
+    EXPECT(open_dial_data_db(TEST_DB), "store should be created");
+    data = retrieve_dial_data("MigratedApp");
+    EXPECT_STREQ(data->key, "old");
+    free_dial_data(&data);
+    EXPECT_EQ(file_size(DIAL_DATA_DIR "MigratedApp"), -1);
+
+    data = parse_params("new=2");
+    store_dial_data("MigratedApp", data);
+    free_dial_data(&data);
+    EXPECT_EQ(file_size(DIAL_DATA_DIR "MigratedApp"), -1);
+    close_dial_data_db();
+    EXPECT(open_dial_data_db(TEST_DB), "store should reopen");
+    data = retrieve_dial_data("MigratedApp");
+    EXPECT_STREQ(data->key, "new");
+    free_dial_data(&data);
+
+    close_dial_data_db();
+    unlink(TEST_DB);
+    DONE();
+}
+
+void test_dial_data_db_suite() {
+    START_SUITE();
+
+    test_db_store_reopen();
+    test_db_torn_append();
+    test_db_compaction();
+    test_db_migration();
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../dial_data_store.h"
+#include "../url_lib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "test_dial_data_store.h"
+
+void test_store_set_get_delete() {
+    DIALDataStore *store = dial_data_store_create(0, 0, kDIALDataQuotaReject);
+    EXPECT(store != NULL, "store should be created");
+
+    EXPECT_EQ(dial_data_store_set(store, "a", "1"), 1);
+    EXPECT_EQ(dial_data_store_set(store, "b", "2"), 1);
+    EXPECT_EQ(dial_data_store_set(store, "c", "3"), 1);
+    EXPECT_STREQ(dial_data_store_get(store, "b"), "2");
+    EXPECT(NULL == dial_data_store_get(store, "d"), "d is not stored");
+
+    // Updating a key keeps its position.
+    EXPECT_EQ(dial_data_store_set(store, "a", "longer"), 1);
+    EXPECT_STREQ(dial_data_store_first(store)->key, "a");
+    EXPECT_STREQ(dial_data_store_first(store)->value, "longer");
+    EXPECT_EQ(dial_data_store_bytes(store), 11);
+
+    EXPECT_EQ(dial_data_store_delete(store, "b"), 1);
+    EXPECT_EQ(dial_data_store_delete(store, "b"), 0);
+    EXPECT_EQ(dial_data_store_count(store), 2);
+    const DIALDataEntry *entry = dial_data_store_first(store);
+    EXPECT_STREQ(entry->key, "a");
+    EXPECT_STREQ(entry->next->key, "c");
+    EXPECT(NULL == entry->next->next, "two entries expected");
+
+    dial_data_store_free(&store);
+    EXPECT(NULL == store, "store should be cleared");
+    DONE();
+}
+
+void test_store_many_keys() {
+    DIALDataStore *store = dial_data_store_create(0, 0, kDIALDataQuotaReject);
+    char key[16], value[16];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(key, "k%d", i);
+        sprintf(value, "v%d", i);
+        EXPECT_EQ(dial_data_store_set(store, key, value), 1);
+    }
+    for (int i = 0; i < 1000; i += 7) {
+        sprintf(key, "k%d", i);
+        sprintf(value, "v%d", i);
+        EXPECT_STREQ(dial_data_store_get(store, key), value);
+    }
+    int i = 0;
+    for (const DIALDataEntry *entry = dial_data_store_first(store); entry; entry = entry->next, i++) {
+        sprintf(key, "k%d", i);
+        EXPECT_STREQ(entry->key, key);
+    }
+    EXPECT_EQ(i, 1000);
+    dial_data_store_free(&store);
+    DONE();
+}
+
+void test_store_quota_reject() {
+    DIALDataStore *store = dial_data_store_create(2, 8, kDIALDataQuotaReject);
+    EXPECT_EQ(dial_data_store_set(store, "a", "1"), 1);
+    EXPECT_EQ(dial_data_store_set(store, "b", "2"), 1);
+    EXPECT_EQ(dial_data_store_set(store, "c", "3"), 0);
+    EXPECT_EQ(dial_data_store_set(store, "a", "123456"), 0);
+    EXPECT_EQ(dial_data_store_set(store, "a", "12345"), 1);
+    EXPECT_EQ(dial_data_store_count(store), 2);
+
+    // A rejected replacement leaves the store unchanged.
+    DIALData *data = parse_params("x=1&y=2&z=3");
+    EXPECT_EQ(dial_data_store_replace(store, data), 0);
+    free_dial_data(&data);
+    EXPECT_STREQ(dial_data_store_get(store, "a"), "12345");
+
+    data = parse_params("x=1&y=2");
+    EXPECT_EQ(dial_data_store_replace(store, data), 1);
+    free_dial_data(&data);
+    EXPECT(NULL == dial_data_store_get(store, "a"), "a was replaced");
+    EXPECT_STREQ(dial_data_store_get(store, "y"), "2");
+
+    EXPECT_EQ(dial_data_store_replace(store, NULL), 1);
+    EXPECT_EQ(dial_data_store_count(store), 0);
+    dial_data_store_free(&store);
+    DONE();
+}
+
+void test_store_quota_evict() {
+    DIALDataStore *store = dial_data_store_create(3, 0, kDIALDataQuotaEvictOldest);
+    DIALData *data = parse_params("a=1&b=2&c=3&d=4&e=5");
+    EXPECT_EQ(dial_data_store_replace(store, data), 1);
+    free_dial_data(&data);
+    EXPECT_EQ(dial_data_store_count(store), 3);
+    EXPECT_STREQ(dial_data_store_first(store)->key, "c");
+
+    // Updating a key keeps its insertion position, so it is still evicted
+    // first.
+    EXPECT_EQ(dial_data_store_set(store, "c", "33"), 1);
+    EXPECT_EQ(dial_data_store_set(store, "f", "6"), 1);
+    EXPECT_STREQ(dial_data_store_first(store)->key, "d");
+    EXPECT(NULL == dial_data_store_get(store, "c"), "c should be evicted");
+
+    // Byte quota evicts as many entries as needed.
+    EXPECT_EQ(dial_data_store_set_quota(store, 0, 4, kDIALDataQuotaEvictOldest), 1);
+    EXPECT_EQ(dial_data_store_count(store), 2);
+    EXPECT_EQ(dial_data_store_set(store, "g", "777"), 1);
+    EXPECT_EQ(dial_data_store_count(store), 1);
+    EXPECT_EQ(dial_data_store_set(store, "h", "toolong"), 0);
+
+    DIALData *list = dial_data_store_to_list(store);
+    EXPECT_STREQ(list->key, "g");
+    EXPECT_STREQ(list->value, "777");
+    EXPECT(NULL == list->next, "one entry expected");
+    free_dial_data(&list);
+    dial_data_store_free(&store);
+    DONE();
+}
+
+void test_dial_data_store_suite() {
+    START_SUITE();
+    test_store_set_get_delete();
+    test_store_many_keys();
+    test_store_quota_reject();
+    test_store_quota_evict();
+}
@@ -0,0 +1,754 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../child_reaper.h"
+#include "../dial_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_dial_server.h"
+
+static struct DIALAppCallbacks gNoCallbacks;
+
+/**
+ * Connect to the DIAL server on the loopback interface and send a request,
+ * or the start of one.
+ *
+ * @return the connected socket, or -1 on error.
+ */
+static int http_send(DIALServer *ds, const char *request) {
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(DIAL_get_port(ds));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd == -1 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+        write(fd, request, strlen(request)) != (ssize_t) strlen(request)) {
+        if (fd != -1) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Send a request to the DIAL server on the loopback interface and read the
+ * response until the server closes the connection.
+ *
+ * @return the response status code, or -1 on error.
+ */
+static int http_request(DIALServer *ds, const char *request, char *response,
+                        size_t response_size) {
+    int fd = http_send(ds, request), status = -1;
+    size_t len = 0;
+    ssize_t n;
+
+    if (fd == -1) {
+        return -1;
+    }
+    while (len + 1 < response_size &&
+           (n = read(fd, response + len, response_size - len - 1)) > 0) {
+        len += n;
+    }
+    response[len] = '\0';
+    close(fd);
+    sscanf(response, "HTTP/1.1 %d", &status);
+    return status;
+}
+
+static int http_get(DIALServer *ds, const char *uri, char *response, size_t response_size) {
+    char request[512];
+    snprintf(request, sizeof(request),
+             "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n", uri);
+    return http_request(ds, request, response, response_size);
+}
+
+static DIALStatus stopped_status(DIALServer *ds, const char *app_name,
+                                 DIAL_run_t run_id, int *pCanStop,
+                                 void *callback_data) {
+    *pCanStop = 1;
+    return kDIALStatusStopped;
+}
+
+static DIALStatus counted_status(DIALServer *ds, const char *app_name,
+                                 DIAL_run_t run_id, int *pCanStop,
+                                 void *callback_data) {
+    (*(int *) callback_data)++;
+    *pCanStop = 1;
+    return kDIALStatusStopped;
+}
+
+static int lazy_provider(DIALServer *ds, const char *app_name,
+                         struct DIALAppRegistration *registration,
+                         void *provider_data) {
+    (*(int *) provider_data)++;
+    if (strncmp(app_name, "Lazy", 4) != 0) {
+        return 0;
+    }
+    registration->callbacks.status_cb = stopped_status;
+    registration->corsAllowedOrigin = "https://lazy.example.com";
+    return 1;
+}
+
+static DIALStatus short_lived_start(DIALServer *ds, const char *app_name,
+                                    const char *payload, const char *query_string,
+                                    const char *additionalDataUrl,
+                                    DIAL_run_t *run_id, void *callback_data) {
+    pid_t pid = child_reaper_fork(ds, app_name);
+    if (pid == 0) {
+        usleep(100 * 1000);
+        _exit(0);
+    }
+    *run_id = (DIAL_run_t) (long) pid;
+    *(pid_t *) callback_data = pid;
+    return pid > 0 ? kDIALStatusRunning : kDIALStatusError;
+}
+
+static DIALStatus running_start(DIALServer *ds, const char *app_name,
+                                const char *payload, const char *query_string,
+                                const char *additionalDataUrl,
+                                DIAL_run_t *run_id, void *callback_data) {
+    snprintf((char *) callback_data, 256, "%s", additionalDataUrl);
+    return kDIALStatusRunning;
+}
+
+static pthread_mutex_t gGateMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gGateCond = PTHREAD_COND_INITIALIZER;
+static int gGateClosed;
+static int gHeldClosed;
+static int gServed;
+
+static DIALStatus held_status(DIALServer *ds, const char *app_name,
+                              DIAL_run_t run_id, int *pCanStop,
+                              void *callback_data) {
+    pthread_mutex_lock(&gGateMutex);
+    while (gHeldClosed) {
+        pthread_cond_wait(&gGateCond, &gGateMutex);
+    }
+    pthread_mutex_unlock(&gGateMutex);
+    *pCanStop = 1;
+    return kDIALStatusStopped;
+}
+
+static DIALStatus gated_status(DIALServer *ds, const char *app_name,
+                               DIAL_run_t run_id, int *pCanStop,
+                               void *callback_data) {
+    pthread_mutex_lock(&gGateMutex);
+    while (gGateClosed) {
+        pthread_cond_wait(&gGateCond, &gGateMutex);
+    }
+    gServed++;
+    pthread_mutex_unlock(&gGateMutex);
+    *pCanStop = 1;
+    return kDIALStatusStopped;
+}
+
+static DIALStatus ordered_start(DIALServer *ds, const char *app_name,
+                                const char *payload, const char *query_string,
+                                const char *additionalDataUrl,
+                                DIAL_run_t *run_id, void *callback_data) {
+    pthread_mutex_lock(&gGateMutex);
+    *(int *) callback_data = ++gServed;
+    pthread_mutex_unlock(&gGateMutex);
+    return kDIALStatusRunning;
+}
+
+static DIALStatus counted_start(DIALServer *ds, const char *app_name,
+                                const char *payload, const char *query_string,
+                                const char *additionalDataUrl,
+                                DIAL_run_t *run_id, void *callback_data) {
+    (*(int *) callback_data)++;
+    *run_id = (DIAL_run_t) 1;
+    return kDIALStatusRunning;
+}
+
+void test_register_many_apps() {
+    DIALServer *ds = DIAL_create();
+    char name[32];
+
+    // Origin lists are no longer limited in length.
+    char cors[1024] = "";
+    while (strlen(cors) < sizeof(cors) - 32) {
+        strcat(cors, "https://www.example.com ");
+    }
+    strcat(cors, "https://last.example.com");
+
+    for (int i = 0; i < 2000; i++) {
+        snprintf(name, sizeof(name), "TestApp%d", i);
+        EXPECT_EQ(DIAL_register_app(ds, name, &gNoCallbacks, NULL, 1, cors), 1);
+    }
+    EXPECT_EQ(DIAL_register_app(ds, "TestApp1234", &gNoCallbacks, NULL, 1, cors), 0);
+    EXPECT_STREQ(DIAL_get_payload(ds, "TestApp1999"), "");
+    EXPECT(NULL == DIAL_get_payload(ds, "TestApp2000"), "not registered");
+
+    for (int i = 0; i < 2000; i++) {
+        snprintf(name, sizeof(name), "TestApp%d", i);
+        EXPECT_EQ(DIAL_unregister_app(ds, name), 1);
+    }
+    EXPECT_EQ(DIAL_unregister_app(ds, "TestApp0"), 0);
+    free(ds);
+    DONE();
+}
+
+void test_app_data_and_payload() {
+    DIALServer *ds = DIAL_create();
+    EXPECT_EQ(DIAL_register_app(ds, "TestDataApp", &gNoCallbacks, NULL, 1, NULL), 1);
+
+    // The payload reference stays valid after the application is gone.
+    const char *payload = DIAL_acquire_payload(ds, "TestDataApp");
+    EXPECT_STREQ(payload, "");
+    EXPECT(NULL == DIAL_acquire_payload(ds, "Unknown"), "not registered");
+
+    EXPECT_EQ(DIAL_set_app_data(ds, "TestDataApp", "key", "value"), 1);
+    EXPECT_EQ(DIAL_delete_app_data(ds, "TestDataApp", "key"), 1);
+    EXPECT_EQ(DIAL_delete_app_data(ds, "TestDataApp", "key"), 0);
+    EXPECT_EQ(DIAL_set_app_data(ds, "Unknown", "key", "value"), -1);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "TestDataApp"), 1);
+    EXPECT_STREQ(payload, "");
+    DIAL_release_payload(payload);
+    unlink(DIAL_DATA_DIR "TestDataApp");
+    free(ds);
+    DONE();
+}
+
+void test_app_provider() {
+    DIALServer *ds = DIAL_create();
+    char response[4096];
+    int calls = 0;
+
+    DIAL_set_port(ds, 0);
+    DIAL_set_app_provider(ds, lazy_provider, &calls, 2);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    // Provided on first use, then registered.
+    EXPECT_EQ(http_get(ds, "/apps/Lazy1", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "<name>Lazy1</name>") != NULL, "status expected");
+    EXPECT_EQ(http_get(ds, "/apps/Lazy1", response, sizeof(response)), 200);
+    EXPECT_EQ(calls, 1);
+    EXPECT_STREQ(DIAL_get_payload(ds, "Lazy1"), "");
+
+    // Unknown names are remembered.
+    EXPECT_EQ(http_get(ds, "/apps/Missing", response, sizeof(response)), 404);
+    EXPECT_EQ(http_get(ds, "/apps/Missing", response, sizeof(response)), 404);
+    EXPECT_EQ(calls, 2);
+
+    // The least recently used provided application makes room for another.
+    EXPECT_EQ(http_get(ds, "/apps/Lazy2", response, sizeof(response)), 200);
+    EXPECT_EQ(http_get(ds, "/apps/Lazy1", response, sizeof(response)), 200);
+    EXPECT_EQ(http_get(ds, "/apps/Lazy3", response, sizeof(response)), 200);
+    EXPECT_EQ(calls, 4);
+    EXPECT(NULL == DIAL_get_payload(ds, "Lazy2"), "Lazy2 should be evicted");
+    EXPECT_STREQ(DIAL_get_payload(ds, "Lazy1"), "");
+
+    // Registering an application the provider did not know makes it known.
+    EXPECT_EQ(DIAL_register_app(ds, "Missing", &gNoCallbacks, NULL, 0, NULL), 1);
+    EXPECT(NULL != DIAL_get_payload(ds, "Missing"), "Missing is registered");
+    EXPECT_EQ(DIAL_unregister_app(ds, "Missing"), 1);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Lazy1"), 1);
+    EXPECT_EQ(DIAL_unregister_app(ds, "Lazy3"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_app_state_pushed() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppRegistration registration;
+    char response[4096];
+    int calls = 0;
+
+    memset(&registration, 0, sizeof(registration));
+    registration.callbacks.status_cb = counted_status;
+    registration.callback_data = &calls;
+    registration.statePushed = 1;
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app_ex(ds, "Pushed", &registration), 1);
+    EXPECT_EQ(DIAL_register_app_ex(ds, "Pushed", &registration), 0);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    EXPECT_EQ(http_get(ds, "/apps/Pushed?clientDialVer=2.2", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "<state>stopped</state>") != NULL, "stopped expected");
+    EXPECT(strstr(response, "allowStop=\"false\"") != NULL, "cannot stop yet");
+
+    EXPECT_EQ(DIAL_report_state(ds, "Pushed", kDIALStatusHide, (DIAL_run_t) 1, 1), 1);
+    EXPECT_EQ(http_get(ds, "/apps/Pushed?clientDialVer=2.2", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "<state>hidden</state>") != NULL, "hidden expected");
+    EXPECT(strstr(response, "allowStop=\"true\"") != NULL, "can stop");
+    EXPECT_EQ(DIAL_report_state(ds, "Pushed", kDIALStatusRunning, (DIAL_run_t) 1, 1), 1);
+    EXPECT_EQ(http_get(ds, "/apps/Pushed", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "<state>running</state>") != NULL, "running expected");
+
+    // The status callback is never called.
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(DIAL_report_state(ds, "Unknown", kDIALStatusRunning, NULL, 1), -1);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Pushed"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_apps_status_batch() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { NULL, NULL, NULL, counted_status };
+    char response[4096];
+    int calls = 0;
+
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app(ds, "BatchA", &callbacks, &calls, 1, NULL), 1);
+    EXPECT_EQ(DIAL_register_app(ds, "BatchB", &callbacks, &calls, 1,
+                                "https://b.example.com"), 1);
+    EXPECT_EQ(DIAL_set_app_data(ds, "BatchA", "key", "value"), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    EXPECT_EQ(http_get(ds, "/apps", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "<services ") != NULL, "services expected");
+    EXPECT(strstr(response, "<name>BatchA</name>") != NULL, "BatchA expected");
+    EXPECT(strstr(response, "<name>BatchB</name>") != NULL, "BatchB expected");
+    EXPECT(strstr(response, "<key>value</key>") != NULL, "additionalData expected");
+    EXPECT_EQ(calls, 2);
+
+    EXPECT_EQ(http_get(ds, "/apps/?names=BatchB,Unknown", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "<name>BatchA</name>") == NULL, "BatchA not requested");
+    EXPECT(strstr(response, "<name>BatchB</name>") != NULL, "BatchB expected");
+    EXPECT(strstr(response, "allowStop=\"true\"") != NULL, "can stop");
+
+    // Applications that do not allow the origin are left out.
+    EXPECT_EQ(http_request(ds, "GET /apps HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                           "Origin: https://a.example.com\r\nConnection: close\r\n\r\n",
+                           response, sizeof(response)), 200);
+    EXPECT(strstr(response, "<name>BatchA</name>") != NULL, "BatchA allows any origin");
+    EXPECT(strstr(response, "<name>BatchB</name>") == NULL, "BatchB does not");
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "BatchA"), 1);
+    EXPECT_EQ(DIAL_unregister_app(ds, "BatchB"), 1);
+    DIAL_stop(ds);
+    unlink(DIAL_DATA_DIR "BatchA");
+    free(ds);
+    DONE();
+}
+
+static void *report_running_later(void *arg) {
+    usleep(50 * 1000);
+    DIAL_report_state((DIALServer *) arg, "Watched", kDIALStatusRunning, (DIAL_run_t) 1, 1);
+    return NULL;
+}
+
+void test_app_state_watch() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppRegistration registration;
+    struct sockaddr_in addr;
+    char response[4096];
+    pthread_t thread;
+
+    memset(&registration, 0, sizeof(registration));
+    registration.statePushed = 1;
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app_ex(ds, "Watched", &registration), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+    EXPECT_EQ(http_get(ds, "/apps/Watched", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "ETag: \"0\"") != NULL, "ETag expected");
+    // No origin was sent, so none is allowed.
+    EXPECT(strstr(response, "Access-Control-Allow-Origin") == NULL, "no origin expected");
+
+    // Answered once the state changes.
+    EXPECT_EQ(pthread_create(&thread, NULL, report_running_later, ds), 0);
+    EXPECT_EQ(http_get(ds, "/apps/Watched?watch=0", response, sizeof(response)), 200);
+    pthread_join(thread, NULL);
+    EXPECT(strstr(response, "<state>running</state>") != NULL, "running expected");
+    EXPECT(strstr(response, "ETag: \"1\"") != NULL, "new ETag expected");
+
+    // Answered right away if the client is behind.
+    EXPECT_EQ(http_get(ds, "/apps/Watched?watch=%220%22", response, sizeof(response)), 200);
+    EXPECT(strstr(response, "ETag: \"1\"") != NULL, "current ETag expected");
+
+    // An event stream gets an event per change.
+    const char *request = "GET /apps/Watched?watch=1&clientDialVer=2.2 HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                          "Accept: text/event-stream\r\n\r\n";
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(DIAL_get_port(ds));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    EXPECT_EQ(connect(fd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+    EXPECT_EQ(write(fd, request, strlen(request)), (ssize_t) strlen(request));
+    ssize_t len = read(fd, response, sizeof(response) - 1);
+    EXPECT(len > 0, "headers expected");
+    response[len] = '\0';
+    EXPECT(strstr(response, "text/event-stream") != NULL, "event stream expected");
+    EXPECT(strstr(response, "Access-Control-Allow-Origin") == NULL, "no origin expected");
+    for (int i = 2; i <= 3; i++) {
+        char event[64];
+        EXPECT_EQ(DIAL_report_state(ds, "Watched", i == 2 ? kDIALStatusHide : kDIALStatusStopped,
+                                    (DIAL_run_t) 1, 1), 1);
+        len = read(fd, response, sizeof(response) - 1);
+        EXPECT(len > 0, "event expected");
+        response[len] = '\0';
+        snprintf(event, sizeof(event), "id: %d\nevent: state\ndata: %s\n\n", i,
+                 i == 2 ? "hidden" : "stopped");
+        EXPECT_STREQ(response, event);
+    }
+    close(fd);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Watched"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_app_exit_reported() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { short_lived_start, NULL, NULL, stopped_status };
+    char response[4096];
+    pid_t pid = 0;
+
+    child_reaper_block_signal();
+    EXPECT(start_child_reaper(), "reaper should start");
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app(ds, "ShortLived", &callbacks, &pid, 0, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+    EXPECT_EQ(http_request(ds, "POST /apps/ShortLived HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                           "Content-Length: 0\r\nConnection: close\r\n\r\n",
+                           response, sizeof(response)), 201);
+
+    // The application is stopped by the reaper once the child exits.
+    EXPECT(pid > 0, "child expected");
+    EXPECT_EQ(child_reaper_exited(pid, NULL, NULL), 0);
+    for (int i = 0; i < 200 && child_reaper_exited(pid, NULL, NULL) != 1; i++) {
+        usleep(5 * 1000);
+    }
+    EXPECT_EQ(child_reaper_exited(pid, NULL, NULL), 1);
+    usleep(50 * 1000);
+    EXPECT_EQ(DIAL_app_exited(ds, "ShortLived", (DIAL_run_t) (long) pid), 0);
+    EXPECT_EQ(DIAL_app_exited(ds, "Unknown", (DIAL_run_t) (long) pid), -1);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "ShortLived"), 1);
+    DIAL_stop(ds);
+    stop_child_reaper();
+    free(ds);
+    DONE();
+}
+
+void test_prebuilt_responses() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { running_start, NULL, NULL, stopped_status };
+    char response[4096], location[128], additional_data_url[256] = "";
+    const char launch[] = "POST /apps/Prebuilt HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                          "Origin: https://a.example.com\r\n"
+                          "Content-Length: 0\r\nConnection: close\r\n\r\n";
+
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app(ds, "Prebuilt", &callbacks, additional_data_url, 1, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+    snprintf(location, sizeof(location),
+             "Location: http://127.0.0.1:%d/apps/Prebuilt/run\r\n", DIAL_get_port(ds));
+
+    // The launch responses are built once and reused.
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(http_request(ds, launch, response, sizeof(response)), 201);
+        EXPECT(strstr(response, location) != NULL, "Location expected");
+        EXPECT(strstr(response, "Access-Control-Allow-Origin: https://a.example.com\r\n\r\n")
+               != NULL, "origin expected");
+        EXPECT(strstr(additional_data_url, "%2Fapps%2FPrebuilt%2Fdial_data") != NULL,
+               "additionalDataUrl expected");
+    }
+
+    EXPECT_EQ(http_request(ds, "OPTIONS /apps/Prebuilt/run HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                           "Connection: close\r\n\r\n", response, sizeof(response)), 204);
+    EXPECT(strstr(response, "Access-Control-Allow-Methods: DELETE, OPTIONS\r\n") != NULL,
+           "methods expected");
+    EXPECT(strstr(response, "\r\n\r\n") != NULL, "end of headers expected");
+
+    EXPECT_EQ(http_get(ds, "/apps/Unknown", response, sizeof(response)), 404);
+    EXPECT(strstr(response, "Content-Length: 21\r\n") != NULL, "Content-Length expected");
+    EXPECT(strstr(response, "\r\n\r\nError 404: Not Found\n") != NULL, "body expected");
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Prebuilt"), 1);
+    DIAL_stop(ds);
+    unlink(DIAL_DATA_DIR "Prebuilt");
+    free(ds);
+    DONE();
+}
+
+void test_expect_continue() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { running_start, NULL, NULL, stopped_status };
+    char response[4096], additional_data_url[256];
+    struct timeval timeout = { 1, 0 };
+    ssize_t n;
+    int fd;
+
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app(ds, "Continued", &callbacks, additional_data_url, 0, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    // The body is asked for once the request is accepted.
+    fd = http_send(ds, "POST /apps/Continued HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                       "Expect: 100-continue\r\nContent-Length: 5\r\n"
+                       "Connection: close\r\n\r\n");
+    EXPECT(fd != -1, "connected");
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    n = read(fd, response, sizeof(response) - 1);
+    response[n > 0 ? n : 0] = '\0';
+    EXPECT(strcmp(response, "HTTP/1.1 100 Continue\r\n\r\n") == 0, "100 Continue expected");
+    EXPECT_EQ(write(fd, "a=b&c", 5), 5);
+    n = read(fd, response, sizeof(response) - 1);
+    response[n > 0 ? n : 0] = '\0';
+    EXPECT(strncmp(response, "HTTP/1.1 201 Created\r\n", 22) == 0, "201 Created expected");
+    close(fd);
+
+    // An oversized body is refused without being asked for.
+    fd = http_send(ds, "POST /apps/Continued HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                       "Expect: 100-continue\r\nContent-Length: 100000\r\n"
+                       "Connection: close\r\n\r\n");
+    EXPECT(fd != -1, "connected");
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    n = read(fd, response, sizeof(response) - 1);
+    response[n > 0 ? n : 0] = '\0';
+    EXPECT(strncmp(response, "HTTP/1.1 413 ", 13) == 0, "413 expected");
+    close(fd);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Continued"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_stalled_clients() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { NULL, NULL, NULL, stopped_status };
+    char response[4096];
+    int stalled[8];
+
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app(ds, "Stalled", &callbacks, NULL, 0, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    // More clients than workers stop halfway through their request.
+    for (size_t i = 0; i < sizeof(stalled) / sizeof(stalled[0]); i++) {
+        stalled[i] = http_send(ds, "GET /apps/Stalled HTTP/1.1\r\n");
+        EXPECT(stalled[i] != -1, "connected");
+    }
+    EXPECT_EQ(http_get(ds, "/apps/Stalled", response, sizeof(response)), 200);
+    for (size_t i = 0; i < sizeof(stalled) / sizeof(stalled[0]); i++) {
+        close(stalled[i]);
+    }
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Stalled"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_silent_clients() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { NULL, NULL, NULL, stopped_status };
+    char response[4096];
+    int silent[40];
+
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app(ds, "Silent", &callbacks, NULL, 0, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    // More clients than are waited on connect and send nothing.
+    for (size_t i = 0; i < sizeof(silent) / sizeof(silent[0]); i++) {
+        silent[i] = http_send(ds, "");
+        EXPECT(silent[i] != -1, "connected");
+    }
+    EXPECT_EQ(http_get(ds, "/apps/Silent", response, sizeof(response)), 200);
+    for (size_t i = 0; i < sizeof(silent) / sizeof(silent[0]); i++) {
+        close(silent[i]);
+    }
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Silent"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_request_lanes() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks held = { NULL, NULL, NULL, held_status };
+    struct DIALAppCallbacks polled = { NULL, NULL, NULL, gated_status };
+    struct DIALAppCallbacks launched = { ordered_start, NULL, NULL, stopped_status };
+    char response[4096];
+    int holds[3], polls[9], launch, launch_order = 0;
+    const char poll_request[] = "GET /apps/Polled HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                                "Connection: close\r\n\r\n";
+
+    DIAL_set_port(ds, 0);
+    EXPECT_EQ(DIAL_register_app(ds, "Held", &held, NULL, 0, NULL), 1);
+    EXPECT_EQ(DIAL_register_app(ds, "Polled", &polled, NULL, 0, NULL), 1);
+    EXPECT_EQ(DIAL_register_app(ds, "Launched", &launched, &launch_order, 0, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    // Hold all the workers but one, which serves a status poll until the
+    // gate opens, so the queued requests are then served one at a time.
+    gHeldClosed = 1;
+    gGateClosed = 1;
+    gServed = 0;
+    for (size_t i = 0; i < sizeof(holds) / sizeof(holds[0]); i++) {
+        holds[i] = http_send(ds, "GET /apps/Held HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                                 "Connection: close\r\n\r\n");
+        EXPECT(holds[i] != -1, "connected");
+    }
+    polls[0] = http_send(ds, poll_request);
+    usleep(200 * 1000);
+
+    // More polls queue up ahead of the launch.
+    for (size_t i = 1; i < sizeof(polls) / sizeof(polls[0]); i++) {
+        polls[i] = http_send(ds, poll_request);
+        EXPECT(polls[i] != -1, "connected");
+    }
+    launch = http_send(ds, "POST /apps/Launched HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                           "Content-Length: 0\r\nConnection: close\r\n\r\n");
+    EXPECT(launch != -1, "connected");
+    usleep(200 * 1000);
+    pthread_mutex_lock(&gGateMutex);
+    gGateClosed = 0;
+    pthread_cond_broadcast(&gGateCond);
+    pthread_mutex_unlock(&gGateMutex);
+
+    // The free worker serves the launch right after its poll.
+    EXPECT(read(launch, response, sizeof(response)) > 0, "launch response expected");
+    EXPECT_EQ(launch_order, 2);
+    close(launch);
+
+    pthread_mutex_lock(&gGateMutex);
+    gHeldClosed = 0;
+    pthread_cond_broadcast(&gGateCond);
+    pthread_mutex_unlock(&gGateMutex);
+    for (size_t i = 0; i < sizeof(polls) / sizeof(polls[0]); i++) {
+        EXPECT(read(polls[i], response, sizeof(response)) > 0, "poll response expected");
+        close(polls[i]);
+    }
+    for (size_t i = 0; i < sizeof(holds) / sizeof(holds[0]); i++) {
+        EXPECT(read(holds[i], response, sizeof(response)) > 0, "held response expected");
+        close(holds[i]);
+    }
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Held"), 1);
+    EXPECT_EQ(DIAL_unregister_app(ds, "Polled"), 1);
+    EXPECT_EQ(DIAL_unregister_app(ds, "Launched"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_rate_limited_launches() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { counted_start, NULL, NULL, stopped_status };
+    char response[4096];
+    const char launch[] = "POST /apps/Limited HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                          "Content-Length: 0\r\nConnection: close\r\n\r\n";
+    int starts = 0;
+
+    DIAL_set_port(ds, 0);
+    // A bucket without tokens would refuse everything.
+    EXPECT_EQ(DIAL_set_rate_limit(ds, kDIALRateLaunch, 1, 0), 0);
+    EXPECT_EQ(DIAL_set_rate_limit(ds, kDIALRateLaunch, 1, 2), 1);
+    EXPECT_EQ(DIAL_register_app(ds, "Limited", &callbacks, &starts, 0, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    EXPECT_EQ(http_request(ds, launch, response, sizeof(response)), 201);
+    EXPECT_EQ(http_request(ds, launch, response, sizeof(response)), 201);
+    EXPECT_EQ(http_request(ds, launch, response, sizeof(response)), 429);
+    EXPECT(strstr(response, "Retry-After: 1\r\n") != NULL, "Retry-After expected");
+    EXPECT_EQ(starts, 2);
+
+    // Status polls have their own bucket.
+    EXPECT_EQ(http_get(ds, "/apps/Limited", response, sizeof(response)), 200);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Limited"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_launch_debounce() {
+    DIALServer *ds = DIAL_create();
+    struct DIALAppCallbacks callbacks = { counted_start, NULL, NULL, stopped_status };
+    char response[4096];
+    const char launch[] = "POST /apps/Debounced HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                          "Content-Length: 3\r\nConnection: close\r\n\r\na=b";
+    const char other_launch[] = "POST /apps/Debounced HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                                "Content-Length: 3\r\nConnection: close\r\n\r\nc=d";
+    int starts = 0;
+
+    DIAL_set_port(ds, 0);
+    DIAL_set_launch_debounce(ds, 60 * 1000);
+    EXPECT_EQ(DIAL_register_app(ds, "Debounced", &callbacks, &starts, 0, NULL), 1);
+    EXPECT(DIAL_start(ds), "server should start");
+
+    // A repeated launch gets the first one's result.
+    EXPECT_EQ(http_request(ds, launch, response, sizeof(response)), 201);
+    EXPECT_EQ(http_request(ds, launch, response, sizeof(response)), 201);
+    EXPECT(strstr(response, "/apps/Debounced/run\r\n") != NULL, "Location expected");
+    EXPECT_EQ(starts, 1);
+
+    // Another payload, or the application stopped, starts it again.
+    EXPECT_EQ(http_request(ds, other_launch, response, sizeof(response)), 201);
+    EXPECT_EQ(starts, 2);
+    EXPECT_EQ(http_get(ds, "/apps/Debounced", response, sizeof(response)), 200);
+    EXPECT_EQ(http_request(ds, other_launch, response, sizeof(response)), 201);
+    EXPECT_EQ(starts, 3);
+
+    EXPECT_EQ(DIAL_unregister_app(ds, "Debounced"), 1);
+    DIAL_stop(ds);
+    free(ds);
+    DONE();
+}
+
+void test_dial_server_suite() {
+    START_SUITE();
+
+    test_register_many_apps();
+    test_app_data_and_payload();
+    test_app_provider();
+    test_app_state_pushed();
+    test_app_state_watch();
+    test_apps_status_batch();
+    test_prebuilt_responses();
+    test_expect_continue();
+    test_request_lanes();
+    test_silent_clients();
+    test_stalled_clients();
+    test_rate_limited_launches();
+    test_launch_debounce();
+    test_app_exit_reported();
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../http_watch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_http_watch.h"
+
+typedef struct {
+    int calls;
+    int timeouts;
+} WatchCounts;
+
+static WatchCounts gCounts;
+
+static int counted_watch(int sock, void *data, int timed_out) {
+    __atomic_add_fetch(timed_out ? &gCounts.timeouts : &gCounts.calls, 1, __ATOMIC_SEQ_CST);
+    return http_watch_send(sock, "x", 1);
+}
+
+static int wait_for(int *counter, int value) {
+    for (int i = 0; i < 200 && __atomic_load_n(counter, __ATOMIC_SEQ_CST) < value; i++) {
+        usleep(5000);
+    }
+    return __atomic_load_n(counter, __ATOMIC_SEQ_CST);
+}
+
+void test_http_watch_notify() {
+    int fds[2];
+    char buf[8];
+    void *data = malloc(1);
+
+    memset(&gCounts, 0, sizeof(gCounts));
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    EXPECT_EQ(http_watch_add(fds[0], 100, counted_watch, data), 0);
+    free(data);
+    EXPECT_EQ(start_http_watch(), 1);
+
+    // Called once when parked, then after every notification.
+    EXPECT_EQ(http_watch_add(fds[0], 300, counted_watch, malloc(1)), 1);
+    EXPECT_EQ(wait_for(&gCounts.calls, 1), 1);
+    http_watch_notify();
+    EXPECT_EQ(wait_for(&gCounts.calls, 2), 2);
+    EXPECT_EQ(read(fds[1], buf, sizeof(buf)), 2);
+
+    // The connection is closed once the watch times out.
+    EXPECT_EQ(wait_for(&gCounts.timeouts, 1), 1);
+    EXPECT_EQ(read(fds[1], buf, sizeof(buf)), 1);
+    EXPECT_EQ(read(fds[1], buf, sizeof(buf)), 0);
+    close(fds[1]);
+
+    // A client hanging up ends its watch.
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    EXPECT_EQ(http_watch_add(fds[0], 60000, counted_watch, malloc(1)), 1);
+    EXPECT_EQ(wait_for(&gCounts.calls, 3), 3);
+    close(fds[1]);
+    usleep(20000);
+    http_watch_notify();
+    usleep(20000);
+    EXPECT_EQ(gCounts.calls, 3);
+    stop_http_watch();
+    DONE();
+}
+
+void test_http_watch_suite() {
+    START_SUITE();
+    test_http_watch_notify();
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../launcher.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_launcher.h"
+
+/**
+ * Run a shell script with the write end of a pipe as descriptor 3, and read
+ * what it writes there.
+ *
+ * @return the exit status of the script, or -1 if it was not launched.
+ */
+static int run_script(const char *script, char * const env[], char *output, size_t size) {
+    char * const argv[] = { "sh", "-c", (char *) script, NULL };
+    int fds[2], status = -1;
+    ssize_t n, len = 0;
+
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    pid_t pid = launch_process("/bin/sh", argv, env, &fds[1], 1);
+    close(fds[1]);
+    while (len + 1 < (ssize_t) size && (n = read(fds[0], output + len, size - len - 1)) > 0) {
+        len += n;
+    }
+    output[len] = '\0';
+    close(fds[0]);
+    if (pid > 0) {
+        waitpid(pid, &status, 0);
+    }
+    return pid > 0 ? status : -1;
+}
+
+void test_launch_environment() {
+    char output[256];
+    char * const env[] = { "NF_DATA_DIR=/data", "HOME=/nowhere", NULL };
+
+    setenv("HOME", "/home/test", 1);
+    EXPECT_EQ(run_script("echo \"$NF_DATA_DIR $HOME\" >&3", env, output, sizeof(output)), 0);
+    EXPECT_STREQ(output, "/data /nowhere\n");
+    EXPECT_EQ(run_script("echo \"$HOME\" >&3", NULL, output, sizeof(output)), 0);
+    EXPECT_STREQ(output, "/home/test\n");
+    DONE();
+}
+
+void test_launch_descriptors() {
+    char output[256], script[128];
+
+    // A descriptor the server leaves open is not inherited.
+    int fd = fcntl(STDIN_FILENO, F_DUPFD, 10);
+    EXPECT(fd != -1, "dup failed");
+    snprintf(script, sizeof(script),
+             "[ -e /proc/self/fd/%d ] && echo leaked >&3 || echo closed >&3", fd);
+    EXPECT_EQ(run_script(script, NULL, output, sizeof(output)), 0);
+    close(fd);
+    EXPECT_STREQ(output, "closed\n");
+
+    EXPECT_EQ(launch_process("/nonexistent", (char * const []) { "x", NULL }, NULL, NULL, 0), -1);
+    DONE();
+}
+
+void test_launcher_suite() {
+    START_SUITE();
+    test_launch_environment();
+    test_launch_descriptors();
+}
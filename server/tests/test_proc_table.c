@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../proc_table.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_proc_table.h"
+
+static pid_t spawn_sleep(const char *seconds) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/bin/sleep", "sleep", seconds, (char *) NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+static void kill_and_reap(pid_t pid) {
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+void test_proc_table_register() {
+    int handle = proc_table_register("sleep", "^sleep 17\\.25$");
+    EXPECT(handle >= 0, "pattern not registered");
+    EXPECT_EQ(proc_table_register("sleep", "^sleep 17\\.25$"), handle);
+    EXPECT(proc_table_register("sleep", NULL) != handle, "same handle");
+    EXPECT_EQ(proc_table_register("sleep", "(unbalanced"), -1);
+    EXPECT_EQ(proc_table_find(-1), 0);
+    EXPECT_EQ(proc_table_find(PROC_TABLE_MAX_PATTERNS), 0);
+    proc_table_clear();
+    DONE();
+}
+
+void test_proc_table_find() {
+    int handle = proc_table_register("sleep", "^sleep 17\\.25$");
+    int other = proc_table_register("sleep", "^sleep 17\\.5$");
+    EXPECT_EQ(proc_table_find(handle), 0);
+
+    pid_t pid = spawn_sleep("17.25");
+    usleep(50 * 1000);
+    proc_table_invalidate();
+    EXPECT_EQ(proc_table_find(handle), pid);
+    EXPECT_EQ(proc_table_find(other), 0);
+
+    // A pattern registered after the snapshot was taken is matched too.
+    int any = proc_table_register("sleep", NULL);
+    EXPECT(proc_table_find(any) != 0, "sleep not found");
+
+    // Lookups are answered from the snapshot until the interval elapses.
+    proc_table_set_refresh_interval(60 * 1000);
+    kill_and_reap(pid);
+    EXPECT_EQ(proc_table_find(handle), pid);
+    proc_table_invalidate();
+    EXPECT_EQ(proc_table_find(handle), 0);
+
+    proc_table_set_refresh_interval(0);
+    pid = spawn_sleep("17.25");
+    usleep(50 * 1000);
+    EXPECT_EQ(proc_table_find(handle), pid);
+    kill_and_reap(pid);
+    EXPECT_EQ(proc_table_find(handle), 0);
+
+    proc_table_set_refresh_interval(PROC_TABLE_REFRESH_MS);
+    proc_table_clear();
+    DONE();
+}
+
+void test_proc_table_exec() {
+    int handle = proc_table_register("sleep", "^sleep 17\\.25$");
+    proc_table_set_refresh_interval(0);
+
+    // The process is classified before and again after it executes sleep.
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    pid_t pid = fork();
+    if (pid == 0) {
+        char c;
+        close(fds[1]);
+        if (read(fds[0], &c, 1) == 1) {
+            execl("/bin/sleep", "sleep", "17.25", (char *) NULL);
+        }
+        _exit(127);
+    }
+    close(fds[0]);
+    EXPECT_EQ(proc_table_find(handle), 0);
+    EXPECT_EQ(write(fds[1], "x", 1), 1);
+    close(fds[1]);
+    usleep(50 * 1000);
+    pid_t found = proc_table_find(handle);
+    kill_and_reap(pid);
+    EXPECT_EQ(found, pid);
+
+    proc_table_set_refresh_interval(PROC_TABLE_REFRESH_MS);
+    proc_table_clear();
+    DONE();
+}
+
+void test_proc_table_suite() {
+    START_SUITE();
+    test_proc_table_register();
+    test_proc_table_find();
+    test_proc_table_exec();
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../proc_table.h"
+#include "../proc_watch.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_proc_watch.h"
+
+/*
+ * Dummy applications are sleep processes with a distinctive duration. The
+ * process table is only walked when invalidated, so the lookups below only
+ * see what the watcher reports.
+ */
+#define DUMMY_APP "^sleep 17\\.75$"
+
+static pid_t spawn_dummy() {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/bin/sleep", "sleep", "17.75", (char *) NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+/**
+ * Wait up to a second for the lookup of a pattern to return pid.
+ */
+static pid_t wait_for(int handle, pid_t pid) {
+    pid_t found = proc_table_find(handle);
+    for (int i = 0; i < 200 && found != pid; i++) {
+        usleep(5 * 1000);
+        found = proc_table_find(handle);
+    }
+    return found;
+}
+
+void test_proc_watch_events() {
+    int handle = proc_table_register("sleep", DUMMY_APP);
+    if (start_proc_watch(1) != kProcWatchEvents) {
+        stop_proc_watch();
+        proc_table_clear();
+        printf("  process connector not available, skipped\n");
+        DONE();
+        return;
+    }
+    EXPECT_EQ(proc_table_find(handle), 0);
+
+    // Started outside of the server.
+    pid_t pid = spawn_dummy();
+    EXPECT_EQ(wait_for(handle, pid), pid);
+
+    // Not running any more as soon as it exits, before it is reaped.
+    kill(pid, SIGKILL);
+    EXPECT_EQ(wait_for(handle, 0), 0);
+    waitpid(pid, NULL, 0);
+
+    // Running once it executes the application, and not once it executes
+    // something else.
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    pid = fork();
+    if (pid == 0) {
+        char c;
+        close(fds[1]);
+        if (read(fds[0], &c, 1) == 1) {
+            execl("/bin/sh", "sleep", "-c", "exec sleep 17.75", (char *) NULL);
+        }
+        _exit(127);
+    }
+    close(fds[0]);
+    usleep(50 * 1000);
+    EXPECT_EQ(proc_table_find(handle), 0);
+    EXPECT_EQ(write(fds[1], "x", 1), 1);
+    close(fds[1]);
+    pid_t found = wait_for(handle, pid);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    EXPECT_EQ(found, pid);
+
+    stop_proc_watch();
+    proc_table_clear();
+    DONE();
+}
+
+void test_proc_watch_exits() {
+    int handle = proc_table_register("sleep", DUMMY_APP);
+    EXPECT_EQ(start_proc_watch(0), kProcWatchExits);
+    proc_table_set_refresh_interval(60 * 1000);
+
+    pid_t pid = spawn_dummy();
+    usleep(50 * 1000);
+    proc_table_invalidate();
+    EXPECT_EQ(proc_table_find(handle), pid);
+
+    kill(pid, SIGKILL);
+    pid_t found = wait_for(handle, 0);
+    waitpid(pid, NULL, 0);
+    EXPECT_EQ(found, 0);
+
+    stop_proc_watch();
+    proc_table_set_refresh_interval(PROC_TABLE_REFRESH_MS);
+    proc_table_clear();
+    DONE();
+}
+
+void test_proc_watch_suite() {
+    START_SUITE();
+    test_proc_watch_events();
+    test_proc_watch_exits();
+}
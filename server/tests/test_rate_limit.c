@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../rate_limit.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_rate_limit.h"
+
+static const RateLimit gLimits[] = {
+    { 10, 3 },      // 10 per second, 3 at once
+    { 0, 0 },       // no limit
+};
+
+void test_burst_then_limited() {
+    RateLimiter *limiter = rate_limiter_create(gLimits, 2, 16);
+    unsigned int retry_after_ms = 0;
+
+    EXPECT(limiter != NULL, "limiter expected");
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(rate_limiter_take(limiter, 1, 0, &retry_after_ms), 1);
+    }
+    EXPECT_EQ(rate_limiter_take(limiter, 1, 0, &retry_after_ms), 0);
+    EXPECT(retry_after_ms > 0 && retry_after_ms <= 100, "a token within 100 ms");
+
+    // Other clients and other classes have their own buckets.
+    EXPECT_EQ(rate_limiter_take(limiter, 2, 0, &retry_after_ms), 1);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(rate_limiter_take(limiter, 1, 1, &retry_after_ms), 1);
+    }
+
+    // The bucket refills over time.
+    usleep(150 * 1000);
+    EXPECT_EQ(rate_limiter_take(limiter, 1, 0, &retry_after_ms), 1);
+    rate_limiter_free(&limiter);
+    EXPECT(limiter == NULL, "limiter freed");
+    DONE();
+}
+
+void test_least_recently_seen_evicted() {
+    RateLimiter *limiter = rate_limiter_create(gLimits, 1, 1);
+    unsigned int retry_after_ms;
+
+    // A single set: the client seen least recently is forgotten, and gets a
+    // full bucket when it comes back.
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(rate_limiter_take(limiter, 1, 0, &retry_after_ms), 1);
+    }
+    EXPECT_EQ(rate_limiter_take(limiter, 1, 0, &retry_after_ms), 0);
+    for (uint32_t client = 100; client < 200; client++) {
+        rate_limiter_take(limiter, client, 0, &retry_after_ms);
+    }
+    EXPECT_EQ(rate_limiter_take(limiter, 1, 0, &retry_after_ms), 1);
+    rate_limiter_free(&limiter);
+    DONE();
+}
+
+void test_rate_limit_suite() {
+    START_SUITE();
+
+    test_burst_then_limited();
+    test_least_recently_seen_evicted();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../rcu.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "test_rcu.h"
+
+typedef struct {
+    RcuHead rcu;
+    int value;
+} Item;
+
+static int freed;
+
+static void free_item(RcuHead *head) {
+    freed++;
+    free(head);
+}
+
+static Item *new_item(int value) {
+    Item *item = (Item *) calloc(1, sizeof(Item));
+    item->value = value;
+    return item;
+}
+
+void test_rcu_retire_without_readers() {
+    freed = 0;
+    rcu_retire(&new_item(1)->rcu, free_item);
+    EXPECT_EQ(freed, 1);
+    DONE();
+}
+
+void test_rcu_retire_with_reader() {
+    Item *shared = new_item(1);
+    freed = 0;
+
+    // Nested sections keep the data alive until the outermost one ends.
+    rcu_read_lock();
+    rcu_read_lock();
+    Item *seen = rcu_dereference(shared);
+    rcu_assign_pointer(shared, new_item(2));
+    rcu_retire(&seen->rcu, free_item);
+    rcu_read_unlock();
+    rcu_reclaim();
+    EXPECT_EQ(freed, 0);
+    EXPECT_EQ(seen->value, 1);
+    rcu_read_unlock();
+    rcu_reclaim();
+    EXPECT_EQ(freed, 1);
+
+    // A section entered after the data was retired does not hold it.
+    rcu_read_lock();
+    Item *old = shared;
+    shared = new_item(3);
+    rcu_retire(&old->rcu, free_item);
+    EXPECT_EQ(freed, 1);
+    rcu_read_unlock();
+    rcu_read_lock();
+    rcu_reclaim();
+    EXPECT_EQ(freed, 2);
+    rcu_read_unlock();
+
+    free(shared);
+    DONE();
+}
+
+static Item *gShared;
+static int gStop;
+
+static void *reader_thread(void *arg) {
+    long sum = 0;
+    while (!__atomic_load_n(&gStop, __ATOMIC_ACQUIRE)) {
+        rcu_read_lock();
+        Item *item = rcu_dereference(gShared);
+        sum += item->value;
+        rcu_read_unlock();
+    }
+    return (void *) sum;
+}
+
+void test_rcu_concurrent_readers() {
+    pthread_t threads[4];
+    gShared = new_item(0);
+    gStop = 0;
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, reader_thread, NULL);
+    }
+    // Any use after free is caught by the address sanitizer.
+    for (int i = 1; i <= 10000; i++) {
+        Item *old = gShared;
+        rcu_assign_pointer(gShared, new_item(i));
+        rcu_retire(&old->rcu, free_item);
+    }
+    __atomic_store_n(&gStop, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    rcu_reclaim();
+    free(gShared);
+    DONE();
+}
+
+void test_rcu_suite() {
+    START_SUITE();
+
+    test_rcu_retire_without_readers();
+    test_rcu_retire_with_reader();
+    test_rcu_concurrent_readers();
+}
@@ -60,6 +60,36 @@ void test_urldecode() {
     DONE();
 }
 
+void test_url_decode_xml_encode() {
+    char dest[128] = {0, };
+    char *end;
+
+    char *param = "%3Ca+b%3E%26%22'x";
+    EXPECT_EQ(url_decode_xml_encode_len(param), strlen("&lt;a b&gt;&amp;&quot;&apos;x"));
+    end = url_decode_xml_encode(dest, param);
+    EXPECT_STREQ(dest, "&lt;a b&gt;&amp;&quot;&apos;x");
+    EXPECT_EQ((size_t) (end - dest), url_decode_xml_encode_len(param));
+
+    // Every escaped quote expands to six characters.
+    param = "%22%22%22";
+    EXPECT_EQ(url_decode_xml_encode_len(param), 18);
+    url_decode_xml_encode(dest, param);
+    EXPECT_STREQ(dest, "&quot;&quot;&quot;");
+
+    // Malformed and NULL escapes end the string.
+    param = "ab%2";
+    EXPECT_EQ(url_decode_xml_encode_len(param), 2);
+    url_decode_xml_encode(dest, param);
+    EXPECT_STREQ(dest, "ab");
+    param = "a<%00b";
+    EXPECT_EQ(url_decode_xml_encode_len(param), 5);
+    url_decode_xml_encode(dest, param);
+    EXPECT_STREQ(dest, "a&lt;");
+
+    EXPECT_EQ(url_decode_xml_encode_len(""), 0);
+    DONE();
+}
+
 void test_parse_app_name() {
     char *app_name;
     EXPECT((app_name = parse_app_name(NULL)), "Failed to extract app_name");
@@ -100,10 +130,21 @@ void test_parse_params() {
     free_dial_data(&result);
 
     result = parse_params("?a=b&c=d");
-    EXPECT_STREQ(result->key, "c");
-    EXPECT_STREQ(result->value, "d");
-    EXPECT_STREQ(result->next->key, "a");
-    EXPECT_STREQ(result->next->value, "b");
+    EXPECT_STREQ(result->key, "a");
+    EXPECT_STREQ(result->value, "b");
+    EXPECT_STREQ(result->next->key, "c");
+    EXPECT_STREQ(result->next->value, "d");
+    EXPECT(NULL == result->next->next, "two params expected");
+    free_dial_data(&result);
+
+    result = parse_params("a=1&b=2&&a=3&c=x=y");
+    EXPECT_STREQ(result->key, "a");
+    EXPECT_STREQ(result->value, "3");
+    EXPECT_STREQ(result->next->key, "b");
+    EXPECT_STREQ(result->next->value, "2");
+    EXPECT_STREQ(result->next->next->key, "c");
+    EXPECT_STREQ(result->next->next->value, "x=y");
+    EXPECT(NULL == result->next->next->next, "three params expected");
     free_dial_data(&result);
 
     result = parse_params("ሳ=€");
@@ -114,7 +155,7 @@ void test_parse_params() {
     char query_string[1024] = {0, };
     char *current = query_string;
     for (int i = 0; i < 25; ++i) {
-        current = smartstrncpy(current, "a=b&", 256);
+        current += sprintf(current, "a%d=b&", i);
     }
     result = parse_params(query_string);
     int length = 0;
@@ -124,12 +165,22 @@ void test_parse_params() {
     EXPECT((length == 25), "25 params should have been parsed");
     free_dial_data(&result);
 
+    current = query_string;
+    for (int i = 0; i < 25; ++i) {
+        current = smartstrncpy(current, "a=b&", 256);
+    }
+    result = parse_params(query_string);
+    EXPECT(result && NULL == result->next, "duplicate params should be merged");
+    free_dial_data(&result);
+
     DONE();
 }
 
 void test_parse_params_malformatted() {
     EXPECT(NULL == parse_params("abcdefghijkl"), "no params expected");
     EXPECT(NULL == parse_params("\u2639"), "no params expected");
+    EXPECT(NULL == parse_params("a=b&=c"), "no params expected");
+    EXPECT(NULL == parse_params("a=b&c="), "no params expected");
     DONE();
 }
 
@@ -137,6 +188,7 @@ void test_url_lib_suite() {
     START_SUITE();
     test_smartstrncpy();
     test_urldecode();
+    test_url_decode_xml_encode();
     test_parse_app_name();
     test_parse_params();
     test_parse_params_malformatted();
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../launcher.h"
+#include "../warm_app.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_warm_app.h"
+
+#define LAUNCH_FILE "/tmp/test_warm_app.launch"
+
+/**
+ * Return the state letter of a process from /proc, once it is or is not
+ * stopped as expected, or after a second.
+ */
+static char process_state(pid_t pid, int stopped) {
+    char path[64], state = '?';
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+    for (int i = 0; i < 200; i++) {
+        FILE *f = fopen(path, "r");
+        if (f == NULL || fscanf(f, "%*d %*s %c", &state) != 1) {
+            state = '?';
+        }
+        if (f != NULL) {
+            fclose(f);
+        }
+        if ((state == 'T') == stopped) {
+            break;
+        }
+        usleep(5 * 1000);
+    }
+    return state;
+}
+
+/**
+ * Read what the script wrote to its pipe so far, waiting for the first line.
+ */
+static void read_output(int fd, char *output, size_t size) {
+    ssize_t n = read(fd, output, size - 1);
+    output[n > 0 ? n : 0] = '\0';
+}
+
+void test_warm_app_resume() {
+    const char *script = "trap 'cat \"$LAUNCH\" >&3' USR1; echo ready >&3; "
+                         "while :; do sleep 1 & wait $!; done";
+    const char * const args[] = { "/bin/sh", "-c", script, NULL };
+    const char * const new_args[] = { "/bin/sh", "-c", script, "again", NULL };
+    char * const env[] = { "LAUNCH=" LAUNCH_FILE, NULL };
+    char output[512];
+    int fds[2], status = 0;
+    WarmApp app;
+
+    warm_app_init(&app, LAUNCH_FILE, SIGUSR1);
+    EXPECT_EQ(pipe(fds), 0);
+    pid_t pid = launch_process("/bin/sh", (char * const *) args, env, &fds[1], 1);
+    close(fds[1]);
+    EXPECT(pid > 0, "launch failed");
+    warm_app_started(&app, pid, args);
+    read_output(fds[0], output, sizeof(output));
+    EXPECT_STREQ(output, "ready\n");
+    EXPECT_EQ(warm_app_hidden(&app), 0);
+    EXPECT_EQ(warm_app_resume(&app, args), -1);
+
+    // Launching again with the same arguments only resumes the process.
+    EXPECT_EQ(warm_app_hide(&app, pid), 1);
+    EXPECT_EQ(warm_app_hidden(&app), pid);
+    EXPECT_EQ(process_state(pid, 1), 'T');
+    EXPECT_EQ(warm_app_resume(&app, args), 1);
+    EXPECT_EQ(warm_app_hidden(&app), 0);
+    EXPECT(process_state(pid, 0) != 'T', "process still stopped");
+
+    // New arguments are written to the launch file.
+    EXPECT_EQ(warm_app_hide(&app, pid), 1);
+    EXPECT_EQ(warm_app_resume(&app, new_args), 1);
+    read_output(fds[0], output, sizeof(output));
+    EXPECT(strstr(output, "-c\n") == output && strstr(output, "\nagain\n") != NULL,
+           "launch file not read");
+
+    // Without a resume signal the process cannot take them.
+    app.resume_signal = 0;
+    EXPECT_EQ(warm_app_hide(&app, pid), 1);
+    EXPECT_EQ(warm_app_resume(&app, args), 0);
+
+    // A hidden process is resumed to act on a stop signal.
+    EXPECT_EQ(warm_app_hide(&app, pid), 1);
+    kill(pid, SIGTERM);
+    warm_app_stopping(&app);
+    EXPECT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT(WIFSIGNALED(status) && WTERMSIG(status) == SIGTERM, "unexpected exit status");
+    EXPECT_EQ(warm_app_hide(&app, pid), 0);
+    close(fds[0]);
+    unlink(LAUNCH_FILE);
+    warm_app_free(&app);
+    EXPECT_EQ(warm_app_hide(&app, getpid()), 0);
+    DONE();
+}
+
+void test_warm_app_suite() {
+    START_SUITE();
+    test_warm_app_resume();
+}
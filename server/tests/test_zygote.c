@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../zygote.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "test_zygote.h"
+
+void test_zygote_launch() {
+    char script[128];
+    int status = -1;
+
+    // A descriptor open when the zygote is forked is not inherited either.
+    int fd = fcntl(STDIN_FILENO, F_DUPFD, 10);
+    EXPECT(fd != -1, "dup failed");
+    snprintf(script, sizeof(script), "[ -e /proc/self/fd/%d ] && exit 1; exit $ZYGOTE_STATUS", fd);
+
+    int shell = zygote_add_template("/bin/sh", (const char * const []) { "-c", NULL },
+                                    (const char * const []) { "ZYGOTE_STATUS=7", NULL });
+    int missing = zygote_add_template("/nonexistent", NULL, NULL);
+    EXPECT(shell != -1 && missing != -1, "templates not added");
+    EXPECT_EQ(zygote_find_template("/bin/sh"), -1);
+    EXPECT_EQ(start_zygote(), 1);
+    close(fd);
+    EXPECT_EQ(zygote_find_template("/bin/sh"), shell);
+    EXPECT_EQ(zygote_find_template("/bin/true"), -1);
+
+    // The process is a child of the caller, not of the zygote.
+    pid_t pid = zygote_spawn(shell, (const char * const []) { script, NULL });
+    EXPECT(pid > 0, "launch failed");
+    EXPECT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 7, "unexpected exit status");
+
+    EXPECT_EQ(zygote_spawn(missing, NULL), -1);
+    stop_zygote();
+    EXPECT_EQ(zygote_find_template("/bin/sh"), -1);
+    EXPECT_EQ(zygote_spawn(shell, NULL), -1);
+    DONE();
+}
+
+void test_zygote_suite() {
+    START_SUITE();
+    test_zygote_launch();
+}
@@ -142,6 +142,112 @@ void xmlencode(char *dst, const char *src, size_t max_size) {
     *dst = '\0';
 }
 
+/*
+ * Number of extra bytes needed to XML-escape each character, on top of the
+ * character itself.
+ */
+static const unsigned char xml_extra_len[256] = {
+    ['&'] = sizeof("&amp;") - 2,
+    ['\"'] = sizeof("&quot;") - 2,
+    ['\''] = sizeof("&apos;") - 2,
+    ['<'] = sizeof("&lt;") - 2,
+    ['>'] = sizeof("&gt;") - 2,
+};
+
+/**
+ * Decode the URL escape sequence starting at src, which must point to a '%'
+ * character.
+ *
+ * @param src the escape sequence.
+ * @param c the decoded character.
+ * @return 1 if the sequence was valid and did not decode to a NULL
+ *         character, 0 otherwise.
+ */
+static int decode_escape(const char *src, char *c) {
+    return src[1] && append_char_from_hex(c, src[1], src[2]) && *c != '\0';
+}
+
+/**
+ * XML-escape a single character into dest.
+ *
+ * @return a pointer past the last character written.
+ */
+static char *append_xml_char(char *dst, char c) {
+    switch (c) {
+        case '&':
+            memcpy(dst, "&amp;", 5);
+            return dst + 5;
+        case '\"':
+            memcpy(dst, "&quot;", 6);
+            return dst + 6;
+        case '\'':
+            memcpy(dst, "&apos;", 6);
+            return dst + 6;
+        case '<':
+            memcpy(dst, "&lt;", 4);
+            return dst + 4;
+        case '>':
+            memcpy(dst, "&gt;", 4);
+            return dst + 4;
+        default:
+            *dst = c;
+            return dst + 1;
+    }
+}
+
+size_t url_decode_xml_encode_len(const char *src) {
+    size_t len = 0;
+    char c;
+
+    for (;;) {
+        // Runs of characters that need no escaping are measured by strcspn(),
+        // which is vectorized by the C library; '+' decodes to a single
+        // space so it needs no special handling here.
+        size_t run = strcspn(src, "%&<>\"'");
+        len += run;
+        src += run;
+        if (*src == '\0') {
+            break;
+        }
+        if (*src == '%') {
+            if (!decode_escape(src, &c)) {
+                break;
+            }
+            src += 3;
+        } else {
+            c = *src++;
+        }
+        len += 1 + xml_extra_len[(unsigned char) c];
+    }
+    return len;
+}
+
+char *url_decode_xml_encode(char *dst, const char *src) {
+    char c;
+
+    for (;;) {
+        size_t run = strcspn(src, "%+&<>\"'");
+        memcpy(dst, src, run);
+        dst += run;
+        src += run;
+        if (*src == '\0') {
+            break;
+        }
+        if (*src == '%') {
+            if (!decode_escape(src, &c)) {
+                break;
+            }
+            src += 3;
+        } else {
+            c = (*src == '+') ? ' ' : *src;
+            src++;
+        }
+        dst = append_xml_char(dst, c);
+    }
+    *dst = '\0';
+    return dst;
+}
+
 char *parse_app_name(const char *uri) {
     char *unknown = NULL;
     if (uri == NULL) {
@@ -207,47 +313,60 @@ DIALData *parse_params(char * query_string) {
     if (query_string[0] == '?') {
         query_string++;  // skip leading question mark
     }
-    DIALData *result = NULL;
-    int err = 0;
-    char *query_string_dup = strdup(query_string);
-    char * name_value = strtok(query_string_dup, "&");
-    while (name_value != NULL) {
-        DIALData *tmp = (DIALData *) malloc(sizeof(DIALData));
-        if (tmp == NULL) {
-            err = 1;
-            break;
-        }
-        size_t name_value_length = strlen(name_value);
-        tmp->key = (char *) calloc(name_value_length + 1, sizeof(char));
-        if (tmp->key == NULL) {
-            free(tmp); tmp = NULL;
-            err = 1;
-            break;
-        }
-        tmp->value = (char *) calloc(name_value_length + 1, sizeof(char));
-        if (tmp->value == NULL) {
-            free(tmp->key); tmp->key = NULL;
-            free(tmp); tmp = NULL;
-            err = 1;
-            break;
+
+    // There is at most one name/value pair per '&' separator, plus one.
+    size_t query_length = 0, max_pairs = 1;
+    for (const char *c = query_string; *c; c++, query_length++) {
+        if (*c == '&') {
+            max_pairs++;
         }
-        int match = sscanf(name_value, "%[^=]=%s", tmp->key, tmp->value);
-        if (match != 2) {
-            free(tmp->value); tmp->value = NULL;
-            free(tmp->key); tmp->key = NULL;
-            free(tmp); tmp = NULL;
-            err = 1;
-            break;
+    }
+
+    // The nodes point into a single copy of the query string, which is split
+    // in place.
+    char *strings;
+    DIALData *result = alloc_dial_data(max_pairs, query_length + 1, &strings);
+    if (result == NULL) {
+        return NULL;
+    }
+    memcpy(strings, query_string, query_length + 1);
+
+    size_t count = 0;
+    char *name_value = strings;
+    while (name_value != NULL) {
+        char *next = strchr(name_value, '&');
+        if (next != NULL) {
+            *next++ = '\0';
         }
-        tmp->next = result;
-        result = tmp;
+        if (*name_value != '\0') {  // skip empty pairs, e.g. "a=b&&c=d"
+            char *value = strchr(name_value, '=');
+            if (value == NULL || value == name_value || value[1] == '\0') {
+                free_dial_data(&result);
+                return NULL;
+            }
+            *value++ = '\0';
 
-        name_value = strtok(NULL, "&");  // read next token
+            // A repeated key keeps its first position and takes the last value.
+            DIALData *node = NULL;
+            for (size_t i = 0; i < count; i++) {
+                if (!strcmp(result[i].key, name_value)) {
+                    node = &result[i];
+                    break;
+                }
+            }
+            if (node == NULL) {
+                node = &result[count++];
+                node->key = name_value;
+            }
+            node->value = value;
+        }
+        name_value = next;
     }
-    free(query_string_dup);
-    if (err) {
-        free_dial_data(&result); result = NULL;
+    if (count == 0) {
+        free_dial_data(&result);
+        return NULL;
     }
+    result[count - 1].next = NULL;
     return result;
 }
 
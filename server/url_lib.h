@@ -72,6 +72,28 @@ int urldecode(char *dst, const char *src, size_t max_size);
  */
 void xmlencode(char *dst, const char *src, size_t max_size);
 
+/**
+ * Return the exact length of the string url_decode_xml_encode() produces for
+ * the provided source string, excluding the trailing NULL.
+ *
+ * @param src URL-escaped source string.
+ * @return the length of the URL-unescaped, then XML-escaped string.
+ */
+size_t url_decode_xml_encode_len(const char *src);
+
+/**
+ * URL-unescape the source string and XML-escape the result in a single pass.
+ * Like urldecode(), the output ends at the first malformed escape sequence
+ * or escaped NULL character.
+ *
+ * @param dst XML-escaped string buffer. Must be at least
+ *        url_decode_xml_encode_len(src) + 1 bytes long.
+ * @param src URL-escaped source string.
+ * @return a pointer to the end of the written string (the location of the
+ *         terminating NULL).
+ */
+char *url_decode_xml_encode(char *dst, const char *src);
+
 /**
  * Return the value in the query string for the requested parameter name.
  *
@@ -101,14 +123,15 @@ char *parse_app_name(const char *uri);
 
 /**
  * Return a linked list of DIAL data constructed from the name/value parameter
- * pairs of the provided query string.
+ * pairs of the provided query string, in the order they appear. A repeated
+ * key keeps its first position and takes the last value.
  *
- * This function must be called while holding a mutex and is not itself
- * thread-safe.
+ * The list and all of its strings are a single allocation.
  *
  * @param query_string the URL query string.
  * @return the DIAL data or NULL if there is none (e.g. parse error) or out-of-
- *         memory. The caller must free the returned memory.
+ *         memory. The caller must free the returned memory with
+ *         free_dial_data().
  */
 DIALData *parse_params(char * query_string);
 
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "warm_app.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "child_reaper.h"
+
+/**
+ * Join launch arguments, after the program, one per line.
+ *
+ * @return the joined arguments, or NULL if out-of-memory.
+ */
+static char *join_args(const char * const args[]) {
+    size_t len = 1;
+    for (size_t i = 1; args[0] != NULL && args[i] != NULL; i++) {
+        len += strlen(args[i]) + 1;
+    }
+    char *joined = (char *) malloc(len), *p = joined;
+    if (joined == NULL) {
+        return NULL;
+    }
+    for (size_t i = 1; args[0] != NULL && args[i] != NULL; i++) {
+        size_t arg_len = strlen(args[i]);
+        memcpy(p, args[i], arg_len);
+        p[arg_len] = '\n';
+        p += arg_len + 1;
+    }
+    *p = '\0';
+    return joined;
+}
+
+/**
+ * Return whether a process of the server has not exited.
+ */
+static int is_alive(pid_t pid) {
+    int exited = child_reaper_exited(pid, NULL, NULL);
+    return exited == 0 || (exited == -1 && kill(pid, 0) == 0);
+}
+
+/**
+ * Write the launch file of an application, replacing it at once.
+ *
+ * @return 1 if successful, 0 on I/O error.
+ */
+static int write_launch_file(WarmApp *app, const char *args) {
+    char temp_file[sizeof(app->launch_file) + 4];
+    snprintf(temp_file, sizeof(temp_file), "%s.tmp", app->launch_file);
+    FILE *f = fopen(temp_file, "we");
+    if (f == NULL) {
+        return 0;
+    }
+    int written = fputs(args, f) >= 0;
+    if (fclose(f) != 0 || !written || rename(temp_file, app->launch_file) != 0) {
+        remove(temp_file);
+        return 0;
+    }
+    return 1;
+}
+
+void warm_app_init(WarmApp *app, const char *launch_file, int resume_signal) {
+    memset(app, 0, sizeof(*app));
+    app->enabled = 1;
+    app->resume_signal = resume_signal;
+    snprintf(app->launch_file, sizeof(app->launch_file), "%s", launch_file);
+}
+
+void warm_app_free(WarmApp *app) {
+    free(app->args);
+    memset(app, 0, sizeof(*app));
+}
+
+void warm_app_started(WarmApp *app, pid_t pid, const char * const args[]) {
+    free(app->args);
+    app->pid = pid;
+    app->hidden = 0;
+    app->args = join_args(args);
+}
+
+int warm_app_hide(WarmApp *app, pid_t pid) {
+    if (!app->enabled || pid <= 0 || !is_alive(pid) || kill(pid, SIGSTOP) != 0) {
+        return 0;
+    }
+    if (pid != app->pid) {
+        free(app->args);
+        app->args = NULL;
+        app->pid = pid;
+    }
+    app->hidden = 1;
+    return 1;
+}
+
+pid_t warm_app_hidden(WarmApp *app) {
+    if (app->hidden && !is_alive(app->pid)) {
+        app->hidden = 0;
+    }
+    return app->hidden ? app->pid : 0;
+}
+
+int warm_app_resume(WarmApp *app, const char * const args[]) {
+    if (!warm_app_hidden(app)) {
+        return -1;
+    }
+    char *joined = join_args(args);
+    int resumed = joined != NULL && app->args != NULL && !strcmp(joined, app->args);
+    if (!resumed && joined != NULL && app->resume_signal && write_launch_file(app, joined)) {
+        free(app->args);
+        app->args = joined;
+        joined = NULL;
+        resumed = 1;
+        kill(app->pid, SIGCONT);
+        kill(app->pid, app->resume_signal);
+    } else {
+        kill(app->pid, SIGCONT);
+    }
+    free(joined);
+    app->hidden = 0;
+    return resumed;
+}
+
+void warm_app_stopping(WarmApp *app) {
+    if (warm_app_hidden(app)) {
+        kill(app->pid, SIGCONT);
+    }
+    app->hidden = 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Keeps hidden applications resident, so launching them again resumes them
+ * instead of starting a new process.
+ *
+ * Hiding an application suspends its process with SIGSTOP. Launching it again
+ * resumes it with SIGCONT. If the launch arguments changed, they are written
+ * to the launch file of the application, one per line, and the application is
+ * sent its resume signal to read them. An application without a resume
+ * signal cannot take new arguments while running.
+ *
+ * Calls for an application must be serialized, as the DIAL callbacks of an
+ * application are.
+ */
+
+#ifndef SRC_SERVER_WARM_APP_H_
+#define SRC_SERVER_WARM_APP_H_
+
+#include <sys/types.h>
+
+typedef struct {
+    int enabled;
+    int resume_signal;      // 0 if the application cannot take new arguments
+    char launch_file[256];
+    pid_t pid;              // last launched or hidden process, 0 if none
+    int hidden;
+    char *args;             // launch arguments of pid, NULL if unknown
+} WarmApp;
+
+/**
+ * Enable keeping an application resident while hidden.
+ *
+ * @param app the application.
+ * @param launch_file file new launch arguments are written to.
+ * @param resume_signal signal sent after writing the launch file, 0 if the
+ *        application cannot take new arguments.
+ */
+void warm_app_init(WarmApp *app, const char *launch_file, int resume_signal);
+
+/**
+ * Forget the process of an application and disable it.
+ */
+void warm_app_free(WarmApp *app);
+
+/**
+ * Record the process launched for an application.
+ *
+ * @param app the application.
+ * @param pid PID of the process.
+ * @param args NULL terminated launch arguments, args[0] being the program.
+ */
+void warm_app_started(WarmApp *app, pid_t pid, const char * const args[]);
+
+/**
+ * Suspend the process of an application.
+ *
+ * @param app the application.
+ * @param pid PID of the process, which may not be the last one launched.
+ * @return 1 if the process is suspended, 0 if the application is not enabled
+ *         or the process is not running.
+ */
+int warm_app_hide(WarmApp *app, pid_t pid);
+
+/**
+ * Look up whether an application is hidden.
+ *
+ * @return the PID of its suspended process, or 0 if it is not hidden or the
+ *         process exited.
+ */
+pid_t warm_app_hidden(WarmApp *app);
+
+/**
+ * Resume the process of a hidden application for a new launch.
+ *
+ * @param app the application.
+ * @param args NULL terminated launch arguments, args[0] being the program.
+ * @return 1 if the process was resumed with these arguments, 0 if it was
+ *         resumed but cannot take them, -1 if the application is not hidden.
+ */
+int warm_app_resume(WarmApp *app, const char * const args[]);
+
+/**
+ * Let the process of an application act on a signal sent to stop it, by
+ * resuming it if it is hidden.
+ */
+void warm_app_stopping(WarmApp *app);
+
+#endif /* SRC_SERVER_WARM_APP_H_ */
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#define _GNU_SOURCE
+#include "zygote.h"
+#include "launcher.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct {
+    char *path;
+    char **args;        // leading arguments, NULL terminated
+    size_t arg_count;
+    char **env;         // added variables, then the merged environment in the zygote
+} ZygoteTemplate;
+
+/*
+ * A launch request is the template id and the number of arguments, followed by
+ * the NULL terminated arguments. The reply is the PID, or -1 and an errno.
+ */
+typedef struct {
+    int32_t template_id;
+    uint32_t arg_count;
+} ZygoteRequest;
+
+typedef struct {
+    int32_t pid;
+    int32_t error;
+} ZygoteReply;
+
+static struct {
+    pthread_mutex_t lock;   // serializes requests on the socket
+    int fd;
+    pid_t pid;
+    size_t count;
+    ZygoteTemplate templates[ZYGOTE_MAX_TEMPLATES];
+} gZygote = { PTHREAD_MUTEX_INITIALIZER, -1, -1, 0 };
+
+/**
+ * Copy a NULL terminated string array.
+ *
+ * @param count receives the number of strings.
+ * @return the copy, or NULL if out-of-memory.
+ */
+static char **copy_strings(const char * const strings[], size_t *count) {
+    size_t n = 0;
+    while (strings != NULL && strings[n] != NULL) {
+        n++;
+    }
+    char **copy = (char **) calloc(n + 1, sizeof(char *));
+    if (copy == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if ((copy[i] = strdup(strings[i])) == NULL) {
+            while (i > 0) {
+                free(copy[--i]);
+            }
+            free(copy);
+            return NULL;
+        }
+    }
+    *count = n;
+    return copy;
+}
+
+static void free_strings(char **strings) {
+    for (size_t i = 0; strings != NULL && strings[i] != NULL; i++) {
+        free(strings[i]);
+    }
+    free(strings);
+}
+
+int zygote_add_template(const char *path, const char * const args[],
+                        const char * const env[]) {
+    if (gZygote.count == ZYGOTE_MAX_TEMPLATES || gZygote.fd != -1) {
+        return -1;
+    }
+    ZygoteTemplate *template = &gZygote.templates[gZygote.count];
+    size_t env_count;
+    template->path = strdup(path);
+    template->args = copy_strings(args, &template->arg_count);
+    template->env = copy_strings(env, &env_count);
+    if (template->path == NULL || template->args == NULL || template->env == NULL) {
+        free(template->path);
+        free_strings(template->args);
+        free_strings(template->env);
+        memset(template, 0, sizeof(*template));
+        return -1;
+    }
+    return (int) gZygote.count++;
+}
+
+int zygote_find_template(const char *path) {
+    if (gZygote.fd == -1) {
+        return -1;
+    }
+    for (size_t i = 0; i < gZygote.count; i++) {
+        if (!strcmp(gZygote.templates[i].path, path)) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Replace the added variables of a template with the environment of the
+ * zygote merged with them, so launches pass it as is.
+ *
+ * @return 1 if successful, 0 if out-of-memory.
+ */
+static int preload_env(ZygoteTemplate *template) {
+    char **merged = merge_env(template->env);
+    if (merged == NULL) {
+        return 0;
+    }
+    template->env = merged;
+    return 1;
+}
+
+/**
+ * Exec the program in a process created by the zygote.
+ */
+static void exec_child(const char *path, char **argv, char **env) {
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, 3, ~0U, 0) == -1)
+#endif
+    {
+        for (long fd = sysconf(_SC_OPEN_MAX) - 1; fd >= 3; fd--) {
+            close((int) fd);
+        }
+    }
+    execve(path, argv, env);
+    _exit(127);
+}
+
+/**
+ * Handle a launch request in the zygote. The process executes its program
+ * once gate[1] is closed.
+ *
+ * @return the PID of the process, or -1 with errno set.
+ */
+static pid_t zygote_launch(char *request, size_t size, int gate[2]) {
+    ZygoteRequest header;
+    if (size < sizeof(header)) {
+        errno = EINVAL;
+        return -1;
+    }
+    memcpy(&header, request, sizeof(header));
+    if (header.template_id < 0 || (size_t) header.template_id >= gZygote.count
+        || header.arg_count > ZYGOTE_MAX_ARGS_SIZE) {
+        errno = EINVAL;
+        return -1;
+    }
+    ZygoteTemplate *template = &gZygote.templates[header.template_id];
+    if (access(template->path, X_OK) == -1) {
+        return -1;
+    }
+    char **argv = (char **) malloc((template->arg_count + header.arg_count + 2) * sizeof(char *));
+    if (argv == NULL) {
+        return -1;
+    }
+    size_t n = 0;
+    argv[n++] = template->path;
+    for (size_t i = 0; i < template->arg_count; i++) {
+        argv[n++] = template->args[i];
+    }
+    char *arg = request + sizeof(header), *end = request + size;
+    for (uint32_t i = 0; i < header.arg_count; i++) {
+        char *nul = memchr(arg, '\0', (size_t) (end - arg));
+        if (nul == NULL) {
+            free(argv);
+            errno = EINVAL;
+            return -1;
+        }
+        argv[n++] = arg;
+        arg = nul + 1;
+    }
+    argv[n] = NULL;
+
+    // Create the process as a sibling of the zygote, so the server reaps it.
+    // It waits until the launch is acknowledged and then yields, so executing
+    // the program does not delay the reply when they share a CPU.
+    if (pipe2(gate, O_CLOEXEC) == -1) {
+        free(argv);
+        return -1;
+    }
+    pid_t pid = (pid_t) syscall(SYS_clone, CLONE_PARENT | SIGCHLD, NULL, NULL, NULL, NULL);
+    if (pid == 0) {
+        char c;
+        close(gate[1]);
+        while (read(gate[0], &c, 1) == -1 && errno == EINTR) {
+        }
+        sched_yield();
+        exec_child(template->path, argv, template->env);
+    }
+    close(gate[0]);
+    if (pid == -1) {
+        close(gate[1]);
+        gate[1] = -1;
+    }
+    free(argv);
+    return pid;
+}
+
+/**
+ * Serve launch requests until the server closes its end of the socket pair.
+ */
+static void run_zygote(int fd, pid_t server) {
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() != server) {
+        _exit(0);
+    }
+    for (int sig = 1; sig < NSIG; sig++) {
+        signal(sig, SIG_DFL);
+    }
+    for (size_t i = 0; i < gZygote.count; i++) {
+        if (!preload_env(&gZygote.templates[i])) {
+            _exit(1);
+        }
+    }
+    static char request[sizeof(ZygoteRequest) + ZYGOTE_MAX_ARGS_SIZE];
+    for (;;) {
+        ssize_t size = recv(fd, request, sizeof(request), 0);
+        if (size == 0 || (size == -1 && errno != EINTR)) {
+            _exit(0);
+        }
+        if (size > 0) {
+            ZygoteReply reply = { -1, 0 };
+            int gate[2] = { -1, -1 };
+            reply.pid = zygote_launch(request, (size_t) size, gate);
+            reply.error = reply.pid == -1 ? errno : 0;
+            send(fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+            if (gate[1] != -1) {
+                close(gate[1]);
+            }
+        }
+    }
+}
+
+int start_zygote() {
+    int fds[2];
+    if (gZygote.fd != -1) {
+        return 1;
+    }
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) == -1) {
+        return 0;
+    }
+    pid_t server = getpid();
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(fds[0]);
+        close(fds[1]);
+        return 0;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        run_zygote(fds[1], server);
+    }
+    close(fds[1]);
+    gZygote.fd = fds[0];
+    gZygote.pid = pid;
+    return 1;
+}
+
+void stop_zygote() {
+    if (gZygote.fd != -1) {
+        close(gZygote.fd);
+        gZygote.fd = -1;
+        // Reaped by the child reaper instead if it is still running.
+        waitpid(gZygote.pid, NULL, 0);
+        gZygote.pid = -1;
+    }
+    for (size_t i = 0; i < gZygote.count; i++) {
+        free(gZygote.templates[i].path);
+        free_strings(gZygote.templates[i].args);
+        free_strings(gZygote.templates[i].env);
+    }
+    memset(gZygote.templates, 0, sizeof(gZygote.templates));
+    gZygote.count = 0;
+}
+
+pid_t zygote_spawn(int template_id, const char * const args[]) {
+    ZygoteRequest header = { template_id, 0 };
+    ZygoteReply reply = { -1, EPIPE };
+    size_t size = sizeof(header);
+    char *request = (char *) malloc(sizeof(header) + ZYGOTE_MAX_ARGS_SIZE);
+    if (request == NULL) {
+        return -1;
+    }
+    for (; args != NULL && args[header.arg_count] != NULL; header.arg_count++) {
+        size_t len = strlen(args[header.arg_count]) + 1;
+        if (len > sizeof(header) + ZYGOTE_MAX_ARGS_SIZE - size) {
+            printf("zygote launch arguments too long\n");
+            free(request);
+            return -1;
+        }
+        memcpy(request + size, args[header.arg_count], len);
+        size += len;
+    }
+    memcpy(request, &header, sizeof(header));
+
+    pthread_mutex_lock(&gZygote.lock);
+    if (gZygote.fd == -1) {
+        reply.error = ENOTCONN;
+    } else if (send(gZygote.fd, request, size, MSG_NOSIGNAL) != (ssize_t) size) {
+        reply.error = errno;
+    } else {
+        ssize_t received = recv(gZygote.fd, &reply, sizeof(reply), 0);
+        if (received != (ssize_t) sizeof(reply)) {
+            reply.pid = -1;
+            reply.error = received == -1 ? errno : EPIPE;
+        }
+    }
+    pthread_mutex_unlock(&gZygote.lock);
+    free(request);
+    if (reply.pid == -1) {
+        printf("%s failed to launch: %s\n",
+               template_id >= 0 && (size_t) template_id < gZygote.count
+               ? gZygote.templates[template_id].path : "zygote", strerror(reply.error));
+    }
+    return reply.pid;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Netflix, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NETFLIX, INC. AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NETFLIX OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Optional zygote launcher.
+ *
+ * The zygote is a small helper process forked at startup, before the server
+ * creates any thread, with launch templates for the applications: program
+ * path, leading arguments and environment. A launch only sends the template
+ * and the remaining arguments over a socket pair and receives the PID, so the
+ * launch request can be answered as soon as the zygote has created the
+ * process, without waiting for it to execute its program.
+ *
+ * Processes are created as children of the server, not of the zygote, so
+ * they are reaped by the server like any other launched application.
+ */
+
+#ifndef SRC_SERVER_ZYGOTE_H_
+#define SRC_SERVER_ZYGOTE_H_
+
+#include <sys/types.h>
+
+/*
+ * Maximum number of launch templates, and maximum size of the arguments of a
+ * launch.
+ */
+#define ZYGOTE_MAX_TEMPLATES (8)
+#define ZYGOTE_MAX_ARGS_SIZE (16 * 1024)
+
+/**
+ * Add a launch template. Must be called before start_zygote().
+ *
+ * @param path path of the program, copied.
+ * @param args NULL terminated leading arguments, from argv[1], or NULL;
+ *        copied.
+ * @param env NULL terminated "NAME=value" variables added to or replacing the
+ *        environment of the server, or NULL; copied.
+ * @return the template id, or -1 if ZYGOTE_MAX_TEMPLATES templates were added
+ *         or on out-of-memory.
+ */
+int zygote_add_template(const char *path, const char * const args[],
+                        const char * const env[]);
+
+/**
+ * Find the template of a program.
+ *
+ * @param path path of the program.
+ * @return the template id, or -1 if the zygote is not running or has no
+ *         template for it.
+ */
+int zygote_find_template(const char *path);
+
+/**
+ * Fork the zygote. Must be called while the process has a single thread.
+ *
+ * @return 1 if the zygote is running, 0 on error.
+ */
+int start_zygote();
+
+/**
+ * Stop the zygote and free the templates.
+ */
+void stop_zygote();
+
+/**
+ * Launch a process from a template. It starts with no signal blocked and
+ * only the standard streams open.
+ *
+ * @param template_id the template id.
+ * @param args NULL terminated arguments following the ones of the template,
+ *        or NULL.
+ * @return the PID of the process, which is a child of the calling process,
+ *         or -1 on error.
+ */
+pid_t zygote_spawn(int template_id, const char * const args[]);
+
+#endif /* SRC_SERVER_ZYGOTE_H_ */